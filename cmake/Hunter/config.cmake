@@ -1 +1 @@
-hunter_config(rocksdb VERSION 6.20.3 CMAKE_ARGS USE_RTTI=1)
+hunter_config(rocksdb VERSION 6.20.3 CMAKE_ARGS USE_RTTI=1 WITH_LZ4=ON WITH_ZSTD=ON)
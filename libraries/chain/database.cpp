@@ -43,6 +43,8 @@
 #include <fstream>
 #include <functional>
 
+#define BLURT_IN_MEMORY_INDICES_MARKER "in_memory_indices"
+
 namespace blurt { namespace chain {
 
 struct object_schema_repr
@@ -120,6 +122,11 @@ void database::open( const open_args& args )
       init_schema();
       chainbase::database::open( args.shared_mem_dir, args.chainbase_flags, args.shared_file_size, args.database_cfg );
 
+#ifdef ENABLE_MIRA
+      _shared_mem_dir = args.shared_mem_dir;
+      _database_cfg = args.database_cfg;
+#endif
+
       initialize_indexes();
       initialize_evaluators();
 
@@ -129,6 +136,24 @@ void database::open( const open_args& args )
             init_genesis( args );
          });
 
+      // Buffer index writes and commit them once per block. Each commit is written to the WAL
+      // so that a crash cannot leave an index with a partially applied block.
+      set_batch_writes( true );
+      set_write_options( false, false );
+
+#ifdef ENABLE_MIRA
+      // Indices placed in memory are only written back to RocksDB on a clean shutdown. Placing
+      // them recreates the marker, so a stale one must be detected first.
+      if( !( args.chainbase_flags & chainbase::skip_env_check ) )
+         FC_ASSERT( !fc::exists( args.shared_mem_dir / BLURT_IN_MEMORY_INDICES_MARKER ),
+            "Indices held in memory were not written back to disk. Please reindex blockchain." );
+
+      with_write_lock( [&]()
+      {
+         apply_index_placement( args.database_cfg );
+      });
+#endif
+
       _benchmark_dumper.set_enabled( args.benchmark_is_enabled );
 
       _block_log.open( args.data_dir / "block_log" );
@@ -246,6 +271,9 @@ uint32_t database::reindex( const open_args& args )
       wipe( args.data_dir, args.shared_mem_dir, false );
       open( args );
 
+      // A failed replay is restarted from scratch, so there is no need to pay for the WAL.
+      set_write_options( true, false );
+
       BLURT_TRY_NOTIFY(_pre_reindex_signal, note);
 
 #ifdef ENABLE_MIRA
@@ -341,6 +369,19 @@ uint32_t database::reindex( const open_args& args )
       }
 #endif
 
+      commit_write_batches();
+      set_batch_writes( true );
+      set_write_options( false, false );
+
+#ifdef ENABLE_MIRA
+      // Replaying in memory moves indices back to RocksDB regardless of their configured placement
+      if( args.replay_in_memory )
+      {
+         _index_placement.clear();
+         apply_index_placement( args.database_cfg );
+      }
+#endif
+
       auto end = fc::time_point::now();
       ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
 
@@ -356,6 +397,9 @@ void database::wipe( const fc::path& data_dir, const fc::path& shared_mem_dir, b
 {
    close();
    chainbase::database::wipe( shared_mem_dir );
+#ifdef ENABLE_MIRA
+   fc::remove_all( shared_mem_dir / BLURT_IN_MEMORY_INDICES_MARKER );
+#endif
    if( include_blocks )
    {
       fc::remove_all( data_dir / "block_log" );
@@ -374,6 +418,11 @@ void database::close(bool rewind)
 
 #ifdef ENABLE_MIRA
       undo_all();
+
+      // Write indices held in memory back to RocksDB
+      auto placement = _index_placement;
+      for( const auto& p : placement )
+         set_index_placement( p.first, mira::index_type::mira );
 #endif
 
       chainbase::database::flush();
@@ -2690,6 +2739,8 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
       _apply_block( next_block );
    } );
 
+   commit_write_batches();
+
    /*try
    {
    /// check invariants
@@ -3611,6 +3662,61 @@ const index_delegate_map& database::index_delegates()
    return _index_delegate_map;
 }
 
+#ifdef ENABLE_MIRA
+void database::set_index_placement( const std::string& index_name, mira::index_type type )
+{
+   FC_ASSERT( has_index_delegate( index_name ), "Unknown index '${name}'.", ("name", index_name) );
+
+   if( get_index_placement( index_name ) == type )
+      return;
+
+   ilog( "Moving index '${name}' to ${type}.", ("name", index_name)("type", type == mira::index_type::mira ? "mira" : "bmic") );
+
+   commit_write_batches();
+   get_index_delegate( index_name ).set_index_type( *this, type, _shared_mem_dir, _database_cfg );
+
+   if( type == mira::index_type::bmic )
+   {
+      _index_placement[ index_name ] = type;
+   }
+   else
+   {
+      _index_placement.erase( index_name );
+
+      // The index was recreated in RocksDB with default write options
+      set_batch_writes( true );
+      set_write_options( false, false );
+   }
+
+   // The marker exists while any index is only held in memory so an unclean shutdown can be detected
+   auto marker = _shared_mem_dir / BLURT_IN_MEMORY_INDICES_MARKER;
+   if( _index_placement.empty() )
+      fc::remove_all( marker );
+   else if( !fc::exists( marker ) )
+      std::ofstream( marker.string() );
+}
+
+mira::index_type database::get_index_placement( const std::string& index_name )const
+{
+   auto itr = _index_placement.find( index_name );
+   return itr == _index_placement.end() ? mira::index_type::mira : itr->second;
+}
+
+void database::apply_index_placement( const boost::any& database_cfg )
+{
+   for( const auto& p : mira::configuration::get_index_placement( database_cfg ) )
+   {
+      if( !has_index_delegate( p.first ) )
+      {
+         wlog( "Encountered an unknown index name '${name}' in index placement.", ("name", p.first) );
+         continue;
+      }
+
+      set_index_placement( p.first, p.second == "bmic" ? mira::index_type::bmic : mira::index_type::mira );
+   }
+}
+#endif
+
 void database::adjust_balance( const account_object& a, const asset& delta )
 {
    if ( delta.amount < 0 )
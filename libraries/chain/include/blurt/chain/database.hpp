@@ -448,6 +448,17 @@ namespace blurt { namespace chain {
          bool has_index_delegate( const std::string& n );
          const index_delegate_map& index_delegates();
 
+#ifdef ENABLE_MIRA
+         /**
+          * Moves an index between RocksDB (mira) and process memory (bmic). open() uses it to
+          * apply the placement configured in database.cfg, which is only read on startup.
+          * Indices held in memory are written back to RocksDB on close. The caller must hold
+          * the write lock.
+          */
+         void set_index_placement( const std::string& index_name, mira::index_type type );
+         mira::index_type get_index_placement( const std::string& index_name )const;
+#endif
+
 #ifdef IS_TEST_NET
          bool skip_price_feed_limit_check = true;
          bool skip_transaction_delta_check = true;
@@ -581,6 +592,14 @@ namespace blurt { namespace chain {
          util::advanced_benchmark_dumper  _benchmark_dumper;
          index_delegate_map            _index_delegate_map;
 
+#ifdef ENABLE_MIRA
+         void apply_index_placement( const boost::any& database_cfg );
+
+         std::map< std::string, mira::index_type > _index_placement;
+         fc::path                      _shared_mem_dir;
+         boost::any                    _database_cfg;
+#endif
+
          fc::signal<void(const operation_notification&)>       _pre_apply_operation_signal;
          /**
           *  This signal is emitted for plugins to process every operation after it has been fully applied.
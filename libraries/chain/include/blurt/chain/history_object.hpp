@@ -32,6 +32,7 @@ namespace blurt { namespace chain {
          uint32_t             trx_in_block = 0;
          uint32_t             op_in_trx = 0;
          uint32_t             virtual_op = 0;
+         uint32_t             op_type = 0; ///< `operation::which()`, known even when only location of operation is stored
          time_point_sec       timestamp;
          buffer_type          serialized_op;
 
@@ -107,7 +108,7 @@ template<> struct is_static_length< blurt::chain::account_history_object > : pub
 } // mira
 #endif
 
-FC_REFLECT( blurt::chain::operation_object, (id)(trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(serialized_op) )
+FC_REFLECT( blurt::chain::operation_object, (id)(trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(op_type)(timestamp)(serialized_op) )
 CHAINBASE_SET_INDEX_TYPE( blurt::chain::operation_object, blurt::chain::operation_index )
 
 FC_REFLECT( blurt::chain::account_history_object, (id)(account)(sequence)(op) )
@@ -26,6 +26,7 @@
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <stdexcept>
 #include <typeindex>
 #include <typeinfo>
@@ -335,6 +336,12 @@ namespace chainbase {
          void dump_lb_call_counts() { _indices.dump_lb_call_counts(); }
 
          void trim_cache() { _indices.trim_cache(); }
+
+         bool set_batch_writes( bool batch_writes ) { return _indices.set_batch_writes( batch_writes ); }
+
+         bool commit_write_batch() { return _indices.commit_write_batch(); }
+
+         void set_write_options( bool disable_wal, bool sync ) { _indices.set_write_options( disable_wal, sync ); }
 #endif
 
          class session {
@@ -710,6 +717,10 @@ namespace chainbase {
          virtual void dump_lb_call_counts() = 0;
          virtual void trim_cache() = 0;
          virtual void print_stats() const = 0;
+         virtual std::map< std::string, uint64_t > get_rocksdb_statistics() const = 0;
+         virtual bool set_batch_writes( bool batch_writes ) = 0;
+         virtual bool commit_write_batch() = 0;
+         virtual void set_write_options( bool disable_wal, bool sync ) = 0;
 #endif
 
          void add_index_extension( std::shared_ptr< index_extension > ext )  { _extensions.push_back( ext ); }
@@ -809,6 +820,26 @@ namespace chainbase {
          {
             _base.indicies().print_stats();
          }
+
+         virtual std::map< std::string, uint64_t > get_rocksdb_statistics() const override final
+         {
+            return _base.indicies().get_rocksdb_statistics();
+         }
+
+         virtual bool set_batch_writes( bool batch_writes ) override final
+         {
+            return _base.set_batch_writes( batch_writes );
+         }
+
+         virtual bool commit_write_batch() override final
+         {
+            return _base.commit_write_batch();
+         }
+
+         virtual void set_write_options( bool disable_wal, bool sync ) override final
+         {
+            _base.set_write_options( disable_wal, sync );
+         }
 #endif
 
       private:
@@ -893,6 +924,26 @@ namespace chainbase {
          size_t get_cache_size() const;
          void dump_lb_call_counts();
          void trim_cache();
+
+         /**
+          * Returns RocksDB statistics for every index, keyed by the index value type name.
+          * Without MIRA there is no RocksDB backing the indices and the result is empty.
+          */
+         std::map< std::string, std::map< std::string, uint64_t > > get_rocksdb_statistics() const;
+
+         /**
+          * When batch writes are enabled, index writes are buffered until commit_write_batches()
+          * instead of being written to RocksDB one object at a time. Each index commits its buffer
+          * in a single atomic write. Without MIRA these are no-ops.
+          */
+         void set_batch_writes( bool batch_writes );
+         void commit_write_batches();
+
+         /**
+          * Sets the RocksDB write options used when committing index writes.
+          */
+         void set_write_options( bool disable_wal, bool sync );
+
          void wipe( const bfs::path& dir );
          void resize( size_t new_shared_file_size );
          void set_require_locking( bool enable_require_locking );
@@ -168,6 +168,50 @@ namespace chainbase {
 #endif
    }
 
+   std::map< std::string, std::map< std::string, uint64_t > > database::get_rocksdb_statistics() const
+   {
+      std::map< std::string, std::map< std::string, uint64_t > > stats;
+#ifdef ENABLE_MIRA
+      for( const auto& i : _index_list )
+      {
+         stats[ i->get_statistics( true )._value_type_name ] = i->get_rocksdb_statistics();
+      }
+#endif
+      return stats;
+   }
+
+   void database::set_batch_writes( bool batch_writes )
+   {
+#ifdef ENABLE_MIRA
+      for( const auto& i : _index_list )
+      {
+         if( !i->set_batch_writes( batch_writes ) )
+            BOOST_THROW_EXCEPTION( std::runtime_error( "Failed to commit write batch for index " + i->get_statistics( true )._value_type_name ) );
+      }
+#endif
+   }
+
+   void database::commit_write_batches()
+   {
+#ifdef ENABLE_MIRA
+      for( const auto& i : _index_list )
+      {
+         if( !i->commit_write_batch() )
+            BOOST_THROW_EXCEPTION( std::runtime_error( "Failed to commit write batch for index " + i->get_statistics( true )._value_type_name ) );
+      }
+#endif
+   }
+
+   void database::set_write_options( bool disable_wal, bool sync )
+   {
+#ifdef ENABLE_MIRA
+      for( const auto& i : _index_list )
+      {
+         i->set_write_options( disable_wal, sync );
+      }
+#endif
+   }
+
    void database::close()
    {
       if( _is_open )
@@ -7,4 +7,7 @@ namespace fc
 
   string zlib_compress(const string& in);
 
+  /** Compresses \a in into the gzip format (RFC 1952) used by HTTP Content-Encoding: gzip. */
+  string gzip_compress(const string& in);
+
 } // namespace fc
@@ -22,7 +22,9 @@ namespace fc
             legacy_parser         = 0,
             strict_parser         = 1,
             relaxed_parser        = 2,
-            legacy_parser_with_string_doubles = 3
+            legacy_parser_with_string_doubles = 3,
+            /// Same grammar and results as legacy_parser, parsed in place from a contiguous buffer
+            fast_parser           = 4
          };
          enum output_formatting
          {
@@ -0,0 +1,201 @@
+#pragma once
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/optional.hpp>
+#include <fc/safe.hpp>
+#include <fc/uint128.hpp>
+#include <fc/container/flat_fwd.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace fc
+{
+   /**
+    *  Reflected types with their own to_variant() must be written through fc::variant,
+    *  otherwise json_writer would write their reflected members instead.
+    *
+    *  Use FC_JSON_WRITE_THROUGH_VARIANT next to the to_variant() of such a type.
+    */
+   template< typename T > struct json_write_through_variant : std::false_type {};
+
+   template< typename T > struct json_write_through_variant< safe< T > > : std::true_type {};
+   template<> struct json_write_through_variant< uint128 > : std::true_type {};
+
+   /**
+    *  Writes values as JSON straight into a string. Reflected structs, containers,
+    *  integers and strings are written directly, without building an fc::variant tree.
+    *  Other types are converted with to_variant() one value at a time.
+    *
+    *  The output is identical to fc::json::to_string( fc::variant( v ) ) with the
+    *  default json::stringify_large_ints_and_doubles formatting.
+    */
+   class json_writer
+   {
+      public:
+         explicit json_writer( std::string& out ) : _out( out ) {}
+
+         template< typename T >
+         static std::string to_string( const T& v )
+         {
+            std::string out;
+            json_writer( out ).write( v );
+            return out;
+         }
+
+         template< typename T >
+         void write( const T& v )
+         {
+            write_value( v, category< T >() );
+         }
+
+         void write( const variant& v );
+         void write( const variants& v );
+         void write( const variant_object& v );
+         void write( const std::string& v );
+
+         /// Written as a hex string by to_variant().
+         void write( const std::vector< char >& v ) { write( variant( v ) ); }
+
+         template< typename T >
+         void write( const optional< T >& v )
+         {
+            if( v.valid() )
+               write( *v );
+            else
+               _out += "null";
+         }
+
+         template< typename T >
+         void write( const std::vector< T >& v ) { write_array( v ); }
+
+         template< typename... T >
+         void write( const std::set< T... >& v ) { write_array( v ); }
+
+         template< typename T >
+         void write( const flat_set< T >& v ) { write_array( v ); }
+
+         template< typename K, typename T >
+         void write( const std::map< K, T >& v ) { write_array( v ); }
+
+         /// Written as an object by to_variant().
+         template< typename T >
+         void write( const std::map< std::string, T >& v ) { write( variant( v ) ); }
+
+         template< typename K, typename... T >
+         void write( const flat_map< K, T... >& v ) { write_array( v ); }
+
+         template< typename A, typename B >
+         void write( const std::pair< A, B >& v )
+         {
+            _out += '[';
+            write( v.first );
+            _out += ',';
+            write( v.second );
+            _out += ']';
+         }
+
+      private:
+         struct variant_tag {};
+         struct bool_tag {};
+         struct signed_tag {};
+         struct unsigned_tag {};
+         struct reflected_tag {};
+
+         template< typename T >
+         using category =
+            typename std::conditional< std::is_same< T, bool >::value, bool_tag,
+            typename std::conditional< std::is_integral< T >::value && std::is_signed< T >::value, signed_tag,
+            typename std::conditional< std::is_integral< T >::value, unsigned_tag,
+            typename std::conditional< reflector< T >::is_defined::value && !reflector< T >::is_enum::value
+                                       && !json_write_through_variant< T >::value, reflected_tag,
+            variant_tag >::type >::type >::type >::type;
+
+         template< typename T >
+         class member_writer
+         {
+            public:
+               member_writer( json_writer& w, const T& v, bool& first )
+                  : _w( w ), _v( v ), _first( first ) {}
+
+               template< typename Member, class Class, Member (Class::*member) >
+               void operator()( const char* name )const
+               {
+                  _w.write_member( name, _v.*member, _first );
+               }
+
+            private:
+               json_writer& _w;
+               const T&     _v;
+               bool&        _first;
+         };
+
+         template< typename T >
+         void write_value( const T& v, variant_tag ) { write( variant( v ) ); }
+
+         template< typename T >
+         void write_value( const T& v, bool_tag ) { _out += v ? "true" : "false"; }
+
+         template< typename T >
+         void write_value( const T& v, signed_tag ) { write_int64( int64_t( v ) ); }
+
+         template< typename T >
+         void write_value( const T& v, unsigned_tag ) { write_uint64( uint64_t( v ) ); }
+
+         template< typename T >
+         void write_value( const T& v, reflected_tag )
+         {
+            bool first = true;
+            _out += '{';
+            reflector< T >::visit( member_writer< T >( *this, v, first ) );
+            _out += '}';
+         }
+
+         template< typename M >
+         void write_member( const char* name, const M& v, bool& first )
+         {
+            if( !first )
+               _out += ',';
+            first = false;
+            write_string( name, strlen( name ) );
+            _out += ':';
+            write( v );
+         }
+
+         /// Reflected optional members are left out when not set.
+         template< typename M >
+         void write_member( const char* name, const optional< M >& v, bool& first )
+         {
+            if( v.valid() )
+               write_member( name, *v, first );
+         }
+
+         template< typename Container >
+         void write_array( const Container& c )
+         {
+            _out += '[';
+            for( auto itr = c.begin(); itr != c.end(); ++itr )
+            {
+               if( itr != c.begin() )
+                  _out += ',';
+               write( *itr );
+            }
+            _out += ']';
+         }
+
+         void write_int64( int64_t i );
+         void write_uint64( uint64_t i );
+         void write_string( const char* str, size_t size );
+
+         std::string& _out;
+   };
+
+} // fc
+
+#define FC_JSON_WRITE_THROUGH_VARIANT( TYPE ) \
+namespace fc { template<> struct json_write_through_variant< TYPE > : std::true_type {}; }
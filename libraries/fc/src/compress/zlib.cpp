@@ -12,4 +12,29 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  string gzip_compress(const string& in)
+  {
+    static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+
+    size_t deflated_length;
+    char* deflated = (char*)tdefl_compress_mem_to_heap(in.c_str(), in.size(), &deflated_length, TDEFL_DEFAULT_MAX_PROBES);
+
+    uint32_t crc = (uint32_t)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)in.c_str(), in.size());
+    uint32_t size = (uint32_t)in.size();
+
+    string result;
+    result.reserve(sizeof(header) + deflated_length + 8);
+    result.append(header, sizeof(header));
+    result.append(deflated, deflated_length);
+    free(deflated);
+
+    // The trailer holds the CRC-32 and the uncompressed size mod 2^32, both little endian.
+    for (int i = 0; i < 4; ++i)
+      result += char((crc >> (8 * i)) & 0xff);
+    for (int i = 0; i < 4; ++i)
+      result += char((size >> (8 * i)) & 0xff);
+
+    return result;
+  }
 }
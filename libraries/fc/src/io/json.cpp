@@ -32,6 +32,7 @@ namespace fc
 }
 
 #include <fc/io/json_relaxed.hpp>
+#include "json_fast.hpp"
 
 namespace fc
 {
@@ -471,6 +472,12 @@ namespace fc
       FC_ASSERT( depth <= JSON_MAX_RECURSION_DEPTH );
       check_string_depth( utf8_str );
 
+      if( ptype == fast_parser )
+      {
+         const char* pos = utf8_str.data();
+         return json_fast::variant_from_buffer( pos, pos + utf8_str.size(), depth );
+      }
+
       fc::stringstream in( utf8_str );
       //in.exceptions( std::ifstream::eofbit );
       switch( ptype )
@@ -813,6 +820,14 @@ namespace fc
       //auto tmp = std::make_shared<fc::ifstream>( p, ifstream::binary );
       //auto tmp = std::make_shared<std::ifstream>( p.generic_string().c_str(), std::ios::binary );
       //buffered_istream bi( tmp );
+      if( ptype == fast_parser )
+      {
+         std::string contents;
+         read_file_contents( p, contents );
+         const char* pos = contents.data();
+         return json_fast::variant_from_buffer( pos, pos + contents.size(), depth );
+      }
+
       boost::filesystem::ifstream bi( p, std::ios::binary );
       switch( ptype )
       {
@@ -835,6 +850,7 @@ namespace fc
       switch( ptype )
       {
           case legacy_parser:
+          case fast_parser: // streams are not buffered in memory, the legacy parser accepts the same input
               return variant_from_stream<fc::buffered_istream, legacy_parser>( in, depth );
           case legacy_parser_with_string_doubles:
               return variant_from_stream<fc::buffered_istream, legacy_parser_with_string_doubles>( in, depth );
@@ -866,6 +882,12 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t depth )
    {
       if( utf8_str.size() == 0 ) return false;
+      if( ptype == fast_parser )
+      {
+         const char* pos = utf8_str.data();
+         json_fast::variant_from_buffer( pos, pos + utf8_str.size(), depth );
+         return pos == utf8_str.data() + utf8_str.size();
+      }
       fc::stringstream in( utf8_str );
       switch( ptype )
       {
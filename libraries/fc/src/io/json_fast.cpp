@@ -0,0 +1,419 @@
+#include "json_fast.hpp"
+
+#include <fc/io/json.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/string.hpp>
+
+#include <cstring>
+#include <limits>
+
+namespace fc { namespace json_fast
+{
+   namespace
+   {
+      /**
+       *  Returns the first '"', '\\' or 0x04 (the bytes that end a plain run inside a
+       *  string) at or after p. Eight bytes are tested per step using the usual
+       *  "has zero byte" bit trick, so long string bodies are skipped a word at a time.
+       */
+      const char* find_string_special( const char* p, const char* end )
+      {
+         const uint64_t ones  = 0x0101010101010101ull;
+         const uint64_t highs = 0x8080808080808080ull;
+
+         while( end - p >= 8 )
+         {
+            uint64_t w;
+            memcpy( &w, p, sizeof( w ) );
+
+            uint64_t quote = w ^ ( ones * '"' );
+            uint64_t slash = w ^ ( ones * '\\' );
+            uint64_t eot   = w ^ ( ones * 0x04 );
+
+            uint64_t found = ( ( quote - ones ) & ~quote )
+                           | ( ( slash - ones ) & ~slash )
+                           | ( ( eot - ones ) & ~eot );
+            if( found & highs )
+               break;
+
+            p += 8;
+         }
+
+         while( p != end && *p != '"' && *p != '\\' && *p != 0x04 )
+            ++p;
+
+         return p;
+      }
+
+      /// isalnum() in the "C" locale, without the sign extension issues of plain char.
+      bool is_alnum( char c )
+      {
+         return ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' );
+      }
+
+      bool is_digit( char c )
+      {
+         return c >= '0' && c <= '9';
+      }
+
+      /// Mirrors parseEscape() in json.cpp, called with pos on the character after '\\'.
+      char unescape( char c )
+      {
+         switch( c )
+         {
+            case 't':  return '\t';
+            case 'n':  return '\n';
+            case 'r':  return '\r';
+            default:   return c;
+         }
+      }
+
+      /**
+       *  Recursive descent over an in-memory buffer. Each method corresponds to the
+       *  function of the same purpose in json.cpp and follows its control flow, including
+       *  the places where the legacy parser treats end of input as the end of a token.
+       */
+      class parser
+      {
+         public:
+            parser( const char* pos, const char* end ) : _pos( pos ), _end( end ) {}
+
+            const char* pos()const { return _pos; }
+
+            variant parse_value( uint32_t depth )
+            {
+               depth++;
+               FC_ASSERT( depth <= JSON_MAX_RECURSION_DEPTH );
+               skip_white_space();
+
+               switch( *_pos )
+               {
+                  case '"':
+                     return parse_string();
+                  case '{':
+                     return parse_object( depth );
+                  case '[':
+                     return parse_array( depth );
+                  case '-':
+                  case '.':
+                  case '0':
+                  case '1':
+                  case '2':
+                  case '3':
+                  case '4':
+                  case '5':
+                  case '6':
+                  case '7':
+                  case '8':
+                  case '9':
+                     return parse_number();
+                  case 'n':
+                  case 't':
+                  case 'f':
+                     return parse_token();
+                  case 0x04: // ^D end of transmission
+                  case '\xff':
+                  case 0:
+                     FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+                  default:
+                  {
+                     char c = *_pos;
+                     FC_THROW_EXCEPTION( parse_error_exception, "Unexpected char '${c}' in \"${s}\"",
+                                        ("c", c)("s", parse_unquoted()) );
+                  }
+               }
+            }
+
+         private:
+            char peek()
+            {
+               if( _pos == _end )
+                  FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+               return *_pos;
+            }
+
+            bool skip_white_space()
+            {
+               bool skipped = false;
+               while( true )
+               {
+                  switch( peek() )
+                  {
+                     case ' ':
+                     case '\t':
+                     case '\n':
+                     case '\r':
+                        skipped = true;
+                        ++_pos;
+                        break;
+                     default:
+                        return skipped;
+                  }
+               }
+            }
+
+            fc::string parse_string()
+            {
+               char c = peek();
+               if( c != '"' )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Expected '\"' but read '${char}'",
+                                      ("char", string( &c, &c + 1 )) );
+               ++_pos;
+
+               const char* run  = _pos;
+               const char* stop = find_string_special( run, _end );
+
+               // Common case, no escapes: the string is allocated once at its final size.
+               if( stop != _end && *stop == '"' )
+               {
+                  _pos = stop + 1;
+                  return fc::string( run, stop );
+               }
+
+               fc::string token;
+               while( true )
+               {
+                  token.append( run, stop );
+                  _pos = stop;
+
+                  if( _pos == _end )
+                     FC_THROW_EXCEPTION( eof_exception, "EOF before closing '\"' in string '${token}'",
+                                         ("token", token) );
+
+                  switch( *_pos )
+                  {
+                     case '"':
+                        ++_pos;
+                        return token;
+                     case 0x04:
+                        FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
+                                            ("token", token) );
+                     default: // '\\'
+                        ++_pos;
+                        token += unescape( peek() );
+                        ++_pos;
+                  }
+
+                  run  = _pos;
+                  stop = find_string_special( run, _end );
+               }
+            }
+
+            /// Mirrors stringFromToken(), which stops silently at end of input.
+            fc::string parse_unquoted()
+            {
+               fc::string token;
+               while( _pos != _end )
+               {
+                  char c = *_pos;
+                  switch( c )
+                  {
+                     case '\\':
+                        ++_pos;
+                        if( _pos == _end )
+                           return token;
+                        token += unescape( *_pos );
+                        ++_pos;
+                        break;
+                     case '\t':
+                     case ' ':
+                     case '\0':
+                     case '\n':
+                        ++_pos;
+                        return token;
+                     default:
+                        if( is_alnum( c ) || c == '_' || c == '-' || c == '.' || c == ':' || c == '/' )
+                        {
+                           token += c;
+                           ++_pos;
+                        }
+                        else return token;
+                  }
+               }
+               return token;
+            }
+
+            variant parse_object( uint32_t depth )
+            {
+               depth++;
+               FC_ASSERT( depth <= JSON_MAX_RECURSION_DEPTH );
+               mutable_variant_object obj;
+               try
+               {
+                  ++_pos;
+                  skip_white_space();
+                  while( peek() != '}' )
+                  {
+                     if( *_pos == ',' )
+                     {
+                        ++_pos;
+                        continue;
+                     }
+                     if( skip_white_space() ) continue;
+                     string key = parse_string();
+                     skip_white_space();
+                     if( peek() != ':' )
+                     {
+                        FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"",
+                                            ("key", key) );
+                     }
+                     ++_pos;
+                     auto val = parse_value( depth );
+
+                     obj( std::move( key ), std::move( val ) );
+                     skip_white_space();
+                  }
+                  ++_pos;
+                  return variant( std::move( obj ) );
+               }
+               catch( const fc::eof_exception& e )
+               {
+                  FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF: ${e}", ("e", e.to_detail_string() ) );
+               }
+            }
+
+            variant parse_array( uint32_t depth )
+            {
+               depth++;
+               FC_ASSERT( depth <= JSON_MAX_RECURSION_DEPTH );
+               variants ar;
+
+               ++_pos;
+               skip_white_space();
+               while( peek() != ']' )
+               {
+                  if( *_pos == ',' )
+                  {
+                     ++_pos;
+                     continue;
+                  }
+                  if( skip_white_space() ) continue;
+                  ar.push_back( parse_value( depth ) );
+                  skip_white_space();
+               }
+               ++_pos;
+               return variant( std::move( ar ) );
+            }
+
+            variant parse_number()
+            {
+               const char* start = _pos;
+               bool dot = false;
+               bool neg = false;
+
+               if( *_pos == '-' )
+               {
+                  neg = true;
+                  ++_pos;
+               }
+
+               while( _pos != _end && *_pos )
+               {
+                  char c = *_pos;
+                  if( c == '.' )
+                  {
+                     if( dot )
+                        FC_THROW_EXCEPTION( parse_error_exception, "Can't parse a number with two decimal places" );
+                     dot = true;
+                     ++_pos;
+                  }
+                  else if( is_digit( c ) )
+                  {
+                     ++_pos;
+                  }
+                  else if( is_alnum( c ) )
+                  {
+                     fc::string str( start, _pos );
+                     return str + parse_unquoted();
+                  }
+                  else break;
+               }
+
+               const char* digits = neg ? start + 1 : start;
+               size_t digit_count = _pos - digits;
+
+               if( dot )
+               {
+                  fc::string str( start, _pos );
+                  if( str == "-." || str == "." )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant", ("token", str) );
+                  return to_double( str );
+               }
+
+               // Up to 19 digits always fit in a uint64_t. Anything longer, or an empty
+               // number ("-"), goes through the same conversion the legacy parser uses.
+               if( digit_count == 0 || digit_count > 19 )
+               {
+                  fc::string str( start, _pos );
+                  if( neg )
+                     return to_int64( str );
+                  return to_uint64( str );
+               }
+
+               uint64_t value = 0;
+               for( const char* itr = digits; itr != _pos; ++itr )
+                  value = value * 10 + uint64_t( *itr - '0' );
+
+               if( !neg )
+                  return value;
+
+               if( value > uint64_t( std::numeric_limits< int64_t >::max() ) + 1 )
+                  return to_int64( fc::string( start, _pos ) );
+
+               return int64_t( 0 - value );
+            }
+
+            variant parse_token()
+            {
+               const char* start = _pos;
+               while( _pos != _end )
+               {
+                  switch( *_pos )
+                  {
+                     case 'n':
+                     case 'u':
+                     case 'l':
+                     case 't':
+                     case 'r':
+                     case 'e':
+                     case 'f':
+                     case 'a':
+                     case 's':
+                        ++_pos;
+                        continue;
+                     default:
+                        break;
+                  }
+                  break;
+               }
+
+               size_t size = _pos - start;
+               if( size == 4 && memcmp( start, "null", 4 ) == 0 )
+                  return variant();
+               if( size == 4 && memcmp( start, "true", 4 ) == 0 )
+                  return true;
+               if( size == 5 && memcmp( start, "false", 5 ) == 0 )
+                  return false;
+
+               // A malformed token is treated as an unquoted string, as in token_from_stream().
+               fc::string str( start, _pos );
+               if( _pos == _end )
+                  return str;
+               return str + parse_unquoted();
+            }
+
+            const char* _pos;
+            const char* _end;
+      };
+   }
+
+   variant variant_from_buffer( const char*& pos, const char* end, uint32_t depth )
+   {
+      parser p( pos, end );
+      variant result = p.parse_value( depth );
+      pos = p.pos();
+      return result;
+   }
+
+} } // fc::json_fast
@@ -0,0 +1,20 @@
+#pragma once
+
+// This file is an internal header,
+// it is not meant to be included except internally from json.cpp in fc
+
+#include <fc/variant.hpp>
+
+namespace fc { namespace json_fast
+{
+   /**
+    *  Parses the JSON value starting at \a pos, accepting exactly what json::legacy_parser
+    *  accepts and producing the same variant. On return \a pos points just past the
+    *  value, where the legacy parser would have left its stream.
+    *
+    *  The input is scanned in place instead of through a stream, so string contents are
+    *  copied once into their final fc::string and numbers are converted without
+    *  intermediate string streams.
+    */
+   variant variant_from_buffer( const char*& pos, const char* end, uint32_t depth );
+} } // fc::json_fast
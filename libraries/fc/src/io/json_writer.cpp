@@ -0,0 +1,134 @@
+#include <fc/io/json_writer.hpp>
+
+namespace fc
+{
+   void json_writer::write( const variant& v )
+   {
+      // Mirrors fc::to_stream( os, variant, json::stringify_large_ints_and_doubles ) in json.cpp.
+      switch( v.get_type() )
+      {
+         case variant::null_type:
+            _out += "null";
+            return;
+         case variant::int64_type:
+            write_int64( v.as_int64() );
+            return;
+         case variant::uint64_type:
+            write_uint64( v.as_uint64() );
+            return;
+         case variant::double_type:
+            _out += '"';
+            _out += v.as_string();
+            _out += '"';
+            return;
+         case variant::bool_type:
+            _out += v.as_string();
+            return;
+         case variant::string_type:
+            write( v.get_string() );
+            return;
+         case variant::blob_type:
+            write( v.as_string() );
+            return;
+         case variant::array_type:
+            write( v.get_array() );
+            return;
+         case variant::object_type:
+            write( v.get_object() );
+            return;
+      }
+   }
+
+   void json_writer::write( const variants& v )
+   {
+      write_array( v );
+   }
+
+   void json_writer::write( const variant_object& v )
+   {
+      _out += '{';
+      for( auto itr = v.begin(); itr != v.end(); ++itr )
+      {
+         if( itr != v.begin() )
+            _out += ',';
+         write( itr->key() );
+         _out += ':';
+         write( itr->value() );
+      }
+      _out += '}';
+   }
+
+   void json_writer::write( const std::string& v )
+   {
+      write_string( v.data(), v.size() );
+   }
+
+   void json_writer::write_int64( int64_t i )
+   {
+      if( i > 0xffffffff )
+      {
+         _out += '"';
+         _out += std::to_string( i );
+         _out += '"';
+      }
+      else
+      {
+         _out += std::to_string( i );
+      }
+   }
+
+   void json_writer::write_uint64( uint64_t i )
+   {
+      if( i > 0xffffffff )
+      {
+         _out += '"';
+         _out += std::to_string( i );
+         _out += '"';
+      }
+      else
+      {
+         _out += std::to_string( i );
+      }
+   }
+
+   void json_writer::write_string( const char* str, size_t size )
+   {
+      // Same escaping as fc::escape_string() in json.cpp.
+      static const char* const hex = "0123456789abcdef";
+
+      _out.reserve( _out.size() + size + 2 );
+      _out += '"';
+
+      const char* run = str;
+      const char* end = str + size;
+
+      for( const char* itr = str; itr != end; ++itr )
+      {
+         unsigned char c = static_cast< unsigned char >( *itr );
+         if( c >= 0x20 && c != '"' && c != '\\' )
+            continue;
+
+         _out.append( run, itr );
+         run = itr + 1;
+
+         switch( c )
+         {
+            case '\b': _out += "\\b"; break;
+            case '\f': _out += "\\f"; break;
+            case '\n': _out += "\\n"; break;
+            case '\r': _out += "\\r"; break;
+            case '\t': _out += "\\t"; break;
+            case '\\': _out += "\\\\"; break;
+            case '"':  _out += "\\\""; break;
+            default:
+               _out += "\\u00";
+               _out += hex[ c >> 4 ];
+               _out += hex[ c & 0xf ];
+         }
+      }
+
+      _out.append( run, end );
+      _out += '"';
+   }
+
+} // fc
@@ -87,4 +87,30 @@ BOOST_AUTO_TEST_CASE(zlib_test)
     BOOST_CHECK_EQUAL( decomp, line );
 }
 
+BOOST_AUTO_TEST_CASE(gzip_test)
+{
+    std::string line;
+    for( int i = 0; i < 1000; ++i )
+        line += "{\"block_num\":" + std::to_string( i ) + "}";
+
+    std::string compressed = fc::gzip_compress( line );
+    BOOST_REQUIRE( compressed.size() > 18 );
+    BOOST_CHECK_EQUAL( compressed[0], '\x1f' );
+    BOOST_CHECK_EQUAL( compressed[1], '\x8b' );
+    BOOST_CHECK_EQUAL( compressed[2], 8 );
+
+    // Strip the 10 byte header and the 8 byte trailer, the rest is a raw deflate stream.
+    size_t decomp_len;
+    char* decomp = tinfl_decompress_mem_to_heap( compressed.c_str() + 10, compressed.length() - 18, &decomp_len, 0 );
+    BOOST_REQUIRE( decomp != nullptr );
+    std::string result( decomp, decomp_len );
+    free( decomp );
+    BOOST_CHECK_EQUAL( result, line );
+
+    uint32_t size = 0;
+    for( int i = 0; i < 4; ++i )
+        size |= uint32_t( uint8_t( compressed[ compressed.size() - 4 + i ] ) ) << ( 8 * i );
+    BOOST_CHECK_EQUAL( size, line.size() );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,6 +1,8 @@
 #pragma once
 #include <boost/multi_index_container.hpp>
 
+#include <map>
+
 namespace mira {
 
 template< typename Value, typename IndexSpecifierList, typename Allocator >
@@ -43,6 +45,11 @@ class boost_multi_index_adapter : public boost::multi_index_container< Value, In
       void trim_cache() {}
 
       void print_stats() const {}
+      std::map< std::string, uint64_t > get_rocksdb_statistics() const { return std::map< std::string, uint64_t >(); }
+
+      bool set_batch_writes( bool ) { return true; }
+      bool commit_write_batch() { return true; }
+      void set_write_options( bool, bool ) {}
 
       size_t get_cache_usage() const { return 0; }
       size_t get_cache_size() const { return 0; }
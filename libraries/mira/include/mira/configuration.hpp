@@ -1,4 +1,5 @@
 #pragma once
+#include <map>
 #include <string>
 #include <boost/any.hpp>
 #include <boost/core/demangle.hpp>
@@ -27,6 +28,7 @@ public:
    static ::rocksdb::Options get_options( const boost::any& cfg, std::string type_name );
    static bool gather_statistics( const boost::any& cfg );
    static size_t get_object_count( const boost::any& cfg );
+   static std::map< std::string, std::string > get_index_placement( const boost::any& cfg );
 };
 
 } // mira
@@ -68,7 +68,10 @@ protected:
    typedef boost::false_type                 iterator;
 
    db_ptr                                    _db;
-   ::rocksdb::WriteBatch                     _write_buffer;
+   // Shared by every index of the container so that reads through any index
+   // observe writes that have not yet been committed to the database.
+   batch_ptr                                 _write_buffer = std::make_shared< ::rocksdb::WriteBatchWithIndex >(
+                                                ::rocksdb::BytewiseComparator(), 0, true );
    column_handles                            _handles;
 
    static const size_t                       COLUMN_INDEX = 0;
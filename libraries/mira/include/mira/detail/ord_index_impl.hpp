@@ -86,7 +86,7 @@
 #define BOOST_MULTI_INDEX_ORD_INDEX_CHECK_INVARIANT
 #endif
 
-#define ROCKSDB_ITERATOR_PARAM_PACK const_cast< column_handles* >( &_handles ), COLUMN_INDEX, super::_db, *_cache
+#define ROCKSDB_ITERATOR_PARAM_PACK const_cast< column_handles* >( &_handles ), COLUMN_INDEX, super::_db, super::_write_buffer, *_cache
 
 namespace mira{
 
@@ -550,7 +550,8 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
          ::rocksdb::PinnableSlice key_slice;
          pack_to_slice< key_type >( key_slice, new_key );
 
-         s = super::_db->Get(
+         s = super::_write_buffer->GetFromBatchAndDB(
+            &*super::_db,
             ::rocksdb::ReadOptions(),
             &*super::_handles[ COLUMN_INDEX ],
             key_slice,
@@ -576,7 +577,7 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
             pack_to_slice( value_slice, id( v ) );
          }
 
-         s = super::_write_buffer.Put(
+         s = super::_write_buffer->Put(
             &*super::_handles[ COLUMN_INDEX ],
             key_slice,
             value_slice );
@@ -600,7 +601,7 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
       PinnableSlice old_key_slice;
       pack_to_slice( old_key_slice, old_key );
 
-      super::_write_buffer.Delete(
+      super::_write_buffer->Delete(
          &*super::_handles[ COLUMN_INDEX ],
          old_key_slice );
 
@@ -656,7 +657,8 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
 
             pack_to_slice( new_key_slice, new_key );
 
-            s = super::_db->Get(
+            s = super::_write_buffer->GetFromBatchAndDB(
+               &*super::_db,
                ::rocksdb::ReadOptions(),
                &*super::_handles[ COLUMN_INDEX ],
                new_key_slice,
@@ -672,7 +674,7 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
             PinnableSlice old_key_slice;
             pack_to_slice( old_key_slice, old_key );
 
-            s = super::_write_buffer.Delete(
+            s = super::_write_buffer->Delete(
                &*super::_handles[ COLUMN_INDEX ],
                old_key_slice );
 
@@ -687,7 +689,7 @@ BOOST_MULTI_INDEX_PROTECTED_IF_MEMBER_TEMPLATE_FRIENDS:
             return true;
          }
 
-         s = super::_write_buffer.Put(
+         s = super::_write_buffer->Put(
             &*super::_handles[ COLUMN_INDEX ],
             new_key_slice,
             value_slice );
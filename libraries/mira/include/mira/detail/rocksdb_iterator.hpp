@@ -11,7 +11,10 @@
 
 #include <rocksdb/db.h>
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace mira { namespace multi_index { namespace detail {
 
@@ -38,6 +41,7 @@ private:
    std::shared_ptr< ::rocksdb::ManagedSnapshot >   _snapshot;
    ::rocksdb::ReadOptions                          _opts;
    db_ptr                                          _db;
+   batch_ptr                                       _batch;
 
    cache_type*                                     _cache = nullptr;
    IDFromValue                                     _get_id;
@@ -46,6 +50,20 @@ private:
 
    std::shared_ptr< Value >                        _cache_value;
 
+   // Exclusive upper bound of a range scan, shared so that it outlives moves of the iterator
+   struct upper_bound_type
+   {
+      upper_bound_type( const ::rocksdb::Slice& k ) : key( k.ToString() ), slice( key ) {}
+
+      std::string                                  key;
+      ::rocksdb::Slice                             slice;
+   };
+
+   std::shared_ptr< upper_bound_type >             _upper_bound;
+
+   // Set while the iterator is being stepped forward, enables prefetching of primary objects
+   bool                                            _scanning = false;
+
    // The following declarations exist solely for the iterator to have a default constructor
    static cache_type                               default_cache;
 
@@ -75,19 +93,78 @@ public:
       return count;
    }
 
+   // Number of primary objects fetched with a single MultiGet when scanning a secondary index
+   static size_t& prefetch_size()
+   {
+      static size_t size = 16;
+      return size;
+   }
+
+   // Largest readahead used for a bounded range scan
+   static size_t& max_readahead_size()
+   {
+      static size_t size = 2 << 20; // 2M
+      return size;
+   }
+
    rocksdb_iterator() {}
 
+   /* Writes that have not been committed yet live in the index write batch. When the
+    * batch holds pending writes to this column family the RocksDB iterator is layered
+    * under the batch so the uncommitted state is visible to readers.
+    */
+   ::rocksdb::Iterator* new_iterator()const
+   {
+      if( has_pending_writes() )
+      {
+         // The batch iterator does not honor the upper bound of the base iterator
+         ::rocksdb::ReadOptions opts = _opts;
+         opts.iterate_upper_bound = nullptr;
+         return _batch->NewIteratorWithBase( &*(*_handles)[ _index ], _db->NewIterator( opts, &*(*_handles)[ _index ] ) );
+      }
+
+      if( _upper_bound )
+      {
+         ::rocksdb::ReadOptions opts = _opts;
+         opts.iterate_upper_bound = &_upper_bound->slice;
+         return _db->NewIterator( opts, &*(*_handles)[ _index ] );
+      }
+
+      return _db->NewIterator( _opts, &*(*_handles)[ _index ] );
+   }
+
+   /* Whether the index write batch holds uncommitted writes to the given column family.
+    * The batch is shared by all column families of the container, and every undo session
+    * writes the revision to the default column family, so the batch alone is rarely empty.
+    */
+   bool has_pending_writes( size_t index )const
+   {
+      if( !_batch || _batch->GetWriteBatch()->Count() == 0 ) return false;
+
+      std::unique_ptr< ::rocksdb::WBWIIterator > pending( _batch->NewIterator( &*(*_handles)[ index ] ) );
+      pending->SeekToFirst();
+      return pending->Valid();
+   }
+
+   bool has_pending_writes()const
+   {
+      return has_pending_writes( _index );
+   }
+
    rocksdb_iterator( rocksdb_iterator& other ) :
       _handles( other._handles ),
       _index( other._index ),
       _snapshot( other._snapshot ),
+      _opts( other._opts ),
       _db( other._db ),
+      _batch( other._batch ),
       _cache( other._cache ),
-      _cache_value( other._cache_value )
+      _cache_value( other._cache_value ),
+      _upper_bound( other._upper_bound )
    {
       if ( other._iter )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
 
          if( other._iter->Valid() )
             _iter->Seek( other._iter->key() );
@@ -98,13 +175,16 @@ public:
       _handles( other._handles ),
       _index( other._index ),
       _snapshot( other._snapshot ),
+      _opts( other._opts ),
       _db( other._db ),
+      _batch( other._batch ),
       _cache( other._cache ),
-      _cache_value( other._cache_value )
+      _cache_value( other._cache_value ),
+      _upper_bound( other._upper_bound )
    {
       if ( other._iter )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
 
          if( other._iter->Valid() )
             _iter->Seek( other._iter->key() );
@@ -116,49 +196,57 @@ public:
       _index( other._index ),
       _iter( std::move( other._iter ) ),
       _snapshot( other._snapshot ),
+      _opts( other._opts ),
       _db( other._db ),
+      _batch( other._batch ),
       _cache( other._cache ),
-      _cache_value( other._cache_value )
+      _cache_value( other._cache_value ),
+      _upper_bound( other._upper_bound ),
+      _scanning( other._scanning )
    {
       //_opts.snapshot = _snapshot->snapshot();
       other._snapshot.reset();
       other._db.reset();
    }
 
-   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, cache_type& cache ) :
+   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, batch_ptr batch, cache_type& cache ) :
       _handles( handles ),
       _index( index ),
       _db( db ),
+      _batch( batch ),
       _cache( &cache )
    {
       // Not sure the implicit move constuctor for ManageSnapshot isn't going to release the snapshot...
       //_snapshot = std::make_shared< ::rocksdb::ManagedSnapshot >( &(*_db) );
       //_opts.snapshot = _snapshot->snapshot();
-      //_iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+      //_iter.reset( new_iterator() );
    }
-   rocksdb_iterator( std::shared_ptr< Value >& cache_value, column_handles* handles, size_t index, db_ptr db, cache_type& cache ) :
+   rocksdb_iterator( std::shared_ptr< Value >& cache_value, column_handles* handles, size_t index, db_ptr db, batch_ptr batch, cache_type& cache ) :
       _handles( handles ),
       _index( index ),
       _db( db ),
+      _batch( batch ),
       _cache( &cache ),
       _cache_value( cache_value )
    {
    }
 
-   rocksdb_iterator( std::shared_ptr< Value >& cache_value, column_handles* handles, size_t index, db_ptr db, cache_type& cache, std::unique_ptr< ::rocksdb::Iterator > iter ) :
+   rocksdb_iterator( std::shared_ptr< Value >& cache_value, column_handles* handles, size_t index, db_ptr db, batch_ptr batch, cache_type& cache, std::unique_ptr< ::rocksdb::Iterator > iter ) :
       _handles( handles ),
       _index( index ),
       _iter( std::move( iter ) ),
       _db( db ),
+      _batch( batch ),
       _cache( &cache ),
       _cache_value( cache_value )
    {
    }
 
-   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, cache_type& cache, const Key& k ) :
+   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, batch_ptr batch, cache_type& cache, const Key& k ) :
       _handles( handles ),
       _index( index ),
       _db( db ),
+      _batch( batch ),
       _cache( &cache )
    {
       key_type* id = (key_type*)&k;
@@ -166,7 +254,7 @@ public:
       _cache_value = cache.get_index_cache( index )->get( (void*)id );
       if ( _cache_value == nullptr )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
 
          PinnableSlice key_slice;
          pack_to_slice( key_slice, k );
@@ -182,10 +270,11 @@ public:
       }
    }
 
-   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, cache_type& cache, const ::rocksdb::Slice& s  ) :
+   rocksdb_iterator( column_handles* handles, size_t index, db_ptr db, batch_ptr batch, cache_type& cache, const ::rocksdb::Slice& s  ) :
       _handles( handles ),
       _index( index ),
       _db( db ),
+      _batch( batch ),
       _cache( &cache )
    {
       Key k;
@@ -195,7 +284,7 @@ public:
       _cache_value = cache.get_index_cache( index )->get( (void*)id );
       if ( _cache_value == nullptr )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
          _iter->Seek( s );
 
          assert( _iter->status().ok() && _iter->Valid() );
@@ -230,9 +319,17 @@ public:
                ptr = _cache->cache( std::move( *ptr ) );
             }
             else
+            {
+               if( _scanning )
+                  ptr = prefetch_objects();
+            }
+
+            if( !ptr )
             {
                ::rocksdb::PinnableSlice value_slice;
-               auto s = _db->Get( _opts, &*(*_handles)[ ID_INDEX ], _iter->value(), &value_slice );
+               auto s = _batch ?
+                  _batch->GetFromBatchAndDB( &*_db, _opts, &*(*_handles)[ ID_INDEX ], _iter->value(), &value_slice ) :
+                  _db->Get( _opts, &*(*_handles)[ ID_INDEX ], _iter->value(), &value_slice );
                assert( s.ok() );
 
                ptr = std::make_shared< value_type >();
@@ -257,7 +354,7 @@ public:
       static KeyFromValue key_from_value = KeyFromValue();
       static KeyCompare compare = KeyCompare();
       //BOOST_ASSERT( valid() );
-      if( !valid() ) _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+      if( !valid() ) _iter.reset( new_iterator() );
 
       if ( _cache_value != nullptr )
       {
@@ -269,7 +366,7 @@ public:
             ::rocksdb::PinnableSlice slice;
             pack_to_slice( slice, key );
 
-            _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+            _iter.reset( new_iterator() );
             _iter->Seek( slice );
 
             if( _iter->Valid() )
@@ -279,13 +376,13 @@ public:
 
                if( compare( found_key, key ) != compare( key, found_key ) )
                {
-                  _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+                  _iter.reset( new_iterator() );
                   return *this;
                }
             }
             else
             {
-               _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+               _iter.reset( new_iterator() );
                return *this;
             }
          }
@@ -293,6 +390,7 @@ public:
 
       _iter->Next();
       assert( _iter->status().ok() );
+      _scanning = true;
       return *this;
    }
 
@@ -307,9 +405,10 @@ public:
    rocksdb_iterator& operator--()
    {
       static KeyFromValue key_from_value = KeyFromValue();
+      _scanning = false;
       if( !valid() )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
          _iter->SeekToLast();
       }
       else
@@ -324,7 +423,7 @@ public:
                ::rocksdb::PinnableSlice slice;
                pack_to_slice( slice, key );
 
-               _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+               _iter.reset( new_iterator() );
                _iter->Seek( slice );
 
                if( _iter->Valid() )
@@ -332,13 +431,13 @@ public:
                   ::rocksdb::Slice found_key = _iter->key();
                   if( memcmp( slice.data(), found_key.data(), std::min( slice.size(), found_key.size() ) ) != 0 )
                   {
-                     _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+                     _iter.reset( new_iterator() );
                      return *this;
                   }
                }
                else
                {
-                  _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+                  _iter.reset( new_iterator() );
                   return *this;
                }
             }
@@ -384,21 +483,70 @@ public:
          return _compare( this_key, other_key ) == _compare( other_key, this_key );
       }
 
+      // A bounded scan becomes invalid at its upper bound, which is where the end of the range points
+      if( !valid() && other.valid() )
+         return at_upper_bound( other );
+
+      if( valid() && !other.valid() )
+         return other.at_upper_bound( *this );
+
       return valid() == other.valid();
    }
 
+   /* Bounds the RocksDB iterator to [ current, upper ) so the scan does not read past
+    * the end of the range, and sizes readahead from the approximate size of the range.
+    */
+   void set_scan_bounds( const rocksdb_iterator& upper )
+   {
+      if( !_iter || !_iter->Valid() || !upper._iter || !upper._iter->Valid() || has_pending_writes() )
+         return;
+
+      std::string current = _iter->key().ToString();
+      _upper_bound = std::make_shared< upper_bound_type >( upper._iter->key() );
+
+      ::rocksdb::Range r( current, _upper_bound->slice );
+      ::rocksdb::SizeApproximationOptions size_opts;
+      uint64_t range_size = 0;
+
+      if( _db->GetApproximateSizes( size_opts, &*(*_handles)[ _index ], &r, 1, &range_size ).ok() )
+         _opts.readahead_size = std::min< uint64_t >( range_size, max_readahead_size() );
+
+      _iter.reset( new_iterator() );
+      _iter->Seek( current );
+   }
+
+   bool at_upper_bound( const rocksdb_iterator& other )const
+   {
+      static KeyFromValue key_from_value = KeyFromValue();
+
+      if( !_upper_bound ) return false;
+
+      Key bound_key, other_key;
+      unpack_from_slice( _upper_bound->slice, bound_key );
+
+      if ( other._cache_value != nullptr )
+         other_key = key_from_value( *other._cache_value );
+      else
+         unpack_from_slice( other._iter->key(), other_key );
+
+      return _compare( bound_key, other_key ) == _compare( other_key, bound_key );
+   }
+
    rocksdb_iterator& operator=( const rocksdb_iterator& other )
    {
       _handles = other._handles;
       _index = other._index;
       _snapshot = other._snapshot;
+      _opts = other._opts;
       _db = other._db;
+      _batch = other._batch;
       _cache = other._cache;
       _cache_value = other._cache_value;
+      _upper_bound = other._upper_bound;
 
       if ( other._iter )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
 
          if( other._iter->Valid() )
             _iter->Seek( other._iter->key() );
@@ -412,13 +560,16 @@ public:
       _handles = other._handles;
       _index = other._index;
       _snapshot = other._snapshot;
+      _opts = other._opts;
       _db = other._db;
+      _batch = other._batch;
       _cache = other._cache;
       _cache_value = other._cache_value;
+      _upper_bound = other._upper_bound;
 
       if ( other._iter )
       {
-         _iter.reset( _db->NewIterator( _opts, &*(*_handles)[ _index ] ) );
+         _iter.reset( new_iterator() );
 
          if( other._iter->Valid() )
             _iter->Seek( other._iter->key() );
@@ -432,9 +583,12 @@ public:
       _handles = other._handles;
       _index = other._index;
       _snapshot = other._snapshot;
+      _opts = other._opts;
       _db = other._db;
+      _batch = other._batch;
       _cache = other._cache;
       _cache_value = other._cache_value;
+      _upper_bound = other._upper_bound;
 
       _iter = std::move( other._iter );
 
@@ -442,15 +596,69 @@ public:
    }
 
 
+private:
+   /* Fetches the primary object at the current position together with the primary objects of
+    * the next entries of this secondary index in a single MultiGet, and caches them so the
+    * following steps of the scan are served from the object cache. Returns nullptr if the
+    * current object could not be fetched. Must be called with the index cache lock held.
+    */
+   value_ptr prefetch_objects()
+   {
+      // MultiGet reads the primary objects from the database only, so they must not have pending writes
+      if( prefetch_size() < 2 || has_pending_writes( ID_INDEX ) ) return value_ptr();
+
+      std::vector< std::string > ids;
+      ids.reserve( prefetch_size() );
+      ids.push_back( _iter->value().ToString() );
+
+      {
+         std::unique_ptr< ::rocksdb::Iterator > ahead( new_iterator() );
+         ahead->Seek( _iter->key() );
+         if( ahead->Valid() ) ahead->Next();
+
+         auto id_cache = _cache->get_index_cache( ID_INDEX );
+         for( ; ahead->Valid() && ids.size() < prefetch_size(); ahead->Next() )
+         {
+            ID id;
+            unpack_from_slice( ahead->value(), id );
+            if( id_cache->get( (void*)&id ) ) continue;
+
+            ids.push_back( ahead->value().ToString() );
+         }
+      }
+
+      std::vector< ::rocksdb::Slice > keys( ids.begin(), ids.end() );
+      std::vector< ::rocksdb::PinnableSlice > values( keys.size() );
+      std::vector< ::rocksdb::Status > statuses( keys.size() );
+
+      _db->MultiGet( _opts, &*(*_handles)[ ID_INDEX ], keys.size(), keys.data(), values.data(), statuses.data() );
+
+      value_ptr current;
+      for( size_t i = 0; i < keys.size(); ++i )
+      {
+         if( !statuses[i].ok() ) continue;
+
+         auto ptr = std::make_shared< value_type >();
+         unpack_from_slice( values[i], *ptr );
+         ptr = _cache->cache( std::move( *ptr ) );
+
+         if( i == 0 ) current = ptr;
+      }
+
+      return current;
+   }
+
+public:
    static rocksdb_iterator begin(
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache )
    {
-      rocksdb_iterator itr( handles, index, db, cache );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
       //itr._opts.readahead_size = 4 << 10; // 4K
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      itr._iter.reset( itr.new_iterator() );
       itr._iter->SeekToFirst();
       return itr;
    }
@@ -459,9 +667,10 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache )
    {
-      return rocksdb_iterator( handles, index, db, cache );
+      return rocksdb_iterator( handles, index, db, batch, cache );
    }
 
    template< typename CompatibleKey >
@@ -469,6 +678,7 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const CompatibleKey& k )
    {
@@ -479,11 +689,11 @@ public:
       auto cache_value = cache.get_index_cache( index )->get( (void*)&key );
       if ( cache_value != nullptr )
       {
-         return rocksdb_iterator( cache_value, handles, index, db, cache );
+         return rocksdb_iterator( cache_value, handles, index, db, batch, cache );
       }
 
-      rocksdb_iterator itr( handles, index, db, cache );
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
+      itr._iter.reset( itr.new_iterator() );
 
       PinnableSlice key_slice;
       pack_to_slice( key_slice, key );
@@ -497,12 +707,12 @@ public:
 
          if( compare( k, found_key ) != compare( found_key, k ) )
          {
-            itr._iter.reset( itr._db->NewIterator( itr._opts, &*(*itr._handles)[ itr._index ] ) );
+            itr._iter.reset( itr.new_iterator() );
          }
       }
       else
       {
-         itr._iter.reset( itr._db->NewIterator( itr._opts, &*(*itr._handles)[ itr._index ] ) );
+         itr._iter.reset( itr.new_iterator() );
       }
 
       return itr;
@@ -512,6 +722,7 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const Key& k )
    {
@@ -522,11 +733,11 @@ public:
       auto cache_value = cache.get_index_cache( index )->get( (void*)id );
       if ( cache_value != nullptr )
       {
-         return rocksdb_iterator( cache_value, handles, index, db, cache );
+         return rocksdb_iterator( cache_value, handles, index, db, batch, cache );
       }
 
-      rocksdb_iterator itr( handles, index, db, cache );
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
+      itr._iter.reset( itr.new_iterator() );
 
       PinnableSlice key_slice;
       pack_to_slice( key_slice, k );
@@ -539,12 +750,12 @@ public:
 
          if( compare( k, found_key ) != compare( found_key, k ) )
          {
-            itr._iter.reset( itr._db->NewIterator( itr._opts, &*(*itr._handles)[ itr._index ] ) );
+            itr._iter.reset( itr.new_iterator() );
          }
       }
       else
       {
-         itr._iter.reset( itr._db->NewIterator( itr._opts, &*(*itr._handles)[ itr._index ] ) );
+         itr._iter.reset( itr.new_iterator() );
       }
 
       return itr;
@@ -554,6 +765,7 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const Key& k )
    {
@@ -562,11 +774,11 @@ public:
       auto cache_value = cache.get_index_cache( index )->get( (void*)id );
       if ( cache_value != nullptr )
       {
-         return rocksdb_iterator( cache_value, handles, index, db, cache );
+         return rocksdb_iterator( cache_value, handles, index, db, batch, cache );
       }
 
-      rocksdb_iterator itr( handles, index, db, cache );
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
+      itr._iter.reset( itr.new_iterator() );
 
       PinnableSlice key_slice;
       pack_to_slice( key_slice, k );
@@ -580,13 +792,14 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const CompatibleKey& k )
    {
       static KeyCompare compare = KeyCompare();
       lb_call_count()++;
-      rocksdb_iterator itr( handles, index, db, cache );
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
+      itr._iter.reset( itr.new_iterator() );
 
       PinnableSlice key_slice;
       pack_to_slice( key_slice, Key( k ) );
@@ -601,7 +814,7 @@ public:
          //if( !key_equals( itr_key, k, compare ) )
          if( !is_well_ordered< KeyCompare, true >::value && !compare( itr_key, k ) )
          {
-            rocksdb_iterator prev( handles, index, db, cache );
+            rocksdb_iterator prev( handles, index, db, batch, cache );
             do
             {
                prev = itr--;
@@ -630,11 +843,12 @@ public:
       const column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const Key& k )
    {
-      rocksdb_iterator itr( handles, index, db, cache );
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
+      itr._iter.reset( itr.new_iterator() );
 
       PinnableSlice key_slice;
       pack_to_slice( key_slice, k );
@@ -654,13 +868,14 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const CompatibleKey& k )
    {
       static KeyCompare compare = KeyCompare();
-      rocksdb_iterator itr( handles, index, db, cache );
+      rocksdb_iterator itr( handles, index, db, batch, cache );
       //itr._opts.readahead_size = 4 << 10; // 4K
-      itr._iter.reset( db->NewIterator( itr._opts, &*(*handles)[ index ] ) );
+      itr._iter.reset( itr.new_iterator() );
 
       auto key = Key( k );
       PinnableSlice key_slice;
@@ -690,14 +905,16 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const LowerBoundType& lower,
       const UpperBoundType& upper )
    {
-      return std::make_pair< rocksdb_iterator, rocksdb_iterator >(
-         lower_bound( handles, index, db, cache, lower ),
-         upper_bound( handles, index, db, cache, upper )
-      );
+      auto upper_itr = upper_bound( handles, index, db, batch, cache, upper );
+      auto lower_itr = lower_bound( handles, index, db, batch, cache, lower );
+      lower_itr.set_scan_bounds( upper_itr );
+
+      return std::make_pair< rocksdb_iterator, rocksdb_iterator >( std::move( lower_itr ), std::move( upper_itr ) );
    }
 
    template< typename CompatibleKey >
@@ -705,13 +922,15 @@ public:
       column_handles* handles,
       size_t index,
       db_ptr db,
+      batch_ptr batch,
       cache_type& cache,
       const CompatibleKey& k )
    {
-      return std::make_pair< rocksdb_iterator, rocksdb_iterator >(
-         lower_bound( handles, index, db, cache, k ),
-         upper_bound( handles, index, db, cache, k )
-      );
+      auto upper_itr = upper_bound( handles, index, db, batch, cache, k );
+      auto lower_itr = lower_bound( handles, index, db, batch, cache, k );
+      lower_itr.set_scan_bounds( upper_itr );
+
+      return std::make_pair< rocksdb_iterator, rocksdb_iterator >( std::move( lower_itr ), std::move( upper_itr ) );
    }
 };
 
@@ -589,6 +589,38 @@ struct multi_index_adapter
       );
    }
 
+   std::map< std::string, uint64_t > get_rocksdb_statistics()const
+   {
+      return boost::apply_visitor(
+         []( auto& index ){ return index.get_rocksdb_statistics(); },
+         _index
+      );
+   }
+
+   bool set_batch_writes( bool batch_writes )
+   {
+      return boost::apply_visitor(
+         [=]( auto& index ){ return index.set_batch_writes( batch_writes ); },
+         _index
+      );
+   }
+
+   bool commit_write_batch()
+   {
+      return boost::apply_visitor(
+         []( auto& index ){ return index.commit_write_batch(); },
+         _index
+      );
+   }
+
+   void set_write_options( bool disable_wal, bool sync )
+   {
+      boost::apply_visitor(
+         [=]( auto& index ){ index.set_write_options( disable_wal, sync ); },
+         _index
+      );
+   }
+
    private:
       index_variant  _index;
       index_type     _type = mira;
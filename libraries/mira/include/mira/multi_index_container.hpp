@@ -49,6 +49,8 @@
 #include <rocksdb/convenience.h>
 
 #include <iostream>
+#include <map>
+#include <vector>
 
 #if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
 #include <initializer_list>
@@ -91,6 +93,7 @@ private:
    std::string                                     _name;
    std::shared_ptr< ::rocksdb::Statistics >        _stats;
    ::rocksdb::WriteOptions                         _wopts;
+   bool                                            _batch_writes = false;
 
    rocksdb::ReadOptions                            _ropts;
 
@@ -185,6 +188,7 @@ public:
       _name( other._name ),
       _stats( other._stats ),
       _wopts( other._wopts ),
+      _batch_writes( other._batch_writes ),
       _ropts( other._ropts ),
       entry_count( other.entry_count )
    {}
@@ -195,6 +199,7 @@ public:
       _name( std::move( other._name ) ),
       _stats( std::move( other._stats ) ),
       _wopts( std::move( other._wopts ) ),
+      _batch_writes( other._batch_writes ),
       _ropts( std::move( other._ropts ) ),
       entry_count( other.entry_count )
    {}
@@ -206,6 +211,7 @@ public:
       _name = rhs._name;
       _stats = rhs._stats;
       _wopts = rhs._wopts;
+      _batch_writes = rhs._batch_writes;
       _ropts = rhs._ropts;
       entry_count = rhs.entry_count;
 
@@ -219,6 +225,7 @@ public:
       _name = std::move( rhs._name );
       _stats = std::move( rhs._stats );
       _wopts = std::move( rhs._wopts );
+      _batch_writes = rhs._batch_writes;
       _ropts = std::move( rhs._ropts );
       entry_count = rhs.entry_count;
 
@@ -317,6 +324,8 @@ public:
    {
       if( super::_db && super::_db.unique() )
       {
+         commit_write_batch();
+
          auto ser_count_key = fc::raw::pack_to_vector( ENTRY_COUNT_KEY );
          auto ser_count_val = fc::raw::pack_to_vector( entry_count );
 
@@ -356,6 +365,7 @@ public:
    {
       if( super::_db )
       {
+         commit_write_batch();
          super::flush();
       }
    }
@@ -461,9 +471,11 @@ int64_t set_revision( int64_t rev )
    const static ::rocksdb::Slice rev_slice( ser_rev_key.data(), ser_rev_key.size() );
    auto ser_rev_val = fc::raw::pack_to_vector( rev );
 
-   auto s = super::_db->Put(
-      _wopts, rev_slice,
-      ::rocksdb::Slice( ser_rev_val.data(), ser_rev_val.size() ) );
+   ::rocksdb::Slice rev_val_slice( ser_rev_val.data(), ser_rev_val.size() );
+
+   auto s = _batch_writes
+      ? super::_write_buffer->Put( rev_slice, rev_val_slice )
+      : super::_db->Put( _wopts, rev_slice, rev_val_slice );
 
    if( s.ok() ) _revision = rev;
 
@@ -494,6 +506,109 @@ void print_stats() const
    }
 }
 
+/**
+ * When enabled, writes are accumulated in the container's write batch instead of
+ * being written to the database on every insert, modify and erase. Reads through
+ * the container's iterators see the pending writes. The batch is written to the
+ * database atomically by commit_write_batch(). Disabling batch writes commits
+ * any pending writes.
+ */
+bool set_batch_writes( bool batch_writes )
+{
+   bool success = true;
+   if( _batch_writes && !batch_writes )
+      success = commit_write_batch();
+
+   _batch_writes = batch_writes;
+   return success;
+}
+
+bool batch_writes() const { return _batch_writes; }
+
+bool commit_write_batch()
+{
+   if( !super::_db ) return true;
+
+   auto batch = super::_write_buffer->GetWriteBatch();
+   if( batch->Count() == 0 ) return true;
+
+   auto s = super::_db->Write( _wopts, batch );
+   if( !s.ok() )
+   {
+      elog( "Failed to commit write batch for ${db}: ${e}",
+         ("db", boost::core::demangle( typeid( Value ).name() ))("e", s.ToString()) );
+      return false;
+   }
+
+   super::_write_buffer->Clear();
+   return true;
+}
+
+void set_write_options( bool disable_wal, bool sync )
+{
+   _wopts.disableWAL = disable_wal;
+   _wopts.sync = sync;
+}
+
+/**
+ * Returns a snapshot of the RocksDB internals for this index.
+ *
+ * Database properties (memtable size, pending compaction bytes, etc.) are always
+ * reported. Ticker and histogram values are only available when the global
+ * 'statistics' option is enabled in the database configuration.
+ */
+std::map< std::string, uint64_t > get_rocksdb_statistics() const
+{
+   std::map< std::string, uint64_t > stats;
+
+   if( !super::_db ) return stats;
+
+   static const std::vector< std::pair< std::string, std::string > > int_properties {
+      { "memtable_size",            ::rocksdb::DB::Properties::kCurSizeAllMemTables            },
+      { "pending_compaction_bytes", ::rocksdb::DB::Properties::kEstimatePendingCompactionBytes },
+      { "estimated_num_keys",       ::rocksdb::DB::Properties::kEstimateNumKeys                },
+      { "live_sst_files_size",      ::rocksdb::DB::Properties::kLiveSstFilesSize               },
+      { "running_compactions",      ::rocksdb::DB::Properties::kNumRunningCompactions          },
+      { "table_readers_mem",        ::rocksdb::DB::Properties::kEstimateTableReadersMem        }
+   };
+
+   for( const auto& p : int_properties )
+   {
+      uint64_t value = 0;
+      if( super::_db->GetAggregatedIntProperty( p.second, &value ) )
+         stats[ p.first ] = value;
+   }
+
+   if( _stats )
+   {
+      static const std::vector< std::pair< std::string, ::rocksdb::Tickers > > tickers {
+         { "block_cache_hit",           ::rocksdb::BLOCK_CACHE_HIT           },
+         { "block_cache_miss",          ::rocksdb::BLOCK_CACHE_MISS          },
+         { "bloom_filter_useful",       ::rocksdb::BLOOM_FILTER_USEFUL       },
+         { "memtable_hit",              ::rocksdb::MEMTABLE_HIT              },
+         { "memtable_miss",             ::rocksdb::MEMTABLE_MISS             },
+         { "stall_micros",              ::rocksdb::STALL_MICROS              },
+         { "keys_read",                 ::rocksdb::NUMBER_KEYS_READ          },
+         { "keys_written",              ::rocksdb::NUMBER_KEYS_WRITTEN       },
+         { "bytes_read",                ::rocksdb::BYTES_READ                },
+         { "bytes_written",             ::rocksdb::BYTES_WRITTEN             },
+         { "iter_seeks",                ::rocksdb::NUMBER_DB_SEEK            },
+         { "compact_read_bytes",        ::rocksdb::COMPACT_READ_BYTES        },
+         { "compact_write_bytes",       ::rocksdb::COMPACT_WRITE_BYTES       }
+      };
+
+      for( const auto& t : tickers )
+         stats[ t.first ] = _stats->getTickerCount( t.second );
+
+      // Each SST read is a block fetched from disk, which is what drives read amplification
+      ::rocksdb::HistogramData sst_reads;
+      _stats->histogramData( ::rocksdb::SST_READ_MICROS, &sst_reads );
+      stats[ "sst_reads" ] = sst_reads.count;
+   }
+
+   return stats;
+}
+
 size_t get_cache_usage() const
 {
    return super::_cache->usage();
@@ -618,9 +733,10 @@ primary_iterator erase( primary_iterator position )
    bool insert_( value_type& v )
    {
       bool status = false;
+      begin_write_();
       if( super::insert_rocksdb_( v ) )
       {
-         auto retval = super::_db->Write( _wopts, super::_write_buffer.GetWriteBatch() );
+         auto retval = end_write_( true );
          status = retval.ok();
          if( status )
          {
@@ -635,17 +751,18 @@ primary_iterator erase( primary_iterator position )
       }
       else
       {
+         end_write_( false );
          super::reset_first_key_update();
       }
-      super::_write_buffer.Clear();
 
       return status;
    }
 
    void erase_( value_type& v )
    {
+      begin_write_();
       super::erase_( v );
-      auto retval = super::_db->Write( _wopts, super::_write_buffer.GetWriteBatch() );
+      auto retval = end_write_( true );
       bool status = retval.ok();
       if( status )
       {
@@ -659,12 +776,11 @@ primary_iterator erase( primary_iterator position )
          elog( "${e}", ("e", retval.ToString()) );
          super::reset_first_key_update();
       }
-
-      super::_write_buffer.Clear();
    }
 
   void clear_()
   {
+    super::_write_buffer->Clear();
     super::clear_();
     super::_cache->clear();
     entry_count=0;
@@ -675,9 +791,10 @@ primary_iterator erase( primary_iterator position )
    {
       bool status = false;
       std::vector< size_t > modified_indices;
+      begin_write_();
       if( super::modify_( mod, v, modified_indices ) )
       {
-         auto retval = super::_db->Write( _wopts, super::_write_buffer.GetWriteBatch() );
+         auto retval = end_write_( true );
          status = retval.ok();
 
          if( status )
@@ -698,14 +815,42 @@ primary_iterator erase( primary_iterator position )
       }
       else
       {
+         end_write_( false );
          super::reset_first_key_update();
       }
 
-      super::_write_buffer.Clear();
-
       return status;
    }
 
+   void begin_write_()
+   {
+      if( _batch_writes ) super::_write_buffer->SetSavePoint();
+   }
+
+   // Applies or discards the writes of a single operation. When batching, the
+   // operation is kept in or rolled back from the pending batch. Otherwise it
+   // is written to the database immediately.
+   ::rocksdb::Status end_write_( bool success )
+   {
+      ::rocksdb::Status s;
+
+      if( _batch_writes )
+      {
+         if( success )
+            super::_write_buffer->PopSavePoint();
+         else
+            s = super::_write_buffer->RollbackToSavePoint();
+
+         return s;
+      }
+
+      if( success )
+         s = super::_db->Write( _wopts, super::_write_buffer->GetWriteBatch() );
+
+      super::_write_buffer->Clear();
+      return s;
+   }
+
    template< typename MetaKey, typename MetaValue >
    bool get_metadata( const MetaKey& k, MetaValue& v )
    {
@@ -715,7 +860,8 @@ primary_iterator erase( primary_iterator position )
 
       pack_to_slice( key_slice, k );
 
-      auto status = super::_db->Get(
+      auto status = super::_write_buffer->GetFromBatchAndDB(
+         &*super::_db,
          _ropts,
          &*super::_handles[ 0 ],
          key_slice,
@@ -743,11 +889,9 @@ primary_iterator erase( primary_iterator position )
       pack_to_slice( key_slice, k );
       pack_to_slice( value_slice, v );
 
-      auto status = super::_db->Put(
-         _wopts,
-         &*super::_handles[0],
-         key_slice,
-         value_slice );
+      auto status = _batch_writes
+         ? super::_write_buffer->Put( &*super::_handles[0], key_slice, value_slice )
+         : super::_db->Put( _wopts, &*super::_handles[0], key_slice, value_slice );
 
       if( status.ok() )
       {
@@ -16,6 +16,7 @@
 #include <mira/slice_pack.hpp>
 
 #include <rocksdb/db.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
 
 #include <memory>
 
@@ -111,6 +112,7 @@ void swap(
   multi_index_container<Value,IndexSpecifierList,Allocator>& y);
 
 typedef std::shared_ptr< ::rocksdb::DB >                 db_ptr;
+typedef std::shared_ptr< ::rocksdb::WriteBatchWithIndex > batch_ptr;
 typedef std::vector< ::rocksdb::ColumnFamilyDescriptor > column_definitions;
 typedef std::vector< std::shared_ptr< ::rocksdb::ColumnFamilyHandle > >    column_handles;
 
@@ -11,6 +11,11 @@ namespace mira {
 #define WRITE_BUFFER_MANAGER             "write_buffer_manager"
 #define OBJECT_COUNT                     "object_count"
 #define STATISTICS                       "statistics"
+#define INDEX_PLACEMENT                  "index_placement"
+
+// Index placement values
+#define PLACEMENT_MIRA                   "mira"
+#define PLACEMENT_BMIC                   "bmic"
 
 // Write buffer manager options
 #define WRITE_BUFFER_SIZE                "write_buffer_size"
@@ -36,6 +41,7 @@ namespace mira {
 #define BITS_PER_KEY                     "bits_per_key"
 #define USE_BLOCK_BASED_BUILDER          "use_block_based_builder"
 #define CACHE_INDEX_AND_FILTER_BLOCKS    "cache_index_and_filter_blocks"
+#define STATS_DUMP_PERIOD_SEC            "stats_dump_period_sec"
 
 static std::shared_ptr< rocksdb::Cache > global_shared_cache;
 static std::shared_ptr< rocksdb::WriteBufferManager > global_write_buffer_manager;
@@ -49,6 +55,7 @@ static std::map< std::string, std::function< void( ::rocksdb::Options&, fc::vari
    { MAX_BACKGROUND_COMPACTIONS,        []( ::rocksdb::Options& o, fc::variant v ) { o.max_background_compactions = v.as< int >(); }        },
    { MAX_BACKGROUND_FLUSHES,            []( ::rocksdb::Options& o, fc::variant v ) { o.max_background_flushes = v.as< int >(); }            },
    { MIN_WRITE_BUFFER_NUMBER_TO_MERGE,  []( ::rocksdb::Options& o, fc::variant v ) { o.min_write_buffer_number_to_merge = v.as< int >(); }  },
+   { STATS_DUMP_PERIOD_SEC,             []( ::rocksdb::Options& o, fc::variant v ) { o.stats_dump_period_sec = v.as< unsigned int >(); }    },
    { OPTIMIZE_LEVEL_STYLE_COMPACTION,   []( ::rocksdb::Options& o, fc::variant v )
       {
          if ( v.as< bool >() )
@@ -216,6 +223,41 @@ bool configuration::gather_statistics( const boost::any& cfg )
    return statistics;
 }
 
+std::map< std::string, std::string > configuration::get_index_placement( const boost::any& cfg )
+{
+   std::map< std::string, std::string > placement;
+
+   auto c = boost::any_cast< fc::variant >( cfg );
+   FC_ASSERT( c.is_object(), "Expected database configuration to be an object" );
+   auto& obj = c.get_object();
+
+   fc::variant_object global_config = retrieve_global_configuration( obj );
+
+   // Index placement is optional, every index lives in RocksDB when it is absent
+   if ( !global_config.contains( INDEX_PLACEMENT ) )
+      return placement;
+
+   FC_ASSERT( global_config[ INDEX_PLACEMENT ].is_object(), "Expected '${key}' to be an object",
+      ("key", INDEX_PLACEMENT) );
+
+   auto& placement_obj = global_config[ INDEX_PLACEMENT ].get_object();
+   for ( auto it = placement_obj.begin(); it != placement_obj.end(); ++it )
+   {
+      FC_ASSERT( it->value().is_string(), "Expected placement of '${index}' to be a string",
+         ("index", it->key()) );
+
+      auto type = it->value().as_string();
+      FC_ASSERT( type == PLACEMENT_MIRA || type == PLACEMENT_BMIC, "Expected placement of '${index}' to be '${mira}' or '${bmic}'",
+         ("index", it->key())
+         ("mira", PLACEMENT_MIRA)
+         ("bmic", PLACEMENT_BMIC) );
+
+      placement[ it->key() ] = type;
+   }
+
+   return placement;
+}
+
 ::rocksdb::Options configuration::get_options( const boost::any& cfg, std::string type_name )
 {
    ::rocksdb::Options opts;
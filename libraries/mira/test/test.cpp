@@ -34,6 +34,35 @@ struct mira_fixture {
    }
 };
 
+// Whether an index iterator reads through the pending writes of its write batch
+struct pending_writes_visitor : public boost::static_visitor< bool >
+{
+   template< typename Iter >
+   bool operator()( const Iter& itr )const { return check( itr, 0 ); }
+
+   template< typename Iter >
+   static auto check( const Iter& itr, int ) -> decltype( itr.has_pending_writes() ) { return itr.has_pending_writes(); }
+
+   template< typename Iter >
+   static bool check( const Iter&, long ) { return false; }
+};
+
+template< typename Iter >
+bool has_pending_writes( const Iter& itr )
+{
+   return boost::apply_visitor( pending_writes_visitor(), itr._itr );
+}
+
+// Values of `a` of the books in the iteration order of an index
+template< typename Index >
+std::vector< int > get_values( const Index& idx )
+{
+   std::vector< int > values;
+   for( auto itr = idx.begin(); itr != idx.end(); ++itr )
+      values.push_back( itr->a );
+   return values;
+}
+
 BOOST_FIXTURE_TEST_SUITE( mira_tests, mira_fixture )
 
 BOOST_AUTO_TEST_CASE( sanity_tests )
@@ -764,6 +793,239 @@ BOOST_AUTO_TEST_CASE( bounds_test )
    FC_LOG_AND_RETHROW();
 }
 
+BOOST_AUTO_TEST_CASE( scan_with_undo_session_test )
+{
+   try
+   {
+      db.add_index< test_object3_index >();
+      db.set_batch_writes( true );
+
+      for ( uint32_t i = 0; i < 10; i++ )
+      {
+         for ( uint32_t j = 0; j < 10; j++ )
+         {
+            db.create< test_object3 >( [=] ( test_object3& o )
+            {
+               o.val = i;
+               o.val2 = j;
+               o.val3 = i + j;
+            } );
+         }
+      }
+
+      db.commit_write_batches();
+
+      const auto& idx = db.get_index< test_object3_index, composite_ordered_idx3a >();
+
+      auto count_range = [&]( uint32_t val )
+      {
+         auto er = idx.equal_range( val );
+         uint32_t n = 0;
+         for( auto itr = er.first; itr != er.second; ++itr )
+         {
+            BOOST_REQUIRE( itr->val == val );
+            BOOST_REQUIRE( itr->val2 == n );
+            ++n;
+         }
+         return n;
+      };
+
+      BOOST_TEST_MESSAGE( "Revision written by an undo session does not disable bounded scans" );
+      auto session = db.start_undo_session();
+
+      auto er = idx.equal_range( 5 );
+      BOOST_REQUIRE( !has_pending_writes( er.first ) );
+      BOOST_REQUIRE( count_range( 5 ) == 10 );
+
+      BOOST_TEST_MESSAGE( "Pending writes to the index are visible to scans" );
+      db.create< test_object3 >( [] ( test_object3& o )
+      {
+         o.val = 5;
+         o.val2 = 10;
+         o.val3 = 15;
+      } );
+
+      er = idx.equal_range( 5 );
+      BOOST_REQUIRE( has_pending_writes( er.first ) );
+      BOOST_REQUIRE( count_range( 5 ) == 11 );
+      BOOST_REQUIRE( count_range( 4 ) == 10 );
+
+      session.undo();
+      db.commit_write_batches();
+
+      BOOST_REQUIRE( count_range( 5 ) == 10 );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
+BOOST_AUTO_TEST_CASE( batch_read_your_writes_test )
+{
+   try
+   {
+      db.add_index< book_index >();
+      db.set_batch_writes( true );
+
+      db.create< book >( []( book& b ) { b.a = 1; b.b = 2; } );
+      db.create< book >( []( book& b ) { b.a = 2; b.b = 3; } );
+      db.commit_write_batches();
+
+      BOOST_TEST_MESSAGE( "Uncommitted creates are found by every index" );
+      db.create< book >( []( book& b ) { b.a = 3; b.b = 4; } );
+
+      BOOST_REQUIRE( db.find< book, by_id >( 2 ) != nullptr );
+      BOOST_REQUIRE( db.find< book, by_a >( 3 ) != nullptr );
+      BOOST_REQUIRE( db.find< book, by_b >( boost::make_tuple( 4, 3 ) ) != nullptr );
+      BOOST_REQUIRE( db.find< book, by_sum >( 7 ) != nullptr );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 1, 2, 3 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_b >() ) == std::vector< int >( { 3, 2, 1 } ) );
+
+      BOOST_TEST_MESSAGE( "Uncommitted modifies move the object in every index" );
+      db.modify( db.get< book, by_a >( 1 ), []( book& b ) { b.a = 10; } );
+
+      BOOST_REQUIRE( db.find< book, by_a >( 1 ) == nullptr );
+      BOOST_REQUIRE( db.get< book, by_a >( 10 ).id._id == 0 );
+      BOOST_REQUIRE( db.find< book, by_sum >( 3 ) == nullptr );
+      BOOST_REQUIRE( db.get< book, by_sum >( 12 ).id._id == 0 );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 2, 3, 10 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_id >() ) == std::vector< int >( { 10, 2, 3 } ) );
+
+      BOOST_TEST_MESSAGE( "Uncommitted removes hide the object from every index" );
+      db.remove( db.get< book, by_a >( 2 ) );
+
+      BOOST_REQUIRE( db.find< book, by_id >( 1 ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_b >( boost::make_tuple( 3, 2 ) ) == nullptr );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 3, 10 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_sum >() ) == std::vector< int >( { 3, 10 } ) );
+
+      db.commit_write_batches();
+
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 3, 10 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_id >() ) == std::vector< int >( { 10, 3 } ) );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
+BOOST_AUTO_TEST_CASE( batch_uniqueness_violation_test )
+{
+   try
+   {
+      db.add_index< book_index >();
+      db.set_batch_writes( true );
+
+      db.create< book >( []( book& b ) { b.a = 1; b.b = 2; } );
+      db.create< book >( []( book& b ) { b.a = 4; b.b = 5; } );
+
+      // Secondary indices are written from the last one to by_a, so a collision in by_a
+      // comes after the new keys of by_b and by_sum are already in the batch.
+      BOOST_TEST_MESSAGE( "Rejected insert leaves no entries in the other indices" );
+      BOOST_REQUIRE_THROW( db.create< book >( []( book& b ) { b.a = 1; b.b = 7; } ), std::logic_error );
+
+      BOOST_REQUIRE( db.find< book, by_b >( boost::make_tuple( 7, 1 ) ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_sum >( 8 ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_id >( 2 ) == nullptr );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 1, 4 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_b >() ) == std::vector< int >( { 4, 1 } ) );
+      BOOST_REQUIRE( db.get_index< book_index, by_id >().size() == 2 );
+
+      BOOST_TEST_MESSAGE( "Rejected modify leaves the object where it was in every index" );
+      BOOST_REQUIRE_THROW( db.modify( db.get< book, by_a >( 4 ), []( book& b ) { b.a = 1; b.b = 7; } ), std::logic_error );
+
+      BOOST_REQUIRE( db.find< book, by_b >( boost::make_tuple( 7, 1 ) ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_sum >( 8 ) == nullptr );
+      BOOST_REQUIRE( db.get< book, by_a >( 1 ).id._id == 0 );
+      BOOST_REQUIRE( db.get< book, by_a >( 4 ).id._id == 1 );
+      BOOST_REQUIRE( db.get< book, by_b >( boost::make_tuple( 5, 4 ) ).id._id == 1 );
+      BOOST_REQUIRE( db.get< book, by_sum >( 9 ).id._id == 1 );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 1, 4 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_sum >() ) == std::vector< int >( { 1, 4 } ) );
+
+      BOOST_TEST_MESSAGE( "Writes before the rejected ones are kept" );
+      db.create< book >( []( book& b ) { b.a = 2; b.b = 5; } );
+      db.commit_write_batches();
+
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 1, 2, 4 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_b >() ) == std::vector< int >( { 2, 4, 1 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_sum >() ) == std::vector< int >( { 1, 2, 4 } ) );
+      BOOST_REQUIRE( db.get_index< book_index, by_id >().size() == 3 );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
+BOOST_AUTO_TEST_CASE( batch_undo_session_test )
+{
+   try
+   {
+      db.add_index< book_index >();
+      db.set_batch_writes( true );
+
+      db.create< book >( []( book& b ) { b.a = 1; b.b = 2; } );
+      db.create< book >( []( book& b ) { b.a = 2; b.b = 3; } );
+      db.commit_write_batches();
+
+      BOOST_TEST_MESSAGE( "Undo of a session whose writes were never committed" );
+      {
+         auto session = db.start_undo_session();
+
+         db.create< book >( []( book& b ) { b.a = 3; b.b = 4; } );
+         db.modify( db.get< book, by_a >( 1 ), []( book& b ) { b.a = 10; } );
+         db.remove( db.get< book, by_a >( 2 ) );
+
+         BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 3, 10 } ) );
+
+         session.undo();
+      }
+
+      BOOST_REQUIRE( db.find< book, by_a >( 3 ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_a >( 10 ) == nullptr );
+      BOOST_REQUIRE( db.get< book, by_a >( 1 ).id._id == 0 );
+      BOOST_REQUIRE( db.get< book, by_sum >( 5 ).id._id == 1 );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 1, 2 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_b >() ) == std::vector< int >( { 2, 1 } ) );
+
+      db.commit_write_batches();
+
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_id >() ) == std::vector< int >( { 1, 2 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_sum >() ) == std::vector< int >( { 1, 2 } ) );
+      BOOST_REQUIRE( db.get_index< book_index, by_id >().size() == 2 );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
+BOOST_AUTO_TEST_CASE( batch_commit_reopen_test )
+{
+   try
+   {
+      db.add_index< book_index >();
+      db.set_batch_writes( true );
+
+      db.create< book >( []( book& b ) { b.a = 1; b.b = 2; } );
+      db.create< book >( []( book& b ) { b.a = 2; b.b = 3; } );
+      db.create< book >( []( book& b ) { b.a = 3; b.b = 4; } );
+      db.commit_write_batches();
+
+      db.modify( db.get< book, by_a >( 1 ), []( book& b ) { b.a = 10; } );
+      db.remove( db.get< book, by_a >( 2 ) );
+      db.commit_write_batches();
+
+      BOOST_TEST_MESSAGE( "Committed state survives reopening the database" );
+      db.close();
+      db.open( tmp, 0, 1024*1024*8, blurt::utilities::default_database_configuration() );
+
+      BOOST_REQUIRE( db.get_index< book_index, by_id >().size() == 2 );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_id >() ) == std::vector< int >( { 10, 3 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_a >() ) == std::vector< int >( { 3, 10 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_b >() ) == std::vector< int >( { 3, 10 } ) );
+      BOOST_REQUIRE( get_values( db.get_index< book_index, by_sum >() ) == std::vector< int >( { 3, 10 } ) );
+      BOOST_REQUIRE( db.find< book, by_a >( 1 ) == nullptr );
+      BOOST_REQUIRE( db.find< book, by_id >( 1 ) == nullptr );
+
+      BOOST_TEST_MESSAGE( "Ids continue after reopening" );
+      const auto& new_book = db.create< book >( []( book& b ) { b.a = 4; b.b = 5; } );
+      BOOST_REQUIRE( new_book.id._id == 3 );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
 BOOST_AUTO_TEST_CASE( basic_tests )
 {
    db.add_index< test_object_index >();
@@ -35,14 +35,17 @@ class account_history_plugin_impl
       virtual ~account_history_plugin_impl() {}
 
       void on_pre_apply_operation( const operation_notification& note );
+      void on_irreversible_block( uint32_t block_num );
 
       flat_map< account_name_type, account_name_type > _tracked_accounts;
       bool                                             _filter_content = false;
       bool                                             _blacklist = false;
       flat_set< string >                               _op_list;
       bool                                             _prune = true;
+      bool                                             _locators_only = false;
       database&                        _db;
       boost::signals2::connection      _pre_apply_operation_conn;
+      boost::signals2::connection      _irreversible_block_conn;
 };
 
 struct operation_visitor
@@ -71,6 +74,7 @@ struct operation_visitor
             obj.trx_in_block = _note.trx_in_block;
             obj.op_in_trx    = _note.op_in_trx;
             obj.virtual_op   = _note.virtual_op;
+            obj.op_type      = _note.op.which();
             obj.timestamp    = _db.head_block_time();
             //fc::raw::pack( obj.serialized_op , _note.op);  //call to 'pack' is ambiguous
             auto size = fc::raw::pack_size( _note.op );
@@ -207,6 +211,31 @@ void account_history_plugin_impl::on_pre_apply_operation( const operation_notifi
    }
 }
 
+/**
+ * In locators only mode, payloads of non-virtual operations are dropped as soon as their block becomes
+ * irreversible (so it is guaranteed to be found in block_log), leaving only the location of operation
+ * (block, trx_in_block, op_in_trx) to read it back from. Virtual operations are not stored in blocks,
+ * so they keep their payloads.
+ */
+void account_history_plugin_impl::on_irreversible_block( uint32_t block_num )
+{
+   const auto& idx = _db.get_index< chain::operation_index, chain::by_location >();
+   auto itr = idx.lower_bound( block_num );
+
+   for( ; itr != idx.end() && itr->block == block_num; ++itr )
+   {
+      // Virtual operations are always numbered starting from 1 within their block
+      if( itr->virtual_op != 0 || itr->serialized_op.empty() )
+         continue;
+
+      _db.modify( *itr, []( operation_object& obj )
+      {
+         obj.serialized_op.clear();
+         obj.serialized_op.shrink_to_fit();
+      });
+   }
+}
+
 } // detail
 
 account_history_plugin::account_history_plugin() {}
@@ -225,6 +254,7 @@ void account_history_plugin::set_program_options(
          ("account-history-blacklist-ops", boost::program_options::value< vector< string > >()->composing(), "Defines a list of operations which will be explicitly ignored.")
          ("history-blacklist-ops", boost::program_options::value< vector< string > >()->composing(), "Defines a list of operations which will be explicitly ignored. Deprecated in favor of account-history-blacklist-ops.")
          ("history-disable-pruning", boost::program_options::value< bool >()->default_value( false ), "Disables automatic account history trimming" )
+         ("account-history-locators-only", boost::program_options::value< bool >()->default_value( false ), "Keeps only locations of non-virtual operations once their block is irreversible, reading them back from block_log when requested. Greatly reduces shared memory usage." )
          ;
 }
 
@@ -348,6 +378,19 @@ void account_history_plugin::plugin_initialize( const boost::program_options::va
    }
    state_opts["history-disable-pruning"] = my->_prune;
 
+   if( options.count( "account-history-locators-only" ) )
+   {
+      my->_locators_only = options.at( "account-history-locators-only" ).as< bool >();
+   }
+
+   if( my->_locators_only )
+   {
+      my->_irreversible_block_conn = my->_db.add_irreversible_block_handler(
+         [&]( uint32_t block_num ){ my->on_irreversible_block( block_num ); }, *this );
+
+      ilog( "Account History: storing only locators of irreversible non-virtual operations" );
+   }
+
    appbase::app().get_plugin< chain::chain_plugin >().report_state_options( name(), state_opts );
 }
 
@@ -356,6 +399,7 @@ void account_history_plugin::plugin_startup() {}
 void account_history_plugin::plugin_shutdown()
 {
    chain::util::disconnect_signal( my->_pre_apply_operation_conn );
+   chain::util::disconnect_signal( my->_irreversible_block_conn );
 }
 
 flat_map< account_name_type, account_name_type > account_history_plugin::tracked_accounts() const
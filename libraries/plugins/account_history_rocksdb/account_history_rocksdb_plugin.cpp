@@ -15,18 +15,34 @@
 
 #include <appbase/application.hpp>
 
+#include <rocksdb/cache.h>
+#include <rocksdb/convenience.h>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
 #include <rocksdb/options.h>
 #include <rocksdb/slice.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/table.h>
 #include "rocksdb/write_batch.h"
 #include <rocksdb/utilities/write_batch_with_index.h>
 
 #include <boost/type.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/io_service.hpp>
 #include <boost/container/flat_set.hpp>
-
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <limits>
+#include <mutex>
+#include <random>
 #include <string>
+#include <thread>
 #include <typeindex>
 #include <typeinfo>
 
@@ -43,10 +59,46 @@ namespace bpo = boost::program_options;
 #define OPERATION_BY_BLOCK 3
 #define AH_INFO_BY_NAME 4
 #define AH_OPERATION_BY_ID 5
+#define TRANSACTION_BY_ID 6
+#define AH_OP_TYPE_SUMMARY_BY_ID 7
 
 #define WRITE_BUFFER_FLUSH_LIMIT     10
+/// Default number of irreversible blocks which can wait for the writer thread.
+#define WRITE_QUEUE_SIZE_LIMIT       100
+/// Default time (in seconds) an unused account history cursor is kept open.
+#define CURSOR_TTL                   60
+/// Default limit of simultaneously open account history cursors. The least recently used one is closed to open another.
+#define MAX_CURSORS                  100
+
+#define DEFAULT_BLOCK_SIZE           (16 * 1024)
+#define DEFAULT_BLOOM_BITS           10
+#define DEFAULT_DICTIONARY_SIZE      (16 * 1024)
+/// Default size (in MB) of block cache shared by all columns.
+#define DEFAULT_BLOCK_CACHE_SIZE     512
+/// Amount of data sampled by ZSTD to train a dictionary, relative to dictionary size.
+#define DICTIONARY_TRAINING_FACTOR   100
+/// Default size (in MB) of hot storage tier of single column family, when cold storage path is given.
+#define DEFAULT_HOT_STORAGE_SIZE     (16 * 1024)
+/// Number of blocks read from block log, before they are passed to the import pipeline.
+#define IMPORT_BLOCK_CHUNK_SIZE      1000
+/// Number of newest entries of each account, which are never pruned.
 #define ACCOUNT_HISTORY_LENGTH_LIMIT 30
+/// Default age (in days) of account history entries, which can be pruned.
 #define ACCOUNT_HISTORY_TIME_LIMIT   30
+/// Default time (in seconds) between subsequent pruning passes over all accounts.
+#define PRUNE_INTERVAL               3600
+/** Time (in seconds) the oldest entry of an account must be past the pruning cutoff, before the account is pruned.
+ *  Lets single DeleteRange remove a day of entries, instead of a few ones at every pass.
+ */
+#define PRUNE_THRESHOLD              (24 * 3600)
+/// Number of accounts pruned in a single write.
+#define PRUNE_BATCH_SIZE             1000
+/// Number of subsequent account history entries covered by single operation type summary.
+#define AH_OP_TYPE_SUMMARY_CHUNK     256
+/// Filtered block range export and account history read examine at most this many entries per requested operation...
+#define FILTERED_SCAN_FACTOR         10
+/// ...but no less than this many, before returning the position to resume from.
+#define FILTERED_SCAN_MIN            1000
 #define VIRTUAL_OP_FLAG              0x8000000000000000
 
 /** Because localtion_id_pair stores block_number paired with (VIRTUAL_OP_FLAG|operation_id),
@@ -55,7 +107,7 @@ namespace bpo = boost::program_options;
 #define MAX_OPERATION_ID             std::numeric_limits<int64_t>::max()
 
 #define STORE_MAJOR_VERSION          1
-#define STORE_MINOR_VERSION          0
+#define STORE_MINOR_VERSION          4
 
 namespace blurt { namespace plugins { namespace account_history_rocksdb {
 
@@ -73,11 +125,13 @@ using blurt::utilities::benchmark_dumper;
 
 using ::rocksdb::DB;
 using ::rocksdb::DBOptions;
+using ::rocksdb::DbPath;
 using ::rocksdb::Options;
 using ::rocksdb::PinnableSlice;
 using ::rocksdb::ReadOptions;
 using ::rocksdb::Slice;
 using ::rocksdb::Comparator;
+using ::rocksdb::CompressionType;
 using ::rocksdb::ColumnFamilyDescriptor;
 using ::rocksdb::ColumnFamilyOptions;
 using ::rocksdb::ColumnFamilyHandle;
@@ -95,6 +149,9 @@ public:
    uint32_t       newestEntryId = 0;
    /// Timestamp of oldest operation, just to quickly decide if start detail prune checking at all.
    time_point_sec oldestEntryTimestamp;
+   /// Operation type masks of entries in the newest (not yet completed) summary chunk.
+   uint64_t       newestChunkTypesLow = 0;
+   uint64_t       newestChunkTypesHigh = 0;
 
    uint32_t getAssociatedOpCount() const
    {
@@ -253,6 +310,88 @@ typedef PrimitiveTypeSlice< uint32_t > by_block_slice_t;
 typedef PrimitiveTypeSlice< account_name_type::Storage > ah_info_by_name_slice_t;
 typedef PrimitiveTypeSlice< ah_op_id_pair > ah_op_by_id_slice_t;
 
+/// Location of a transaction: block number paired with transaction position in the block.
+typedef std::pair< uint32_t, uint32_t > block_trx_pair;
+typedef PrimitiveTypeSlice< block_trx_pair > trx_location_slice_t;
+
+/// Operation type masks (types 0-63, types 64-127) summarizing a chunk of account history entries.
+typedef std::pair< uint64_t, uint64_t > op_type_mask_pair;
+typedef PrimitiveTypeSlice< op_type_mask_pair > op_type_mask_slice_t;
+
+/** Value stored in ah_operation_by_id and operation_by_block columns: operation id followed by operation type
+ *  tag (`operation::which()`) and operation timestamp. Allows to filter operations by type and to find pruning
+ *  boundaries without loading operation objects.
+ */
+class ah_op_entry_slice_t final : public Slice
+{
+public:
+   ah_op_entry_slice_t(int64_t opId, uint8_t opType, const time_point_sec& timestamp)
+   {
+      const uint32_t seconds = timestamp.sec_since_epoch();
+      memcpy(_buffer, &opId, sizeof(opId));
+      _buffer[sizeof(opId)] = static_cast<char>(opType);
+      memcpy(_buffer + TIMESTAMP_OFFSET, &seconds, sizeof(seconds));
+      data_ = _buffer;
+      size_ = sizeof(_buffer);
+   }
+
+   ah_op_entry_slice_t(const ah_op_entry_slice_t&) = delete;
+   ah_op_entry_slice_t& operator=(const ah_op_entry_slice_t&) = delete;
+
+   static int64_t unpackId(const Slice& s)
+   {
+      assert(s.size() == ENTRY_SIZE);
+      int64_t opId = 0;
+      memcpy(&opId, s.data(), sizeof(opId));
+      return opId;
+   }
+
+   static uint8_t unpackType(const Slice& s)
+   {
+      assert(s.size() == ENTRY_SIZE);
+      return static_cast<uint8_t>(s.data()[sizeof(int64_t)]);
+   }
+
+   static time_point_sec unpackTimestamp(const Slice& s)
+   {
+      assert(s.size() == ENTRY_SIZE);
+      uint32_t seconds = 0;
+      memcpy(&seconds, s.data() + TIMESTAMP_OFFSET, sizeof(seconds));
+      return time_point_sec(seconds);
+   }
+
+private:
+   static constexpr size_t TIMESTAMP_OFFSET = sizeof(int64_t) + sizeof(uint8_t);
+   static constexpr size_t ENTRY_SIZE = TIMESTAMP_OFFSET + sizeof(uint32_t);
+
+   char _buffer[ENTRY_SIZE];
+};
+
+/// Returns operation type (`operation::which()`) read from the tag of serialized operation.
+uint32_t getOperationType(const serialize_buffer_t& serializedOp)
+{
+   fc::datastream<const char*> ds(serializedOp.data(), serializedOp.size());
+   fc::unsigned_int which;
+   fc::raw::unpack(ds, which);
+   return which.value;
+}
+
+/// Returns true if any of operation types set in `mask` is selected by `filter`.
+inline bool matchesTypeFilter(const op_type_mask_pair& mask, const op_type_mask_pair& filter)
+{
+   return (mask.first & filter.first) || (mask.second & filter.second);
+}
+
+/// Returns mask having set only the bit of given operation type.
+inline op_type_mask_pair getTypeMask(uint32_t opType)
+{
+   if(opType < 64)
+      return op_type_mask_pair(uint64_t(1) << opType, 0);
+   if(opType < 128)
+      return op_type_mask_pair(0, uint64_t(1) << (opType - 64));
+   return op_type_mask_pair(0, 0);
+}
+
 const Comparator* by_id_Comparator()
 {
    static by_id_ComparatorImpl c;
@@ -279,6 +418,45 @@ const Comparator* ah_op_by_id_Comparator()
 
 #define checkStatus(s) FC_ASSERT((s).ok(), "Data access failed: ${m}", ("m", (s).ToString()))
 
+CompressionType parseCompressionType(const std::string& name)
+{
+   static const std::map<std::string, CompressionType> types =
+   {
+      { "none",   ::rocksdb::kNoCompression },
+      { "snappy", ::rocksdb::kSnappyCompression },
+      { "zlib",   ::rocksdb::kZlibCompression },
+      { "lz4",    ::rocksdb::kLZ4Compression },
+      { "lz4hc",  ::rocksdb::kLZ4HCCompression },
+      { "zstd",   ::rocksdb::kZSTD }
+   };
+
+   auto found = types.find(name);
+   FC_ASSERT(found != types.end(), "Unknown compression type: `${n}'", ("n", name));
+   return found->second;
+}
+
+/** Storage tuning applied to column families, collected from plugin options.
+ *  Hot levels use `compression`, the bottommost level (holding most of the data) uses `bottommostCompression`
+ *  and, for columns holding operation payloads, ZSTD dictionary trained by RocksDB on compacted data.
+ *  When `coldPath` is set, large columns are tiered: newest levels (up to `hotSize` bytes) stay in the storage
+ *  directory, while compaction moves older levels (compressed with `bottommostCompression`) to `coldPath`.
+ */
+struct column_tuning
+{
+   CompressionType                    compression = ::rocksdb::kLZ4Compression;
+   CompressionType                    bottommostCompression = ::rocksdb::kZSTD;
+   uint32_t                           dictionarySize = DEFAULT_DICTIONARY_SIZE;
+   uint32_t                           blockSize = DEFAULT_BLOCK_SIZE;
+   uint32_t                           bloomBits = DEFAULT_BLOOM_BITS;
+   bool                               partitionedIndex = true;
+   /// Block cache shared by all columns, so index and filter blocks of all of them fit into one budget.
+   std::shared_ptr<::rocksdb::Cache>  blockCache;
+   bfs::path                          coldPath;
+   uint64_t                           hotSize = uint64_t(DEFAULT_HOT_STORAGE_SIZE) << 20;
+   /// Per-column RocksDB option strings (see GetColumnFamilyOptionsFromString), applied last.
+   std::map<std::string, std::string> overrides;
+};
+
 class operation_name_provider
 {
 public:
@@ -354,6 +532,190 @@ private:
    std::map<account_name_type, account_history_info> _ahInfoCache;
 };
 
+/** Pins a storage snapshot for the duration of a multi-step lookup, so all its reads see the same
+ *  committed state, even if the writer thread commits another block meanwhile.
+ */
+class ReadSnapshot final
+{
+public:
+   explicit ReadSnapshot(DB* storage) : _storage(storage), _snapshot(storage->GetSnapshot()) {}
+
+   ~ReadSnapshot()
+   {
+      _storage->ReleaseSnapshot(_snapshot);
+   }
+
+   ReadSnapshot(const ReadSnapshot&) = delete;
+   ReadSnapshot& operator=(const ReadSnapshot&) = delete;
+
+   ReadOptions options() const
+   {
+      ReadOptions rOptions;
+      rOptions.snapshot = _snapshot;
+      return rOptions;
+   }
+
+private:
+   DB*                         _storage;
+   const ::rocksdb::Snapshot*  _snapshot;
+};
+
+/** Position of a paged account history read, iterating from newer to older entries of single account.
+ *  Holds a storage snapshot, so subsequent pages are consistent with the first one and continue from
+ *  stored iterator position instead of seeking again.
+ */
+class AHCursor final
+{
+public:
+   AHCursor(DB* storage, ColumnFamilyHandle* column, const account_name_type& name,
+      const account_history_info& ahInfo, const op_type_mask_pair& filter) :
+      _snapshot(storage),
+      _name(name),
+      _ahInfo(ahInfo),
+      _filter(filter),
+      _lowerBound(std::make_pair(ahInfo.id, ahInfo.oldestEntryId)),
+      _upperBound(std::make_pair(ahInfo.id, ahInfo.newestEntryId + 1))
+   {
+      ReadOptions rOptions = readOptions();
+      rOptions.iterate_lower_bound = &_lowerBound;
+      rOptions.iterate_upper_bound = &_upperBound;
+      _it.reset(storage->NewIterator(rOptions, column));
+   }
+
+   AHCursor(const AHCursor&) = delete;
+   AHCursor& operator=(const AHCursor&) = delete;
+
+   ReadOptions readOptions() const
+   {
+      return _snapshot.options();
+   }
+
+   ::rocksdb::Iterator& iterator()
+   {
+      return *_it;
+   }
+
+   const account_name_type& name() const
+   {
+      return _name;
+   }
+
+   const account_history_info& info() const
+   {
+      return _ahInfo;
+   }
+
+   const op_type_mask_pair& filter() const
+   {
+      return _filter;
+   }
+
+   /// Type summary chunk already checked against the filter.
+   uint32_t               checkedChunk = std::numeric_limits<uint32_t>::max();
+   fc::time_point         expiration;
+
+private:
+   ReadSnapshot                         _snapshot;
+   account_name_type                    _name;
+   account_history_info                 _ahInfo;
+   op_type_mask_pair                    _filter;
+   ah_op_by_id_slice_t                  _lowerBound;
+   ah_op_by_id_slice_t                  _upperBound;
+   /// Declared last, to be destroyed before bounds and the snapshot it uses.
+   std::unique_ptr<::rocksdb::Iterator> _it;
+};
+
+/** Operation extracted from block log during data import, together with the accounts it impacts.
+ *  `ahEntries` holds (account_history_info::id, entry id) pairs assigned by the sequencing pass.
+ */
+struct import_operation
+{
+   rocksdb_operation_object       obj;
+   std::vector<account_name_type> impacted;
+   std::vector<ah_op_id_pair>     ahEntries;
+   uint32_t                       opType = 0;
+   /// Set for first imported operation of given transaction, to store its location only once.
+   bool                           firstInTx = false;
+};
+
+/** Fixed set of threads used to run data import stages in parallel.
+ *  The calling thread also takes part in the work, so `threadCount` == 1 means serial processing.
+ */
+class import_worker_pool final
+{
+public:
+   explicit import_worker_pool(unsigned int threadCount) :
+      _threadCount(std::max(threadCount, 1u)), _work(_ios)
+   {
+      for(unsigned int i = 1; i < _threadCount; ++i)
+         _threads.create_thread([this]() { _ios.run(); });
+   }
+
+   ~import_worker_pool()
+   {
+      _ios.stop();
+      _threads.join_all();
+   }
+
+   unsigned int size() const
+   {
+      return _threadCount;
+   }
+
+   /** Splits [0, count) into contiguous slices (one per thread) and calls `processor(begin, end)` for each of them.
+    *  Blocks until all slices are processed. The first exception thrown by any slice is rethrown.
+    */
+   void run(size_t count, const std::function<void(size_t, size_t)>& processor)
+   {
+      const size_t sliceSize = (count + _threadCount - 1) / _threadCount;
+      std::vector<std::future<void>> pending;
+
+      size_t begin = 0;
+      for(; begin + sliceSize < count; begin += sliceSize)
+      {
+         auto task = std::make_shared<std::packaged_task<void()>>(
+            [&processor, begin, sliceSize]() { processor(begin, begin + sliceSize); });
+         pending.emplace_back(task->get_future());
+         _ios.post([task]() { (*task)(); });
+      }
+
+      std::exception_ptr error;
+
+      try
+      {
+         if(begin < count)
+            processor(begin, count);
+      }
+      catch(...)
+      {
+         error = std::current_exception();
+      }
+
+      /// Slices still refer to `processor`, so all of them must be finished before leaving.
+      for(auto& f : pending)
+      {
+         try
+         {
+            f.get();
+         }
+         catch(...)
+         {
+            if(!error)
+               error = std::current_exception();
+         }
+      }
+
+      if(error)
+         std::rethrow_exception(error);
+   }
+
+private:
+   unsigned int                   _threadCount;
+   boost::asio::io_service        _ios;
+   boost::asio::io_service::work  _work;
+   boost::thread_group            _threads;
+};
+
 
 } /// anonymous
 
@@ -417,13 +779,17 @@ public:
          // opening the db, so that is not a good place to write the initial lib.
          try
          {
-            get_lib();
+            _queuedLib = get_lib();
          }
          catch( fc::assert_exception& )
          {
+            _queuedLib = 0;
             update_lib( 0 );
          }
 
+         startWriter();
+         startPruner();
+
          _on_post_apply_operation_con = _mainDb.add_post_apply_operation_handler(
             [&]( const operation_notification& note )
             {
@@ -448,26 +814,57 @@ public:
    }
 
    void printReport(uint32_t blockNo, const char* detailText) const;
+   /** Samples newest data of each column family and reports storage size achieved with candidate
+    *  compression and dictionary settings, to help choosing plugin compression options.
+    */
+   void reportCompression(uint32_t sampleMegabytes);
    void on_pre_reindex( const blurt::chain::reindex_notification& note );
    void on_post_reindex( const blurt::chain::reindex_notification& note );
 
    /// Allows to start immediate data import (outside replay process).
    void importData(unsigned int blockLimit);
 
-   void find_account_history_data(const account_name_type& name, uint64_t start, uint32_t limit,
+   bool find_account_history_data(const account_name_type& name, uint64_t start, uint32_t limit,
+      const op_type_mask_pair& filter, std::function<void(unsigned int, const rocksdb_operation_object&)> processor,
+      uint64_t* nextStart) const;
+   /** Reads a page of account history using a cursor kept between calls.
+    *  Passing `cursorId` == 0 opens new cursor positioned at `start`, otherwise given cursor is continued.
+    *  Returns id of the cursor to continue with, or 0 if there are no more entries.
+    */
+   uint64_t find_account_history_page(const account_name_type& name, uint64_t start, uint32_t limit,
+      const op_type_mask_pair& filter, uint64_t cursorId,
       std::function<void(unsigned int, const rocksdb_operation_object&)> processor) const;
-   bool find_operation_object(size_t opId, rocksdb_operation_object* op) const;
+   bool find_operation_object(size_t opId, rocksdb_operation_object* op) const
+   {
+      return find_operation_object(opId, op, ReadOptions());
+   }
+   bool find_operation_object(size_t opId, rocksdb_operation_object* op, const ReadOptions& rOptions) const;
+   /// Allows to find block number and position in block of given transaction.
+   bool find_transaction_info(const transaction_id_type& trxId, uint32_t* blockNo, uint32_t* txInBlock) const;
    /// Allows to look for all operations present in given block and call `processor` for them.
    void find_operations_by_block(size_t blockNum,
       std::function<void(const rocksdb_operation_object&)> processor) const;
    /// Allows to enumerate all operations registered in given block range.
    uint32_t enumVirtualOperationsFromBlockRange(uint32_t blockRangeBegin,
       uint32_t blockRangeEnd, std::function<void(const rocksdb_operation_object&)> processor) const;
+   /// Allows to export operations registered in given block range in bounded chunks.
+   block_op_id_pair findOperationsByBlockRange(uint32_t blockRangeBegin, uint32_t blockRangeEnd,
+      uint64_t operationBegin, bool onlyVirtual, const op_type_mask_pair& filter, uint32_t limit,
+      std::function<void(const rocksdb_operation_object&)> processor) const;
 
    void shutdownDb()
    {
       chain::util::disconnect_signal(_on_post_apply_operation_con);
       chain::util::disconnect_signal(_on_irreversible_block_conn);
+      stopPruner();
+      stopWriter();
+
+      {
+         /// Cursors hold snapshots and iterators, which must be released before the storage is closed.
+         std::lock_guard<std::mutex> lock(_cursorMutex);
+         _cursors.clear();
+      }
+
       flushStorage();
       cleanupColumnHandles();
       _storage.reset();
@@ -479,6 +876,13 @@ private:
 
    typedef std::vector<ColumnFamilyDescriptor> ColumnDefinitions;
    ColumnDefinitions prepareColumnDefinitions(bool addDefaultColumn);
+   /** Builds options of given column using `_columnTuning`.
+    *  \param pointLookups  - column is queried by exact key, so bloom filters are worth to be built,
+    *  \param useDictionary - column holds serialized operations, which compress better with a dictionary,
+    *  \param tiered        - column is large enough to have its older levels moved to cold storage.
+    */
+   ColumnFamilyOptions makeColumnOptions(const std::string& name, const Comparator* comparator,
+      bool pointLookups, bool useDictionary, bool tiered) const;
 
    /// Returns true if database will need data import.
    bool createDbSchema(const bfs::path& path);
@@ -497,20 +901,27 @@ private:
       {
          ++_txNo;
          _lastTx = obj.trx_id;
+         storeTransactionLocation(_writeBuffer, obj);
       }
 
       obj.id = _operationSeqId++;
 
-      serialize_buffer_t serializedObj;
-      auto size = fc::raw::pack_size(obj);
-      serializedObj.resize(size);
-      {
-         fc::datastream<char*> ds(serializedObj.data(), size);
-         fc::raw::pack(ds, obj);
-      }
+      storeOperation(_writeBuffer, obj);
+
+      for(const auto& name : impacted)
+         buildAccountHistoryRecord( name, obj );
+
+      ++_collectedOps;
+      ++_totalOps;
+}
+
+   /// Puts given operation into OPERATION_BY_ID and OPERATION_BY_BLOCK columns. `obj.id` must be already assigned.
+   void storeOperation(WriteBatch& batch, const rocksdb_operation_object& obj) const
+   {
+      auto serializedObj = dump(obj);
 
       id_slice_t idSlice(obj.id);
-      auto s = _writeBuffer.Put(_columnHandles[OPERATION_BY_ID], idSlice, Slice(serializedObj.data(), serializedObj.size()));
+      auto s = batch.Put(_columnHandles[OPERATION_BY_ID], idSlice, Slice(serializedObj.data(), serializedObj.size()));
       checkStatus(s);
 
       // uint64_t location = ( (uint64_t) obj.trx_in_block << 32 ) | ( (uint64_t) obj.op_in_trx << 16 ) | ( obj.virtual_op );
@@ -522,21 +933,88 @@ private:
       }
 
       op_by_block_num_slice_t blockLocSlice( block_op_id_pair( obj.block, encoded_id ) );
-      s = _writeBuffer.Put(_columnHandles[OPERATION_BY_BLOCK], blockLocSlice, idSlice);
+      ah_op_entry_slice_t opEntrySlice(obj.id, getOperationType(obj.serialized_op), obj.timestamp);
+      s = batch.Put(_columnHandles[OPERATION_BY_BLOCK], blockLocSlice, opEntrySlice);
       checkStatus(s);
+   }
 
-      for(const auto& name : impacted)
-         buildAccountHistoryRecord( name, obj );
+   /// Puts location of the transaction containing given operation into TRANSACTION_BY_ID column.
+   void storeTransactionLocation(WriteBatch& batch, const rocksdb_operation_object& obj) const
+   {
+      /// Virtual operations produced outside of any transaction have no id to be indexed.
+      if(obj.trx_id == transaction_id_type())
+         return;
 
-      if(++_collectedOps >= _collectedOpsWriteLimit)
-         flushWriteBuffer();
+      Slice idSlice(obj.trx_id.data(), obj.trx_id.data_size());
+      trx_location_slice_t locationSlice(block_trx_pair(obj.block, obj.trx_in_block));
+      auto s = batch.Put(_columnHandles[TRANSACTION_BY_ID], idSlice, locationSlice);
+      checkStatus(s);
+   }
 
-      ++_totalOps;
-}
+   /** Data import stages, run for each chunk of blocks read from block log:
+    *    - operations are extracted (and serialized) from blocks in parallel,
+    *    - operation and account history entry IDs are assigned serially in block order, so results
+    *      are identical regardless of used thread count,
+    *    - prepared records are written in parallel, each worker using its own WriteBatch.
+    */
+   void importBlocks(const std::vector<signed_block>& blocks, import_worker_pool& workers);
+   void extractOperations(const signed_block& block, std::vector<import_operation>* ops) const;
 
    void buildAccountHistoryRecord( const account_name_type& name, const rocksdb_operation_object& obj );
-   void prunePotentiallyTooOldItems(account_history_info* ahInfo, const account_name_type& name,
-      const fc::time_point_sec& now);
+   /** Registers type of operation pointed by account history entry in the summary of its chunk.
+    *  Summary of completed chunk is moved from account_history_info to AH_OP_TYPE_SUMMARY_BY_ID column.
+    */
+   void updateTypeSummary(account_history_info* ahInfo, uint32_t entryId, uint32_t opType);
+   /// Loads account history info of given account. Returns false if the account has no history.
+   bool loadAHInfo(const account_name_type& name, const ReadOptions& rOptions, account_history_info* ahInfo) const;
+   /** Reports up to `limit` entries (matching cursor filter) going back from current cursor position.
+    *  Entries in summary chunks not matching the filter are skipped without being read.
+    *  Nonzero `scanBudget` limits number of examined entries (and skipped chunks).
+    *  Returns true if there can be more entries to read.
+    */
+   bool readAccountHistoryPage(AHCursor& cursor, uint32_t limit,
+      const std::function<void(unsigned int, const rocksdb_operation_object&)>& processor,
+      uint64_t scanBudget = 0) const;
+
+   /// Returns type summary of given chunk. If it is unknown, all types are reported.
+   op_type_mask_pair getTypeSummary(const account_history_info& ahInfo, uint32_t chunkNo,
+      const ReadOptions& rOptions) const;
+
+   /// Operations of irreversible block(s), waiting for the writer thread.
+   struct pending_block
+   {
+      uint32_t                                                                           blockNum = 0;
+      std::vector< std::pair< rocksdb_operation_object, std::vector< account_name_type > > > ops;
+   };
+
+   /** Writes of irreversible blocks are done by dedicated thread, to keep RocksDB latency out of block
+    *  application. Blocks are written in order they were queued, each one (including its LIB update)
+    *  in a single write.
+    */
+   void startWriter();
+   void stopWriter();
+   void enqueueBlock(pending_block&& block);
+   void writerMain();
+
+   /** Account history entries older than `_pruneAge` (except ACCOUNT_HISTORY_LENGTH_LIMIT newest ones of each
+    *  account) are removed by dedicated thread, walking incrementally over all accounts. Since entries of single
+    *  account are kept in order of their timestamps, entries to be removed always form a contiguous key range,
+    *  deleted by single DeleteRange.
+    */
+   void startPruner();
+   void stopPruner();
+   void prunerMain();
+   /** Prunes up to PRUNE_BATCH_SIZE accounts, starting at `resumeName` (or the first account if it is not set).
+    *  Returns false if all accounts have been processed, otherwise sets `resumeName` to the account to continue at.
+    */
+   bool pruneAccountHistoryBatch(fc::optional<account_name_type>* resumeName, const fc::time_point_sec& cutoff);
+   /** Finds the oldest entry of given account, which must be kept. Entries preceding it are older than `cutoff`.
+    *  Returns false if there is nothing to prune.
+    */
+   bool findPruneBoundary(const account_history_info& ahInfo, const fc::time_point_sec& cutoff,
+      uint32_t* keepFrom, fc::time_point_sec* keepFromTimestamp) const;
+   /// Returns timestamp of the operation pointed by given account history entry, as stored in the entry itself.
+   fc::time_point_sec getEntryTimestamp(const account_history_info& ahInfo, uint32_t entryId) const;
 
    void saveStoreVersion()
    {
@@ -675,13 +1153,15 @@ private:
 
    /// Helper member to be able to detect another incomming tx and increment tx-counter.
    transaction_id_type              _lastTx;
-   size_t                           _txNo = 0;
+   /// Atomic, since it is updated by writer thread and reported by block application.
+   std::atomic<size_t>              _txNo{0};
    /// Total processed ops in this session (counts every operation, even excluded by filtering).
-   size_t                           _totalOps = 0;
+   std::atomic<size_t>              _totalOps{0};
    /// Total number of ops being skipped by filtering options.
    size_t                           _excludedOps = 0;
    /// Total number of accounts (impacted by ops) excluded from processing because of filtering.
-   mutable size_t                   _excludedAccountCount = 0;
+   /// Atomic, since it is updated by import workers too.
+   mutable std::atomic<size_t>      _excludedAccountCount{0};
    /// IDs to be assigned to object.id field.
    uint64_t                         _operationSeqId = 0;
    uint64_t                         _accountHistorySeqId = 0;
@@ -689,19 +1169,57 @@ private:
    /// Number of data-chunks for ops being stored inside _writeBuffer. To decide when to flush.
    unsigned int                     _collectedOps = 0;
    /** Limit which value depends on block data source:
-    *    - if blocks come from network, there is no need for delaying write, becasue they appear quite rare (limit == 1)
-    *    - if reindex process or direct import has been spawned, this massive operation can need reduction of direct
+    *    - if blocks come from network, the writer thread flushes once per irreversible block and this limit is not used,
+    *    - if reindex process has been spawned, this massive operation can need reduction of direct
            writes (limit == WRITE_BUFFER_FLUSH_LIMIT).
     */
    unsigned int                     _collectedOpsWriteLimit = 1;
 
+   /// Last irreversible block handed off to the writer thread.
+   uint32_t                         _queuedLib = 0;
+
+   std::deque<pending_block>        _writeQueue;
+   size_t                           _writeQueueLimit = WRITE_QUEUE_SIZE_LIMIT;
+   std::mutex                       _writeQueueMutex;
+   std::condition_variable          _writeQueueNotEmpty;
+   std::condition_variable          _writeQueueNotFull;
+   bool                             _stopWriter = false;
+   /// Set if writer thread failed. Rethrown to block application at next hand-off.
+   std::exception_ptr               _writerError;
+   std::thread                      _writerThread;
+
+   /** Serializes account_history_info updates done by the pruner with these done by block writes.
+    *  Held by writes for a whole block (or import chunk), so the pruner never sees not yet flushed infos.
+    */
+   std::mutex                       _ahInfoMutex;
+
+   bool                             _prune = false;
+   fc::microseconds                 _pruneAge = fc::days(ACCOUNT_HISTORY_TIME_LIMIT);
+   fc::microseconds                 _pruneInterval = fc::seconds(PRUNE_INTERVAL);
+   bool                             _stopPruner = false;
+   std::mutex                       _prunerMutex;
+   std::condition_variable          _prunerWakeUp;
+   std::thread                      _prunerThread;
+
+   /// Open account history cursors. A cursor being used is taken out of the map, so it is never shared.
+   mutable std::map<uint64_t, std::unique_ptr<AHCursor>> _cursors;
+   mutable std::mutex               _cursorMutex;
+   /// Cursor ids are drawn at random, so a client cannot guess ids of cursors opened by others.
+   mutable std::mt19937_64          _cursorIdGenerator{std::random_device()()};
+   fc::microseconds                 _cursorTTL = fc::seconds(CURSOR_TTL);
+   size_t                           _maxCursors = MAX_CURSORS;
+
+   /// Number of threads used by immediate data import.
+   unsigned int                     _importThreads = 1;
+
+   column_tuning                    _columnTuning;
+
    account_name_range_index         _tracked_accounts;
    flat_set<std::string>            _op_list;
    flat_set<std::string>            _blacklisted_op_list;
 
-   bool                             _reindexing = false;
-
-   bool                             _prune = false;
+   /// Atomic, since the pruner thread skips its work during reindex.
+   std::atomic<bool>                _reindexing{false};
 };
 
 void account_history_rocksdb_plugin::impl::collectOptions(const boost::program_options::variables_map& options)
@@ -741,6 +1259,81 @@ void account_history_rocksdb_plugin::impl::collectOptions(const boost::program_o
    if(_blacklisted_op_list.empty() == false)
       ilog( "Account History: blacklisting ops ${o}", ("o", _blacklisted_op_list) );
 
+   if(options.count("account-history-rocksdb-import-threads"))
+      _importThreads = options.at("account-history-rocksdb-import-threads").as<uint32_t>();
+
+   if(_importThreads == 0)
+      _importThreads = std::max(boost::thread::hardware_concurrency(), 1u);
+
+   if(options.count("account-history-rocksdb-compression"))
+      _columnTuning.compression = parseCompressionType(options.at("account-history-rocksdb-compression").as<std::string>());
+   if(options.count("account-history-rocksdb-bottommost-compression"))
+      _columnTuning.bottommostCompression = parseCompressionType(
+         options.at("account-history-rocksdb-bottommost-compression").as<std::string>());
+   if(options.count("account-history-rocksdb-dictionary-size"))
+      _columnTuning.dictionarySize = options.at("account-history-rocksdb-dictionary-size").as<uint32_t>();
+   if(options.count("account-history-rocksdb-block-size"))
+      _columnTuning.blockSize = options.at("account-history-rocksdb-block-size").as<uint32_t>();
+   if(options.count("account-history-rocksdb-bloom-bits"))
+      _columnTuning.bloomBits = options.at("account-history-rocksdb-bloom-bits").as<uint32_t>();
+   if(options.count("account-history-rocksdb-partitioned-index"))
+      _columnTuning.partitionedIndex = options.at("account-history-rocksdb-partitioned-index").as<bool>();
+
+   uint64_t blockCacheSize = DEFAULT_BLOCK_CACHE_SIZE;
+   if(options.count("account-history-rocksdb-block-cache-size"))
+      blockCacheSize = options.at("account-history-rocksdb-block-cache-size").as<uint64_t>();
+   _columnTuning.blockCache = ::rocksdb::NewLRUCache(std::max<uint64_t>(blockCacheSize, 1) << 20);
+
+   if(options.count("account-history-rocksdb-cold-storage-path"))
+   {
+      bfs::path coldPath = options.at("account-history-rocksdb-cold-storage-path").as<bfs::path>();
+      if(coldPath.empty() == false && coldPath.is_absolute() == false)
+         coldPath = appbase::app().data_dir() / coldPath;
+
+      _columnTuning.coldPath = coldPath;
+   }
+   if(options.count("account-history-rocksdb-hot-storage-size"))
+      _columnTuning.hotSize = options.at("account-history-rocksdb-hot-storage-size").as<uint64_t>() << 20;
+
+   if(_columnTuning.coldPath.empty() == false)
+   {
+      bfs::create_directories(_columnTuning.coldPath);
+      ilog("Account History: operation storage is tiered, levels exceeding ${s} MB per column are moved to `${p}'",
+         ("s", _columnTuning.hotSize >> 20)("p", _columnTuning.coldPath.string()));
+   }
+
+   if(options.count("account-history-rocksdb-column-options"))
+   {
+      for(const auto& arg : options.at("account-history-rocksdb-column-options").as<std::vector<std::string>>())
+      {
+         auto separator = arg.find(':');
+         FC_ASSERT(separator != std::string::npos && separator > 0,
+            "Column options must be given as `column_name:rocksdb_options', got: `${a}'", ("a", arg));
+         _columnTuning.overrides[arg.substr(0, separator)] = arg.substr(separator + 1);
+      }
+   }
+
+   if(options.count("account-history-rocksdb-cursor-ttl"))
+      _cursorTTL = fc::seconds(options.at("account-history-rocksdb-cursor-ttl").as<uint32_t>());
+   if(options.count("account-history-rocksdb-max-cursors"))
+      _maxCursors = std::max(options.at("account-history-rocksdb-max-cursors").as<uint32_t>(), 1u);
+
+   if(options.count("account-history-rocksdb-write-queue-size"))
+      _writeQueueLimit = std::max(options.at("account-history-rocksdb-write-queue-size").as<uint32_t>(), 1u);
+
+   if(options.count("account-history-rocksdb-prune"))
+      _prune = options.at("account-history-rocksdb-prune").as<bool>();
+   if(options.count("account-history-rocksdb-prune-age"))
+      _pruneAge = fc::days(options.at("account-history-rocksdb-prune-age").as<uint32_t>());
+   if(options.count("account-history-rocksdb-prune-interval"))
+      _pruneInterval = fc::seconds(std::max(options.at("account-history-rocksdb-prune-interval").as<uint32_t>(), 1u));
+
+   if(_prune)
+   {
+      ilog("Account History: entries older than ${d} days (except ${l} newest ones of each account) are pruned in background",
+         ("d", _pruneAge.to_seconds() / fc::days(1).to_seconds())("l", ACCOUNT_HISTORY_LENGTH_LIMIT));
+   }
+
    appbase::app().get_plugin< chain::chain_plugin >().report_state_options( _self.name(), state_opts );
 }
 
@@ -847,22 +1440,123 @@ void account_history_rocksdb_plugin::impl::storeOpFilteringParameters(const std:
       }
    }
 
-void account_history_rocksdb_plugin::impl::find_account_history_data(const account_name_type& name, uint64_t start,
-   uint32_t limit, std::function<void(unsigned int, const rocksdb_operation_object&)> processor) const
+bool account_history_rocksdb_plugin::impl::loadAHInfo(const account_name_type& name, const ReadOptions& rOptions,
+   account_history_info* ahInfo) const
 {
-   ReadOptions rOptions;
-
    ah_info_by_name_slice_t nameSlice(name.data);
    PinnableSlice buffer;
    auto s = _storage->Get(rOptions, _columnHandles[AH_INFO_BY_NAME], nameSlice, &buffer);
 
    if(s.IsNotFound())
-      return;
+      return false;
 
    checkStatus(s);
 
+   load(*ahInfo, buffer.data(), buffer.size());
+   return true;
+}
+
+bool account_history_rocksdb_plugin::impl::readAccountHistoryPage(AHCursor& cursor, uint32_t limit,
+   const std::function<void(unsigned int, const rocksdb_operation_object&)>& processor, uint64_t scanBudget) const
+{
+   auto& it = cursor.iterator();
+   const auto& ahInfo = cursor.info();
+   const auto& filter = cursor.filter();
+   const bool filtered = filter.first != 0 || filter.second != 0;
+   const ReadOptions rOptions = cursor.readOptions();
+
+   uint32_t matched = 0;
+   uint64_t scanned = 0;
+
+   while(it.Valid() && matched < limit && (scanBudget == 0 || scanned < scanBudget))
+   {
+      auto keyValue = ah_op_by_id_slice_t::unpackSlice(it.key());
+      if(keyValue.first != ahInfo.id)
+         return false;
+
+      ++scanned;
+
+      if(filtered)
+      {
+         const uint32_t chunkNo = keyValue.second / AH_OP_TYPE_SUMMARY_CHUNK;
+         if(chunkNo != cursor.checkedChunk)
+         {
+            cursor.checkedChunk = chunkNo;
+
+            if(matchesTypeFilter(getTypeSummary(ahInfo, chunkNo, rOptions), filter) == false)
+            {
+               if(chunkNo == 0)
+                  return false;
+
+               ah_op_by_id_slice_t prevChunkEnd(std::make_pair(ahInfo.id, chunkNo * AH_OP_TYPE_SUMMARY_CHUNK - 1));
+               it.SeekForPrev(prevChunkEnd);
+               continue;
+            }
+         }
+      }
+
+      auto valueSlice = it.value();
+      if(filtered == false || matchesTypeFilter(getTypeMask(ah_op_entry_slice_t::unpackType(valueSlice)), filter))
+      {
+         rocksdb_operation_object oObj;
+         bool found = find_operation_object(ah_op_entry_slice_t::unpackId(valueSlice), &oObj, rOptions);
+         FC_ASSERT(found, "Missing operation?");
+
+         processor(keyValue.second, oObj);
+         ++matched;
+      }
+
+      if(keyValue.second == 0)
+         return false;
+
+      it.Prev();
+   }
+
+   checkStatus(it.status());
+
+   return it.Valid();
+}
+
+bool account_history_rocksdb_plugin::impl::find_account_history_data(const account_name_type& name, uint64_t start,
+   uint32_t limit, const op_type_mask_pair& filter,
+   std::function<void(unsigned int, const rocksdb_operation_object&)> processor, uint64_t* nextStart) const
+{
+   if(filter.first != 0 || filter.second != 0)
+   {
+      /// Collect up to `limit` matching operations, skipping whole chunks which summary does not match the filter.
+      account_history_info ahInfo;
+      if(loadAHInfo(name, ReadOptions(), &ahInfo) == false)
+         return false;
+
+      AHCursor cursor(_storage.get(), _columnHandles[AH_OPERATION_BY_ID], name, ahInfo, filter);
+      cursor.iterator().SeekForPrev(ah_op_by_id_slice_t(std::make_pair(ahInfo.id, start)));
+
+      uint32_t matched = 0;
+      auto counter = [&matched, &processor](unsigned int sequence, const rocksdb_operation_object& op)
+      {
+         processor(sequence, op);
+         ++matched;
+      };
+
+      const uint64_t scanBudget = std::max<uint64_t>(uint64_t(limit) * FILTERED_SCAN_FACTOR, FILTERED_SCAN_MIN);
+      if(readAccountHistoryPage(cursor, limit, counter, scanBudget) == false || matched >= limit)
+         return false;
+
+      /// Scan budget ran out at the current entry, unless iterator has already left the account entries.
+      auto keyValue = ah_op_by_id_slice_t::unpackSlice(cursor.iterator().key());
+      if(keyValue.first != ahInfo.id)
+         return false;
+
+      *nextStart = keyValue.second;
+      return true;
+   }
+
+   ReadSnapshot snapshot(_storage.get());
+   ReadOptions rOptions = snapshot.options();
+
    account_history_info ahInfo;
-   load(ahInfo, buffer.data(), buffer.size());
+   if(loadAHInfo(name, rOptions, &ahInfo) == false)
+      return false;
 
    ah_op_by_id_slice_t lowerBoundSlice(std::make_pair(ahInfo.id, ahInfo.oldestEntryId));
    ah_op_by_id_slice_t upperBoundSlice(std::make_pair(ahInfo.id, ahInfo.newestEntryId+1));
@@ -878,7 +1572,7 @@ void account_history_rocksdb_plugin::impl::find_account_history_data(const accou
    it->SeekForPrev(key);
 
    if(it->Valid() == false)
-      return;
+      return false;
 
    auto keySlice = it->key();
    auto keyValue = ah_op_by_id_slice_t::unpackSlice(keySlice);
@@ -894,9 +1588,9 @@ void account_history_rocksdb_plugin::impl::find_account_history_data(const accou
       keyValue = ah_op_by_id_slice_t::unpackSlice(keySlice);
 
       auto valueSlice = it->value();
-      const auto& opId = id_slice_t::unpackSlice(valueSlice);
+      const auto opId = ah_op_entry_slice_t::unpackId(valueSlice);
       rocksdb_operation_object oObj;
-      bool found = find_operation_object(opId, &oObj);
+      bool found = find_operation_object(opId, &oObj, rOptions);
       FC_ASSERT(found, "Missing operation?");
 
       processor(keyValue.second, oObj);
@@ -904,39 +1598,129 @@ void account_history_rocksdb_plugin::impl::find_account_history_data(const accou
       if(keyValue.second <= lowerBound)
         break;
    }
+
+   return false;
 }
 
-bool account_history_rocksdb_plugin::impl::find_operation_object(size_t opId, rocksdb_operation_object* op) const
+uint64_t account_history_rocksdb_plugin::impl::find_account_history_page(const account_name_type& name, uint64_t start,
+   uint32_t limit, const op_type_mask_pair& filter, uint64_t cursorId,
+   std::function<void(unsigned int, const rocksdb_operation_object&)> processor) const
 {
-   std::string data;
-   id_slice_t idSlice(opId);
-   ::rocksdb::Status s = _storage->Get(ReadOptions(), _columnHandles[OPERATION_BY_ID], idSlice, &data);
+   std::unique_ptr<AHCursor> cursor;
+   const auto now = fc::time_point::now();
 
-   if(s.ok())
    {
-      load(*op, data.data(), data.size());
-      return true;
+      std::lock_guard<std::mutex> lock(_cursorMutex);
+
+      for(auto itr = _cursors.begin(); itr != _cursors.end();)
+      {
+         if(itr->second->expiration < now)
+            itr = _cursors.erase(itr);
+         else
+            ++itr;
+      }
+
+      if(cursorId != 0)
+      {
+         auto found = _cursors.find(cursorId);
+         FC_ASSERT(found != _cursors.end(), "Unknown or expired cursor: ${c}", ("c", cursorId));
+         /// Checked before the cursor is taken out, so a mismatched request leaves it usable by its owner.
+         FC_ASSERT(found->second->name() == name, "Cursor ${c} does not belong to account ${a}", ("c", cursorId)("a", name));
+         cursor = std::move(found->second);
+         _cursors.erase(found);
+      }
    }
 
-   FC_ASSERT(s.IsNotFound());
+   if(!cursor)
+   {
+      account_history_info ahInfo;
+      if(loadAHInfo(name, ReadOptions(), &ahInfo) == false)
+         return 0;
 
-   return false;
-}
+      cursor = std::make_unique<AHCursor>(_storage.get(), _columnHandles[AH_OPERATION_BY_ID], name, ahInfo, filter);
+      cursor->iterator().SeekForPrev(ah_op_by_id_slice_t(std::make_pair(ahInfo.id, start)));
+   }
+
+   if(readAccountHistoryPage(*cursor, limit, processor) == false)
+      return 0;
+
+   cursor->expiration = fc::time_point::now() + _cursorTTL;
+
+   std::lock_guard<std::mutex> lock(_cursorMutex);
+
+   if(cursorId == 0)
+   {
+      do
+         cursorId = _cursorIdGenerator();
+      while(cursorId == 0 || _cursors.find(cursorId) != _cursors.end());
+   }
+
+   while(_cursors.size() >= _maxCursors)
+   {
+      auto oldest = std::min_element(_cursors.begin(), _cursors.end(),
+         [](const auto& a, const auto& b) { return a.second->expiration < b.second->expiration; });
+      _cursors.erase(oldest);
+   }
+
+   _cursors.emplace(cursorId, std::move(cursor));
+   return cursorId;
+}
+
+bool account_history_rocksdb_plugin::impl::find_operation_object(size_t opId, rocksdb_operation_object* op,
+   const ReadOptions& rOptions) const
+{
+   std::string data;
+   id_slice_t idSlice(opId);
+   ::rocksdb::Status s = _storage->Get(rOptions, _columnHandles[OPERATION_BY_ID], idSlice, &data);
+
+   if(s.ok())
+   {
+      load(*op, data.data(), data.size());
+      return true;
+   }
+
+   FC_ASSERT(s.IsNotFound());
+
+   return false;
+}
+
+bool account_history_rocksdb_plugin::impl::find_transaction_info(const transaction_id_type& trxId, uint32_t* blockNo,
+   uint32_t* txInBlock) const
+{
+   std::string data;
+   Slice idSlice(trxId.data(), trxId.data_size());
+   ::rocksdb::Status s = _storage->Get(ReadOptions(), _columnHandles[TRANSACTION_BY_ID], idSlice, &data);
+
+   if(s.ok())
+   {
+      const auto& location = trx_location_slice_t::unpackSlice(data);
+      *blockNo = location.first;
+      *txInBlock = location.second;
+      return true;
+   }
+
+   FC_ASSERT(s.IsNotFound());
+
+   return false;
+}
 
 void account_history_rocksdb_plugin::impl::find_operations_by_block(size_t blockNum,
    std::function<void(const rocksdb_operation_object&)> processor) const
 {
-   std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(ReadOptions(), _columnHandles[OPERATION_BY_BLOCK]));
+   ReadSnapshot snapshot(_storage.get());
+   ReadOptions rOptions = snapshot.options();
+
+   std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(rOptions, _columnHandles[OPERATION_BY_BLOCK]));
    by_block_slice_t blockNumSlice(blockNum);
    op_by_block_num_slice_t key(block_op_id_pair(blockNum, 0));
 
    for(it->Seek(key); it->Valid() && it->key().starts_with(blockNumSlice); it->Next())
    {
       auto valueSlice = it->value();
-      const auto& opId = id_slice_t::unpackSlice(valueSlice);
+      const auto opId = ah_op_entry_slice_t::unpackId(valueSlice);
 
       rocksdb_operation_object op;
-      bool found = find_operation_object(opId, &op);
+      bool found = find_operation_object(opId, &op, rOptions);
       FC_ASSERT(found);
 
       processor(op);
@@ -952,7 +1736,8 @@ uint32_t account_history_rocksdb_plugin::impl::enumVirtualOperationsFromBlockRan
 
    op_by_block_num_slice_t rangeBeginSlice(block_op_id_pair(blockRangeBegin, 0));
 
-   ReadOptions rOptions;
+   ReadSnapshot snapshot(_storage.get());
+   ReadOptions rOptions = snapshot.options();
    rOptions.iterate_upper_bound = &upperBoundSlice;
 
    std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(rOptions, _columnHandles[OPERATION_BY_BLOCK]));
@@ -968,10 +1753,10 @@ uint32_t account_history_rocksdb_plugin::impl::enumVirtualOperationsFromBlockRan
       if(key.second & VIRTUAL_OP_FLAG)
       {
          auto valueSlice = it->value();
-         const auto& opId = id_slice_t::unpackSlice(valueSlice);
+         const auto opId = ah_op_entry_slice_t::unpackId(valueSlice);
 
          rocksdb_operation_object op;
-         bool found = find_operation_object(opId, &op);
+         bool found = find_operation_object(opId, &op, rOptions);
          FC_ASSERT(found);
 
          processor(op);
@@ -980,7 +1765,7 @@ uint32_t account_history_rocksdb_plugin::impl::enumVirtualOperationsFromBlockRan
    }
 
    op_by_block_num_slice_t lowerBoundSlice(block_op_id_pair(lastFoundBlock, 0));
-   rOptions = ReadOptions();
+   rOptions = snapshot.options();
    rOptions.iterate_lower_bound = &lowerBoundSlice;
    it.reset(_storage->NewIterator(rOptions, _columnHandles[OPERATION_BY_BLOCK]));
 
@@ -997,6 +1782,58 @@ uint32_t account_history_rocksdb_plugin::impl::enumVirtualOperationsFromBlockRan
    return 0;
 }
 
+block_op_id_pair account_history_rocksdb_plugin::impl::findOperationsByBlockRange(uint32_t blockRangeBegin,
+   uint32_t blockRangeEnd, uint64_t operationBegin, bool onlyVirtual, const op_type_mask_pair& filter, uint32_t limit,
+   std::function<void(const rocksdb_operation_object&)> processor) const
+{
+   FC_ASSERT(blockRangeEnd > blockRangeBegin, "Block range must be upward");
+
+   ReadSnapshot snapshot(_storage.get());
+   ReadOptions rOptions = snapshot.options();
+
+   op_by_block_num_slice_t upperBoundSlice(block_op_id_pair(blockRangeEnd, 0));
+   rOptions.iterate_upper_bound = &upperBoundSlice;
+
+   std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(rOptions, _columnHandles[OPERATION_BY_BLOCK]));
+
+   const bool filtered = filter.first != 0 || filter.second != 0;
+   /// Skipped entries are bounded too, so a rare operation type cannot make a single call walk the whole range.
+   const uint64_t scanBudget = std::max<uint64_t>(uint64_t(limit) * FILTERED_SCAN_FACTOR, FILTERED_SCAN_MIN);
+   uint32_t reported = 0;
+   uint64_t scanned = 0;
+
+   op_by_block_num_slice_t rangeBeginSlice(block_op_id_pair(blockRangeBegin, operationBegin));
+
+   for(it->Seek(rangeBeginSlice); it->Valid(); it->Next())
+   {
+      const auto key = op_by_block_num_slice_t::unpackSlice(it->key());
+
+      if(reported >= limit || scanned >= scanBudget)
+         return key;
+
+      ++scanned;
+
+      if(onlyVirtual && (key.second & VIRTUAL_OP_FLAG) == 0)
+         continue;
+
+      auto valueSlice = it->value();
+      /// Operation type is stored next to its id, so filtered out operations are never loaded.
+      if(filtered && matchesTypeFilter(getTypeMask(ah_op_entry_slice_t::unpackType(valueSlice)), filter) == false)
+         continue;
+
+      rocksdb_operation_object op;
+      bool found = find_operation_object(ah_op_entry_slice_t::unpackId(valueSlice), &op, rOptions);
+      FC_ASSERT(found);
+
+      processor(op);
+      ++reported;
+   }
+
+   checkStatus(it->status());
+
+   return block_op_id_pair(0, 0);
+}
+
 uint32_t account_history_rocksdb_plugin::impl::get_lib()
 {
    std::string data;
@@ -1021,27 +1858,87 @@ account_history_rocksdb_plugin::impl::ColumnDefinitions account_history_rocksdb_
    if(addDefaultColumn)
       columnDefs.emplace_back(::rocksdb::kDefaultColumnFamilyName, ColumnFamilyOptions());
 
-   columnDefs.emplace_back("current_lib", ColumnFamilyOptions());
+   columnDefs.emplace_back("current_lib",
+      makeColumnOptions("current_lib", ::rocksdb::BytewiseComparator(), true, false, false));
+
+   columnDefs.emplace_back("operation_by_id",
+      makeColumnOptions("operation_by_id", by_id_Comparator(), true, true, true));
 
-   columnDefs.emplace_back("operation_by_id", ColumnFamilyOptions());
-   auto& byIdColumn = columnDefs.back();
-   byIdColumn.options.comparator = by_id_Comparator();
+   columnDefs.emplace_back("operation_by_block",
+      makeColumnOptions("operation_by_block", op_by_block_num_Comparator(), false, false, true));
 
-   columnDefs.emplace_back("operation_by_block", ColumnFamilyOptions());
-   auto& byLocationColumn = columnDefs.back();
-   byLocationColumn.options.comparator = op_by_block_num_Comparator();
+   columnDefs.emplace_back("account_history_info_by_name",
+      makeColumnOptions("account_history_info_by_name", by_account_name_Comparator(), true, false, false));
 
-   columnDefs.emplace_back("account_history_info_by_name", ColumnFamilyOptions());
-   auto& byAccountNameColumn = columnDefs.back();
-   byAccountNameColumn.options.comparator = by_account_name_Comparator();
+   columnDefs.emplace_back("ah_operation_by_id",
+      makeColumnOptions("ah_operation_by_id", ah_op_by_id_Comparator(), false, false, true));
 
-   columnDefs.emplace_back("ah_operation_by_id", ColumnFamilyOptions());
-   auto& byAHInfoColumn = columnDefs.back();
-   byAHInfoColumn.options.comparator = ah_op_by_id_Comparator();
+   /// Keys are transaction ids (hashes), so default bytewise comparator is sufficient.
+   columnDefs.emplace_back("transaction_by_id",
+      makeColumnOptions("transaction_by_id", ::rocksdb::BytewiseComparator(), true, false, true));
+
+   columnDefs.emplace_back("ah_op_type_summary_by_id",
+      makeColumnOptions("ah_op_type_summary_by_id", ah_op_by_id_Comparator(), true, false, false));
 
    return columnDefs;
 }
 
+ColumnFamilyOptions account_history_rocksdb_plugin::impl::makeColumnOptions(const std::string& name,
+   const Comparator* comparator, bool pointLookups, bool useDictionary, bool tiered) const
+{
+   ColumnFamilyOptions options;
+   options.comparator = comparator;
+
+   options.compression = _columnTuning.compression;
+   options.bottommost_compression = _columnTuning.bottommostCompression;
+
+   if(useDictionary && _columnTuning.dictionarySize != 0 && _columnTuning.bottommostCompression == ::rocksdb::kZSTD)
+   {
+      auto& dictOptions = options.bottommost_compression_opts;
+      dictOptions.enabled = true;
+      dictOptions.max_dict_bytes = _columnTuning.dictionarySize;
+      dictOptions.zstd_max_train_bytes = _columnTuning.dictionarySize * DICTIONARY_TRAINING_FACTOR;
+   }
+
+   ::rocksdb::BlockBasedTableOptions tableOptions;
+   tableOptions.block_size = _columnTuning.blockSize;
+   tableOptions.block_cache = _columnTuning.blockCache;
+
+   /// Columns being only iterated over would not benefit from bloom filters.
+   if(pointLookups && _columnTuning.bloomBits != 0)
+      tableOptions.filter_policy.reset(::rocksdb::NewBloomFilterPolicy(_columnTuning.bloomBits, false));
+
+   if(_columnTuning.partitionedIndex)
+   {
+      tableOptions.index_type = ::rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+      tableOptions.partition_filters = tableOptions.filter_policy != nullptr;
+      tableOptions.cache_index_and_filter_blocks = true;
+      tableOptions.pin_top_level_index_and_filter = true;
+   }
+
+   options.table_factory.reset(::rocksdb::NewBlockBasedTableFactory(tableOptions));
+
+   if(tiered && _columnTuning.coldPath.empty() == false)
+   {
+      /** RocksDB places newer levels in paths listed first, as long as they fit in the path target size.
+       *  Levels which do not fit (the oldest and biggest ones) are compacted into the cold path.
+       */
+      options.cf_paths.emplace_back(_storagePath.string(), _columnTuning.hotSize);
+      options.cf_paths.emplace_back(_columnTuning.coldPath.string(), std::numeric_limits<uint64_t>::max());
+   }
+
+   auto overrideItr = _columnTuning.overrides.find(name);
+   if(overrideItr != _columnTuning.overrides.end())
+   {
+      ColumnFamilyOptions overridden;
+      auto s = ::rocksdb::GetColumnFamilyOptionsFromString(options, overrideItr->second, &overridden);
+      FC_ASSERT(s.ok(), "Invalid options for column `${c}': ${m}", ("c", name)("m", s.ToString()));
+      options = overridden;
+   }
+
+   return options;
+}
+
 bool account_history_rocksdb_plugin::impl::createDbSchema(const bfs::path& path)
 {
    DB* db = nullptr;
@@ -1107,22 +2004,16 @@ void account_history_rocksdb_plugin::impl::buildAccountHistoryRecord( const acco
 
    account_history_info ahInfo;
    bool found = _writeBuffer.getAHInfo(name, &ahInfo);
+   const auto opType = getOperationType(obj.serialized_op);
 
    if(found)
    {
-      auto count = ahInfo.getAssociatedOpCount();
-
-      if(_prune && count > ACCOUNT_HISTORY_LENGTH_LIMIT &&
-         ((obj.timestamp - ahInfo.oldestEntryTimestamp) > fc::days(ACCOUNT_HISTORY_TIME_LIMIT)))
-         {
-            prunePotentiallyTooOldItems(&ahInfo, name, obj.timestamp);
-         }
-
       auto nextEntryId = ++ahInfo.newestEntryId;
-       _writeBuffer.putAHInfo(name, ahInfo);
+      updateTypeSummary(&ahInfo, nextEntryId, opType);
+      _writeBuffer.putAHInfo(name, ahInfo);
 
       ah_op_by_id_slice_t ahInfoOpSlice(std::make_pair(ahInfo.id, nextEntryId));
-      id_slice_t valueSlice(obj.id);
+      ah_op_entry_slice_t valueSlice(obj.id, opType, obj.timestamp);
       auto s = _writeBuffer.Put(_columnHandles[AH_OPERATION_BY_ID], ahInfoOpSlice, valueSlice);
       checkStatus(s);
    }
@@ -1132,82 +2023,246 @@ void account_history_rocksdb_plugin::impl::buildAccountHistoryRecord( const acco
       ahInfo.id = _accountHistorySeqId++;
       ahInfo.newestEntryId = ahInfo.oldestEntryId = 0;
       ahInfo.oldestEntryTimestamp = obj.timestamp;
+      updateTypeSummary(&ahInfo, 0, opType);
 
       _writeBuffer.putAHInfo(name, ahInfo);
 
       ah_op_by_id_slice_t ahInfoOpSlice(std::make_pair(ahInfo.id, 0));
-      id_slice_t valueSlice(obj.id);
+      ah_op_entry_slice_t valueSlice(obj.id, opType, obj.timestamp);
       auto s = _writeBuffer.Put(_columnHandles[AH_OPERATION_BY_ID], ahInfoOpSlice, valueSlice);
       checkStatus(s);
    }
 }
 
-void account_history_rocksdb_plugin::impl::prunePotentiallyTooOldItems(account_history_info* ahInfo, const account_name_type& name,
-   const fc::time_point_sec& now)
+void account_history_rocksdb_plugin::impl::updateTypeSummary(account_history_info* ahInfo, uint32_t entryId,
+   uint32_t opType)
 {
-   std::string strName = name;
+   /// Entry ids are subsequent, so the first entry of a chunk means the previous one has been completed.
+   if(entryId != 0 && entryId % AH_OP_TYPE_SUMMARY_CHUNK == 0)
+   {
+      ah_op_by_id_slice_t summaryKey(std::make_pair(ahInfo->id, entryId / AH_OP_TYPE_SUMMARY_CHUNK - 1));
+      op_type_mask_slice_t summarySlice(op_type_mask_pair(ahInfo->newestChunkTypesLow, ahInfo->newestChunkTypesHigh));
+      auto s = _writeBuffer.Put(_columnHandles[AH_OP_TYPE_SUMMARY_BY_ID], summaryKey, summarySlice);
+      checkStatus(s);
 
-   auto ageLimit =  fc::days(ACCOUNT_HISTORY_TIME_LIMIT);
+      ahInfo->newestChunkTypesLow = ahInfo->newestChunkTypesHigh = 0;
+   }
 
-   ah_op_by_id_slice_t oldestEntrySlice(
-      std::make_pair(ahInfo->id, ahInfo->oldestEntryId));
-   auto lookupUpperBound = std::make_pair(ahInfo->id + 1,
-      ahInfo->newestEntryId - ACCOUNT_HISTORY_LENGTH_LIMIT + 1);
+   auto mask = getTypeMask(opType);
+   ahInfo->newestChunkTypesLow |= mask.first;
+   ahInfo->newestChunkTypesHigh |= mask.second;
+}
 
-   ah_op_by_id_slice_t newestEntrySlice(lookupUpperBound);
+op_type_mask_pair account_history_rocksdb_plugin::impl::getTypeSummary(const account_history_info& ahInfo,
+   uint32_t chunkNo, const ReadOptions& rOptions) const
+{
+   if(chunkNo == ahInfo.newestEntryId / AH_OP_TYPE_SUMMARY_CHUNK)
+      return op_type_mask_pair(ahInfo.newestChunkTypesLow, ahInfo.newestChunkTypesHigh);
 
-   ReadOptions rOptions;
-   //rOptions.tailing = true;
-   rOptions.iterate_lower_bound = &oldestEntrySlice;
-   rOptions.iterate_upper_bound = &newestEntrySlice;
+   std::string data;
+   ah_op_by_id_slice_t summaryKey(std::make_pair(ahInfo.id, chunkNo));
+   auto s = _storage->Get(rOptions, _columnHandles[AH_OP_TYPE_SUMMARY_BY_ID], summaryKey, &data);
+
+   if(s.ok())
+      return op_type_mask_slice_t::unpackSlice(data);
+
+   FC_ASSERT(s.IsNotFound());
+
+   return op_type_mask_pair(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max());
+}
 
-   auto s = _writeBuffer.SingleDelete(_columnHandles[AH_OPERATION_BY_ID], oldestEntrySlice);
+fc::time_point_sec account_history_rocksdb_plugin::impl::getEntryTimestamp(const account_history_info& ahInfo,
+   uint32_t entryId) const
+{
+   ah_op_by_id_slice_t key(std::make_pair(ahInfo.id, entryId));
+   PinnableSlice buffer;
+   auto s = _storage->Get(ReadOptions(), _columnHandles[AH_OPERATION_BY_ID], key, &buffer);
    checkStatus(s);
 
-   std::unique_ptr<::rocksdb::Iterator> dataItr(_storage->NewIterator(rOptions, _columnHandles[AH_OPERATION_BY_ID]));
+   return ah_op_entry_slice_t::unpackTimestamp(buffer);
+}
 
-   /** To clean outdated records we have to iterate over all AH records having subsequent number greater than limit
-    *  and additionally verify date of operation, to clean up only these exceeding a date limit.
-    *  So just operations having a list position > ACCOUNT_HISTORY_LENGTH_LIMIT and older that ACCOUNT_HISTORY_TIME_LIMIT
-    *  shall be removed.
+bool account_history_rocksdb_plugin::impl::findPruneBoundary(const account_history_info& ahInfo,
+   const fc::time_point_sec& cutoff, uint32_t* keepFrom, fc::time_point_sec* keepFromTimestamp) const
+{
+   /// Accounts are pruned only once enough entries expired, so each of them is rewritten at most once per threshold.
+   if(ahInfo.getAssociatedOpCount() <= ACCOUNT_HISTORY_LENGTH_LIMIT || ahInfo.oldestEntryTimestamp + PRUNE_THRESHOLD >= cutoff)
+      return false;
+
+   /** Entries of an account are subsequent and ordered by their timestamps, so the first entry to keep can be
+    *  found by binary search, instead of reading each of them. The newest ACCOUNT_HISTORY_LENGTH_LIMIT entries
+    *  are always kept.
     */
-   dataItr->Seek(oldestEntrySlice);
+   uint32_t lo = ahInfo.oldestEntryId;
+   uint32_t hi = ahInfo.newestEntryId - ACCOUNT_HISTORY_LENGTH_LIMIT + 1;
+
+   while(lo < hi)
+   {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if(getEntryTimestamp(ahInfo, mid) >= cutoff)
+         hi = mid;
+      else
+         lo = mid + 1;
+   }
+
+   if(lo == ahInfo.oldestEntryId)
+      return false;
 
-   /// Boundaries of keys to be removed
-   //uint32_t leftBoundary = ahInfo->oldestEntryId;
-   uint32_t rightBoundary = ahInfo->oldestEntryId;
+   *keepFrom = lo;
+   *keepFromTimestamp = getEntryTimestamp(ahInfo, lo);
+   return true;
+}
 
-   for(; dataItr->Valid(); dataItr->Next())
+bool account_history_rocksdb_plugin::impl::pruneAccountHistoryBatch(fc::optional<account_name_type>* resumeName,
+   const fc::time_point_sec& cutoff)
+{
+   struct prune_candidate
    {
-      auto key = dataItr->key();
-      auto foundEntry = ah_op_by_id_slice_t::unpackSlice(key);
+      account_name_type    name;
+      account_history_info ahInfo;
+      uint32_t             keepFrom = 0;
+      fc::time_point_sec   keepFromTimestamp;
+   };
 
-      if(foundEntry.first != ahInfo->id || foundEntry.second >= lookupUpperBound.second)
-         break;
+   std::vector<prune_candidate> candidates;
+   bool more = false;
 
-      auto value = dataItr->value();
+   {
+      std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(ReadOptions(), _columnHandles[AH_INFO_BY_NAME]));
 
-      auto pointedOpId = id_slice_t::unpackSlice(value);
-      rocksdb_operation_object op;
-      find_operation_object(pointedOpId, &op);
+      if(resumeName->valid())
+         it->Seek(ah_info_by_name_slice_t((*resumeName)->data));
+      else
+         it->SeekToFirst();
+
+      /// Lookups are done without holding the lock, so writes of new blocks are not held up by them.
+      for(uint32_t visited = 0; it->Valid(); it->Next(), ++visited)
+      {
+         account_name_type name;
+         name.data = ah_info_by_name_slice_t::unpackSlice(it->key());
+
+         if(visited == PRUNE_BATCH_SIZE)
+         {
+            *resumeName = name;
+            more = true;
+            break;
+         }
+
+         prune_candidate c;
+         c.name = name;
+         load(c.ahInfo, it->value().data(), it->value().size());
+
+         if(findPruneBoundary(c.ahInfo, cutoff, &c.keepFrom, &c.keepFromTimestamp))
+            candidates.push_back(std::move(c));
+      }
+
+      checkStatus(it->status());
+   }
+
+   if(candidates.empty())
+      return more;
+
+   WriteBatch batch;
 
-      auto age = now - op.timestamp;
+   std::lock_guard<std::mutex> lock(_ahInfoMutex);
 
-      if(age > ageLimit)
+   for(const auto& c : candidates)
+   {
+      /// Infos are reloaded, since new entries could be written meanwhile. Only the pruner moves the oldest entry.
+      account_history_info ahInfo;
+      if(loadAHInfo(c.name, ReadOptions(), &ahInfo) == false || ahInfo.oldestEntryId != c.ahInfo.oldestEntryId)
+         continue;
+
+      ah_op_by_id_slice_t rangeBegin(std::make_pair(ahInfo.id, ahInfo.oldestEntryId));
+      ah_op_by_id_slice_t rangeEnd(std::make_pair(ahInfo.id, c.keepFrom));
+      auto s = batch.DeleteRange(_columnHandles[AH_OPERATION_BY_ID], rangeBegin, rangeEnd);
+      checkStatus(s);
+
+      /// Type summaries of chunks having all their entries pruned are not needed anymore.
+      const uint32_t firstChunk = ahInfo.oldestEntryId / AH_OP_TYPE_SUMMARY_CHUNK;
+      const uint32_t firstKeptChunk = c.keepFrom / AH_OP_TYPE_SUMMARY_CHUNK;
+      if(firstChunk < firstKeptChunk)
       {
-         rightBoundary = foundEntry.second;
-         ah_op_by_id_slice_t rightBoundarySlice(
-            std::make_pair(ahInfo->id, rightBoundary));
-         s = _writeBuffer.SingleDelete(_columnHandles[4], rightBoundarySlice);
+         ah_op_by_id_slice_t summaryBegin(std::make_pair(ahInfo.id, firstChunk));
+         ah_op_by_id_slice_t summaryEnd(std::make_pair(ahInfo.id, firstKeptChunk));
+         s = batch.DeleteRange(_columnHandles[AH_OP_TYPE_SUMMARY_BY_ID], summaryBegin, summaryEnd);
          checkStatus(s);
       }
-      else
+
+      ahInfo.oldestEntryId = c.keepFrom;
+      ahInfo.oldestEntryTimestamp = c.keepFromTimestamp;
+      FC_ASSERT(ahInfo.oldestEntryId <= ahInfo.newestEntryId);
+
+      auto serializedInfo = dump(ahInfo);
+      s = batch.Put(_columnHandles[AH_INFO_BY_NAME], ah_info_by_name_slice_t(c.name.data),
+         Slice(serializedInfo.data(), serializedInfo.size()));
+      checkStatus(s);
+   }
+
+   auto s = _storage->Write(::rocksdb::WriteOptions(), &batch);
+   checkStatus(s);
+
+   return more;
+}
+
+void account_history_rocksdb_plugin::impl::startPruner()
+{
+   if(_prune == false)
+      return;
+
+   _stopPruner = false;
+   _prunerThread = std::thread([this]() { prunerMain(); });
+}
+
+void account_history_rocksdb_plugin::impl::stopPruner()
+{
+   if(_prunerThread.joinable() == false)
+      return;
+
+   {
+      std::lock_guard<std::mutex> lock(_prunerMutex);
+      _stopPruner = true;
+   }
+
+   _prunerWakeUp.notify_all();
+   _prunerThread.join();
+}
+
+void account_history_rocksdb_plugin::impl::prunerMain()
+{
+   const auto interval = std::chrono::microseconds(_pruneInterval.count());
+
+   while(true)
+   {
       {
-         ahInfo->oldestEntryId = foundEntry.second;
-         ahInfo->oldestEntryTimestamp = op.timestamp;
-         FC_ASSERT(ahInfo->oldestEntryId <= ahInfo->newestEntryId);
+         std::unique_lock<std::mutex> lock(_prunerMutex);
+         if(_prunerWakeUp.wait_for(lock, interval, [this]() { return _stopPruner; }))
+            return;
+      }
 
-         break;
+      /// During reindex infos are cached by block application, out of `_ahInfoMutex` protection.
+      if(_reindexing)
+         continue;
+
+      try
+      {
+         const fc::time_point_sec cutoff = fc::time_point::now() - _pruneAge;
+         fc::optional<account_name_type> resumeName;
+
+         while(pruneAccountHistoryBatch(&resumeName, cutoff))
+         {
+            std::lock_guard<std::mutex> lock(_prunerMutex);
+            if(_stopPruner || _reindexing)
+               break;
+         }
+      }
+      catch(const fc::exception& e)
+      {
+         elog("RocksDB pruning failed: ${e}", ("e", e.to_detail_string()));
+      }
+      catch(const std::exception& e)
+      {
+         elog("RocksDB pruning failed: ${e}", ("e", e.what()));
       }
    }
 }
@@ -1219,7 +2274,8 @@ void account_history_rocksdb_plugin::impl::on_pre_reindex(const blurt::chain::re
    shutdownDb();
    std::string strPath = _storagePath.string();
 
-   auto s = ::rocksdb::DestroyDB(strPath, ::rocksdb::Options());
+   /// Column definitions are needed to also remove files placed in cold storage path.
+   auto s = ::rocksdb::DestroyDB(strPath, ::rocksdb::Options(), prepareColumnDefinitions(true));
    checkStatus(s);
 
    openDb();
@@ -1242,10 +2298,12 @@ void account_history_rocksdb_plugin::impl::on_post_reindex(const blurt::chain::r
    ilog("Reindex completed up to block: ${b}. Setting back write limit to non-massive level.",
       ("b", note.last_block_number));
 
-   flushStorage();
    _collectedOpsWriteLimit = 1;
-   _reindexing = false;
    update_lib( note.last_block_number ); // We always reindex irreversible blocks.
+   _queuedLib = note.last_block_number;
+   flushWriteBuffer();
+   flushStorage();
+   _reindexing = false;
 
    printReport( note.last_block_number, "RocksDB data reindex finished." );
 }
@@ -1257,13 +2315,256 @@ void account_history_rocksdb_plugin::impl::printReport(uint32_t blockNo, const c
         "${ea} accounts have been filtered out due to configured options.",
       ("t", detailText)
       ("n", blockNo)
-      ("tx", _txNo)
-      ("op", _totalOps)
+      ("tx", _txNo.load())
+      ("op", _totalOps.load())
       ("ep", _excludedOps)
-      ("ea", _excludedAccountCount)
+      ("ea", _excludedAccountCount.load())
       );
 }
 
+void account_history_rocksdb_plugin::impl::reportCompression(uint32_t sampleMegabytes)
+{
+   if(_storage == nullptr)
+   {
+      ilog("RocksDB has no opened storage. Skipping compression report...");
+      return;
+   }
+
+   struct candidate
+   {
+      const char*     label;
+      CompressionType compression;
+      uint32_t        dictionarySize;
+   };
+
+   const candidate candidates[] =
+   {
+      { "none",           ::rocksdb::kNoCompression,   0 },
+      { "lz4",            ::rocksdb::kLZ4Compression,  0 },
+      { "zstd",           ::rocksdb::kZSTD,            0 },
+      { "zstd+dict16K",   ::rocksdb::kZSTD,            16 * 1024 },
+      { "zstd+dict64K",   ::rocksdb::kZSTD,            64 * 1024 },
+      { "zstd+dict112K",  ::rocksdb::kZSTD,            112 * 1024 }
+   };
+
+   const size_t sampleLimit = size_t(sampleMegabytes) << 20;
+   const auto workDir = bfs::temp_directory_path() / bfs::unique_path("ah-rocksdb-compression-%%%%-%%%%");
+   bfs::create_directories(workDir);
+
+   ilog("Sampling up to ${m} MB of newest data of each column family to compare compression settings...",
+      ("m", sampleMegabytes));
+
+   /// Column handles are ordered like column definitions, following the default column.
+   auto columnDefs = prepareColumnDefinitions(false);
+
+   for(size_t i = 0; i < columnDefs.size(); ++i)
+   {
+      const auto& columnDef = columnDefs[i];
+
+      std::vector<std::pair<std::string, std::string>> sample;
+      size_t sampleSize = 0;
+
+      {
+         ReadSnapshot snapshot(_storage.get());
+         std::unique_ptr<::rocksdb::Iterator> it(_storage->NewIterator(snapshot.options(), _columnHandles[i + 1]));
+
+         for(it->SeekToLast(); it->Valid() && sampleSize < sampleLimit; it->Prev())
+         {
+            sample.emplace_back(it->key().ToString(), it->value().ToString());
+            sampleSize += it->key().size() + it->value().size();
+         }
+      }
+
+      if(sample.empty())
+         continue;
+
+      /// SST files must be written in comparator order.
+      std::reverse(sample.begin(), sample.end());
+
+      const candidate* best = nullptr;
+      uint64_t bestSize = std::numeric_limits<uint64_t>::max();
+
+      for(const auto& c : candidates)
+      {
+         Options sstOptions(DBOptions(), columnDef.options);
+         /// Externally written files are placed at bottommost level, so its compression settings apply.
+         sstOptions.compression = sstOptions.bottommost_compression = c.compression;
+         sstOptions.bottommost_compression_opts = ::rocksdb::CompressionOptions();
+         if(c.dictionarySize != 0)
+         {
+            sstOptions.bottommost_compression_opts.enabled = true;
+            sstOptions.bottommost_compression_opts.max_dict_bytes = c.dictionarySize;
+            sstOptions.bottommost_compression_opts.zstd_max_train_bytes = c.dictionarySize * DICTIONARY_TRAINING_FACTOR;
+         }
+
+         const auto filePath = (workDir / (columnDef.name + "-" + c.label + ".sst")).string();
+         ::rocksdb::SstFileWriter writer(::rocksdb::EnvOptions(), sstOptions, sstOptions.comparator);
+         ::rocksdb::ExternalSstFileInfo fileInfo;
+
+         auto s = writer.Open(filePath);
+         for(auto itr = sample.begin(); s.ok() && itr != sample.end(); ++itr)
+            s = writer.Put(itr->first, itr->second);
+         if(s.ok())
+            s = writer.Finish(&fileInfo);
+
+         bfs::remove(filePath);
+
+         if(s.ok() == false)
+         {
+            wlog("Column `${c}': `${l}' setting could not be evaluated: ${m}",
+               ("c", columnDef.name)("l", c.label)("m", s.ToString()));
+            continue;
+         }
+
+         ilog("Column `${c}': `${l}' stores ${n} sampled bytes in ${s} bytes (${r}%).",
+            ("c", columnDef.name)("l", c.label)("n", sampleSize)("s", fileInfo.file_size)
+            ("r", fileInfo.file_size * 100 / sampleSize));
+
+         if(fileInfo.file_size < bestSize)
+         {
+            bestSize = fileInfo.file_size;
+            best = &c;
+         }
+      }
+
+      if(best != nullptr)
+         ilog("Column `${c}': best setting is `${l}'.", ("c", columnDef.name)("l", best->label));
+   }
+
+   bfs::remove_all(workDir);
+}
+
+void account_history_rocksdb_plugin::impl::extractOperations(const signed_block& block,
+   std::vector<import_operation>* ops) const
+{
+   const uint32_t blockNo = block.block_num();
+
+   uint32_t txInBlock = 0;
+   for(const auto& tx : block.transactions)
+   {
+      const auto txId = tx.id();
+
+      uint16_t opInTx = 0;
+      for(const auto& op : tx.operations)
+      {
+         auto impacted = getImpactedAccounts( op );
+
+         if( impacted.empty() == false )
+         {
+            ops->emplace_back();
+            auto& iop = ops->back();
+            iop.impacted = std::move( impacted );
+            iop.opType = op.which();
+
+            auto& obj = iop.obj;
+            obj.trx_id = txId;
+            obj.block = blockNo;
+            obj.trx_in_block = txInBlock;
+            obj.op_in_trx = opInTx;
+            obj.timestamp = block.timestamp;
+            auto size = fc::raw::pack_size( op );
+            obj.serialized_op.resize( size );
+            fc::datastream< char* > ds( obj.serialized_op.data(), size );
+            fc::raw::pack( ds, op );
+         }
+
+         ++opInTx;
+      }
+
+      ++txInBlock;
+   }
+}
+
+void account_history_rocksdb_plugin::impl::importBlocks(const std::vector<signed_block>& blocks,
+   import_worker_pool& workers)
+{
+   /// Stage 1: extract operations. Each block gets its own output slot, so block order is preserved.
+   std::vector<std::vector<import_operation>> extracted(blocks.size());
+
+   workers.run(blocks.size(), [&](size_t begin, size_t end)
+   {
+      for(size_t i = begin; i < end; ++i)
+         extractOperations(blocks[i], &extracted[i]);
+   }
+   );
+
+   /// Stage 2: deterministic sequencing pass, in block order.
+   std::vector<import_operation*> sequenced;
+
+   for(auto& blockOps : extracted)
+   {
+      for(auto& iop : blockOps)
+      {
+         if(_lastTx != iop.obj.trx_id)
+         {
+            ++_txNo;
+            _lastTx = iop.obj.trx_id;
+            iop.firstInTx = true;
+         }
+
+         iop.obj.id = _operationSeqId++;
+
+         iop.ahEntries.reserve(iop.impacted.size());
+         for(const auto& name : iop.impacted)
+         {
+            account_history_info ahInfo;
+            uint32_t entryId = 0;
+
+            if(_writeBuffer.getAHInfo(name, &ahInfo))
+            {
+               entryId = ++ahInfo.newestEntryId;
+            }
+            else
+            {
+               /// New entry must be created - there is first operation recorded.
+               ahInfo.id = _accountHistorySeqId++;
+               ahInfo.newestEntryId = ahInfo.oldestEntryId = 0;
+               ahInfo.oldestEntryTimestamp = iop.obj.timestamp;
+            }
+
+            updateTypeSummary(&ahInfo, entryId, iop.opType);
+            _writeBuffer.putAHInfo(name, ahInfo);
+            iop.ahEntries.emplace_back(ahInfo.id, entryId);
+         }
+
+         sequenced.push_back(&iop);
+         ++_totalOps;
+      }
+   }
+
+   /// Stage 3: write operations and account history entries, each worker using its own WriteBatch.
+   workers.run(sequenced.size(), [&](size_t begin, size_t end)
+   {
+      WriteBatch batch;
+
+      for(size_t i = begin; i < end; ++i)
+      {
+         const auto& iop = *sequenced[i];
+         storeOperation(batch, iop.obj);
+
+         if(iop.firstInTx)
+            storeTransactionLocation(batch, iop.obj);
+
+         for(const auto& entry : iop.ahEntries)
+         {
+            ah_op_by_id_slice_t ahInfoOpSlice(entry);
+            ah_op_entry_slice_t valueSlice(iop.obj.id, iop.opType, iop.obj.timestamp);
+            auto s = batch.Put(_columnHandles[AH_OPERATION_BY_ID], ahInfoOpSlice, valueSlice);
+            checkStatus(s);
+         }
+      }
+
+      auto s = _storage->Write(::rocksdb::WriteOptions(), &batch);
+      checkStatus(s);
+   }
+   );
+
+   /** Account history infos (collected by _writeBuffer during sequencing) and seq-ids are written last,
+    *  so they never point to records not yet present in the storage.
+    */
+   flushWriteBuffer();
+}
+
 void account_history_rocksdb_plugin::impl::importData(unsigned int blockLimit)
 {
    if(_storage == nullptr)
@@ -1272,10 +2573,9 @@ void account_history_rocksdb_plugin::impl::importData(unsigned int blockLimit)
       return;
    }
 
-   ilog("Starting data import...");
+   ilog("Starting data import using ${t} thread(s)...", ("t", _importThreads));
 
-   block_id_type lastBlock;
-   size_t blockNo = 0;
+   uint32_t blockNo = 0;
 
    _lastTx = transaction_id_type();
    _txNo = 0;
@@ -1285,46 +2585,40 @@ void account_history_rocksdb_plugin::impl::importData(unsigned int blockLimit)
    benchmark_dumper dumper;
    dumper.initialize([](benchmark_dumper::database_object_sizeof_cntr_t&){}, "rocksdb_data_import.json");
 
-   _mainDb.foreach_operation([blockLimit, &blockNo, &lastBlock, this](
-      const signed_block_header& prevBlockHeader, const signed_block& block, const signed_transaction& tx,
-      uint32_t txInBlock, const operation& op, uint16_t opInTx) -> bool
+   import_worker_pool workers(_importThreads);
+   std::vector<signed_block> blocks;
+   blocks.reserve(IMPORT_BLOCK_CHUNK_SIZE);
+
+   _mainDb.foreach_block([blockLimit, &blockNo, &blocks, &workers, this](
+      const signed_block_header& prevBlockHeader, const signed_block& block) -> bool
    {
-      if(lastBlock != block.previous)
-      {
-         blockNo = block.block_num();
-         lastBlock = block.previous;
+      auto currentBlockNo = block.block_num();
 
-         if(blockLimit != 0 && blockNo > blockLimit)
-         {
-            ilog( "RocksDb data import stopped because of block limit reached.");
-            return false;
-         }
+      if(blockLimit != 0 && currentBlockNo > blockLimit)
+      {
+         ilog( "RocksDb data import stopped because of block limit reached.");
+         return false;
       }
 
-      auto impacted = getImpactedAccounts( op );
-
-      if( impacted.empty() )
-         return true;
+      blockNo = currentBlockNo;
+      blocks.push_back(block);
 
-      rocksdb_operation_object obj;
-      obj.trx_id = tx.id();
-      obj.block = blockNo;
-      obj.trx_in_block = txInBlock;
-      obj.op_in_trx = opInTx;
-      obj.timestamp = _mainDb.head_block_time();
-      auto size = fc::raw::pack_size( op );
-      obj.serialized_op.resize( size );
-      fc::datastream< char* > ds( obj.serialized_op.data(), size );
-      fc::raw::pack( ds, op );
-
-      importOperation( obj, impacted );
+      if(blocks.size() >= IMPORT_BLOCK_CHUNK_SIZE)
+      {
+         std::lock_guard<std::mutex> lock(_ahInfoMutex);
+         importBlocks(blocks, workers);
+         blocks.clear();
+      }
 
       return true;
    }
    );
 
-   if(_collectedOps != 0)
-      flushWriteBuffer();
+   if(blocks.empty() == false)
+   {
+      std::lock_guard<std::mutex> lock(_ahInfoMutex);
+      importBlocks(blocks, workers);
+   }
 
    const auto& measure = dumper.measure(blockNo, [](benchmark_dumper::index_memory_details_cntr_t&, bool){});
    ilog( "RocksDb data import - Performance report at block ${n}. Elapsed time: ${rt} ms (real), ${ct} ms (cpu). Memory usage: ${cm} (current), ${pm} (peak) kilobytes.",
@@ -1345,10 +2639,10 @@ void account_history_rocksdb_plugin::impl::on_post_apply_operation(const operati
            " ${ep} operations have been filtered out due to configured options.\n"
            " ${ea} accounts have been filtered out due to configured options.",
          ("n", n.block)
-         ("tx", _txNo)
-         ("op", _totalOps)
+         ("tx", _txNo.load())
+         ("op", _totalOps.load())
          ("ep", _excludedOps)
-         ("ea", _excludedAccountCount)
+         ("ea", _excludedAccountCount.load())
          );
    }
 
@@ -1378,6 +2672,9 @@ void account_history_rocksdb_plugin::impl::on_post_apply_operation(const operati
       fc::raw::pack( ds, n.op );
 
       importOperation( obj, impacted );
+
+      if( _collectedOps >= _collectedOpsWriteLimit )
+         flushWriteBuffer();
    }
    else
    {
@@ -1402,27 +2699,117 @@ void account_history_rocksdb_plugin::impl::on_irreversible_block( uint32_t block
 {
    if( _reindexing ) return;
 
-   if( block_num <= get_lib() ) return;
+   if( block_num <= _queuedLib ) return;
 
    const auto& volatile_idx = _mainDb.get_index< volatile_operation_index, by_block >();
    auto itr = volatile_idx.begin();
 
+   pending_block block;
+   block.blockNum = block_num;
    vector< const volatile_operation_object* > to_delete;
 
    while( itr != volatile_idx.end() && itr->block <= block_num )
    {
-      rocksdb_operation_object obj( *itr );
-      importOperation( obj , itr->impacted );
+      block.ops.emplace_back( rocksdb_operation_object( *itr ),
+         std::vector< account_name_type >( itr->impacted.begin(), itr->impacted.end() ) );
       to_delete.push_back( &(*itr) );
       ++itr;
    }
 
+   enqueueBlock( std::move( block ) );
+   _queuedLib = block_num;
+
    for( const volatile_operation_object* o : to_delete )
    {
       _mainDb.remove( *o );
    }
+}
+
+void account_history_rocksdb_plugin::impl::startWriter()
+{
+   _stopWriter = false;
+   _writerError = nullptr;
+   _writerThread = std::thread( [this]() { writerMain(); } );
+}
+
+void account_history_rocksdb_plugin::impl::stopWriter()
+{
+   if( _writerThread.joinable() == false )
+      return;
+
+   {
+      std::lock_guard< std::mutex > lock( _writeQueueMutex );
+      _stopWriter = true;
+   }
+
+   _writeQueueNotEmpty.notify_all();
+   /// Writer leaves after all queued blocks are written.
+   _writerThread.join();
+}
+
+void account_history_rocksdb_plugin::impl::enqueueBlock( pending_block&& block )
+{
+   std::unique_lock< std::mutex > lock( _writeQueueMutex );
+   _writeQueueNotFull.wait( lock, [this]() { return _writeQueue.size() < _writeQueueLimit || _writerError; } );
+
+   if( _writerError )
+      std::rethrow_exception( _writerError );
+
+   _writeQueue.emplace_back( std::move( block ) );
+   lock.unlock();
+
+   _writeQueueNotEmpty.notify_one();
+}
+
+void account_history_rocksdb_plugin::impl::writerMain()
+{
+   while( true )
+   {
+      pending_block block;
+
+      {
+         std::unique_lock< std::mutex > lock( _writeQueueMutex );
+         _writeQueueNotEmpty.wait( lock, [this]() { return _stopWriter || _writeQueue.empty() == false; } );
+
+         if( _writeQueue.empty() )
+            return;
+
+         block = std::move( _writeQueue.front() );
+         _writeQueue.pop_front();
+      }
+
+      _writeQueueNotFull.notify_one();
+
+      std::exception_ptr error;
 
-   update_lib( block_num );
+      try
+      {
+         std::lock_guard< std::mutex > ahInfoLock( _ahInfoMutex );
+
+         for( auto& entry : block.ops )
+            importOperation( entry.first, entry.second );
+
+         /// Operations and LIB are committed together, so stored LIB always matches stored history.
+         update_lib( block.blockNum );
+         flushWriteBuffer();
+         continue;
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "RocksDB writer failed at block ${b}: ${e}", ("b", block.blockNum)("e", e.to_detail_string()) );
+         error = std::current_exception();
+      }
+      catch( const std::exception& e )
+      {
+         elog( "RocksDB writer failed at block ${b}: ${e}", ("b", block.blockNum)("e", e.what()) );
+         error = std::current_exception();
+      }
+
+      std::lock_guard< std::mutex > lock( _writeQueueMutex );
+      _writerError = error;
+      _writeQueueNotFull.notify_all();
+      return;
+   }
 }
 
 account_history_rocksdb_plugin::account_history_rocksdb_plugin()
@@ -1444,6 +2831,38 @@ void account_history_rocksdb_plugin::set_program_options(
       ("account-history-rocksdb-track-account-range", boost::program_options::value< std::vector<std::string> >()->composing()->multitoken(), "Defines a range of accounts to track as a json pair [\"from\",\"to\"] [from,to] Can be specified multiple times.")
       ("account-history-rocksdb-whitelist-ops", boost::program_options::value< std::vector<std::string> >()->composing(), "Defines a list of operations which will be explicitly logged.")
       ("account-history-rocksdb-blacklist-ops", boost::program_options::value< std::vector<std::string> >()->composing(), "Defines a list of operations which will be explicitly ignored.")
+      ("account-history-rocksdb-compression", bpo::value<std::string>()->default_value("lz4"),
+         "Compression used by upper (hot) levels of the storage: none, snappy, zlib, lz4, lz4hc or zstd.")
+      ("account-history-rocksdb-bottommost-compression", bpo::value<std::string>()->default_value("zstd"),
+         "Compression used by the bottommost level of the storage, holding most of the data: none, snappy, zlib, lz4, lz4hc or zstd.")
+      ("account-history-rocksdb-dictionary-size", bpo::value<uint32_t>()->default_value(DEFAULT_DICTIONARY_SIZE),
+         "Size in bytes of ZSTD dictionary trained for bottommost level of operation storage. 0 disables dictionary compression.")
+      ("account-history-rocksdb-block-size", bpo::value<uint32_t>()->default_value(DEFAULT_BLOCK_SIZE),
+         "Size in bytes of storage data blocks.")
+      ("account-history-rocksdb-bloom-bits", bpo::value<uint32_t>()->default_value(DEFAULT_BLOOM_BITS),
+         "Bits per key of bloom filters built for columns queried by exact key. 0 disables bloom filters.")
+      ("account-history-rocksdb-partitioned-index", bpo::value<bool>()->default_value(true),
+         "Use partitioned indexes and filters, to keep only their top level in memory.")
+      ("account-history-rocksdb-block-cache-size", bpo::value<uint64_t>()->default_value(DEFAULT_BLOCK_CACHE_SIZE),
+         "Size in MB of block cache shared by all columns of the storage. It holds data blocks, as well as index and filter partitions.")
+      ("account-history-rocksdb-cold-storage-path", bpo::value<bfs::path>(),
+         "Location of cold storage tier (e.g. on cheaper, larger volume). When set, older levels of large columns are moved there by compaction, while the newest ones stay in account-history-rocksdb-path. Relative paths are based on $DATA_DIR. Once used, it must be kept for the storage (files can be moved to a new location only together with changing this option).")
+      ("account-history-rocksdb-hot-storage-size", bpo::value<uint64_t>()->default_value(DEFAULT_HOT_STORAGE_SIZE),
+         "Size in MB of data of single column kept in account-history-rocksdb-path, when cold storage path is set.")
+      ("account-history-rocksdb-column-options", boost::program_options::value< std::vector<std::string> >()->composing(),
+         "Overrides options of given column family, as `column_name:rocksdb_options' (e.g. `operation_by_id:compression=kZSTD;write_buffer_size=134217728'). Can be specified multiple times.")
+      ("account-history-rocksdb-cursor-ttl", bpo::value<uint32_t>()->default_value(CURSOR_TTL),
+         "Time in seconds an unused account history cursor (and its storage snapshot) is kept open.")
+      ("account-history-rocksdb-max-cursors", bpo::value<uint32_t>()->default_value(MAX_CURSORS),
+         "Maximum number of simultaneously open account history cursors. When exceeded, the least recently used cursor is closed.")
+      ("account-history-rocksdb-write-queue-size", bpo::value<uint32_t>()->default_value(WRITE_QUEUE_SIZE_LIMIT),
+         "Maximum number of irreversible blocks waiting to be written to the storage. Block application waits when it is exceeded.")
+      ("account-history-rocksdb-prune", bpo::value<bool>()->default_value(false),
+         "Remove account history entries older than account-history-rocksdb-prune-age days (the newest 30 entries of each account are always kept). An account is pruned once its oldest entry is a day past that age. Pruning is done by a background thread, outside of block application and data import.")
+      ("account-history-rocksdb-prune-age", bpo::value<uint32_t>()->default_value(ACCOUNT_HISTORY_TIME_LIMIT),
+         "Age in days of account history entries to be pruned.")
+      ("account-history-rocksdb-prune-interval", bpo::value<uint32_t>()->default_value(PRUNE_INTERVAL),
+         "Time in seconds between subsequent pruning passes over all accounts.")
 
    ;
    command_line_options.add_options()
@@ -1451,6 +2870,10 @@ void account_history_rocksdb_plugin::set_program_options(
          "Allows to force immediate data import at plugin startup. By default storage is supplied during reindex process.")
       ("account-history-rocksdb-stop-import-at-block", bpo::value<uint32_t>()->default_value(0),
          "Allows to specify block number, the data import process should stop at.")
+      ("account-history-rocksdb-import-threads", bpo::value<uint32_t>()->default_value(0),
+         "Number of threads used by immediate data import. 0 means the number of hardware threads.")
+      ("account-history-rocksdb-compression-report", bpo::value<uint32_t>()->default_value(0),
+         "Allows to sample given number of megabytes of each column family at plugin startup and report storage size achieved by candidate compression and dictionary settings.")
    ;
 }
 
@@ -1462,6 +2885,7 @@ void account_history_rocksdb_plugin::plugin_initialize(const boost::program_opti
       _blockLimit = options.at("account-history-rocksdb-stop-import-at-block").as<uint32_t>();
 
    _doImmediateImport = options.at("account-history-rocksdb-immediate-import").as<bool>();
+   _compressionReportSize = options.at("account-history-rocksdb-compression-report").as<uint32_t>();
 
    bfs::path dbPath;
 
@@ -1484,6 +2908,9 @@ void account_history_rocksdb_plugin::plugin_startup()
 {
    ilog("Starting up account_history_rocksdb_plugin...");
 
+   if(_compressionReportSize != 0)
+      _my->reportCompression(_compressionReportSize);
+
    if(_doImmediateImport)
       _my->importData(_blockLimit);
 }
@@ -1494,10 +2921,20 @@ void account_history_rocksdb_plugin::plugin_shutdown()
    _my->shutdownDb();
 }
 
-void account_history_rocksdb_plugin::find_account_history_data(const account_name_type& name, uint64_t start, uint32_t limit,
+bool account_history_rocksdb_plugin::find_account_history_data(const account_name_type& name, uint64_t start, uint32_t limit,
+   uint64_t operationFilterLow, uint64_t operationFilterHigh,
+   std::function<void(unsigned int, const rocksdb_operation_object&)> processor, uint64_t* nextStart) const
+{
+   return _my->find_account_history_data(name, start, limit, op_type_mask_pair(operationFilterLow, operationFilterHigh),
+      processor, nextStart);
+}
+
+uint64_t account_history_rocksdb_plugin::find_account_history_page(const account_name_type& name, uint64_t start, uint32_t limit,
+   uint64_t operationFilterLow, uint64_t operationFilterHigh, uint64_t cursorId,
    std::function<void(unsigned int, const rocksdb_operation_object&)> processor) const
 {
-   _my->find_account_history_data(name, start, limit, processor);
+   return _my->find_account_history_page(name, start, limit, op_type_mask_pair(operationFilterLow, operationFilterHigh),
+      cursorId, processor);
 }
 
 bool account_history_rocksdb_plugin::find_operation_object(size_t opId, rocksdb_operation_object* op) const
@@ -1505,6 +2942,12 @@ bool account_history_rocksdb_plugin::find_operation_object(size_t opId, rocksdb_
    return _my->find_operation_object(opId, op);
 }
 
+bool account_history_rocksdb_plugin::find_transaction_info(const protocol::transaction_id_type& trxId, uint32_t* blockNo,
+   uint32_t* txInBlock) const
+{
+   return _my->find_transaction_info(trxId, blockNo, txInBlock);
+}
+
 void account_history_rocksdb_plugin::find_operations_by_block(size_t blockNum,
    std::function<void(const rocksdb_operation_object&)> processor) const
 {
@@ -1517,7 +2960,15 @@ uint32_t account_history_rocksdb_plugin::enum_operations_from_block_range(uint32
    return _my->enumVirtualOperationsFromBlockRange(blockRangeBegin, blockRangeEnd, processor);
 }
 
+std::pair<uint32_t, uint64_t> account_history_rocksdb_plugin::find_operations_by_block_range(uint32_t blockRangeBegin,
+   uint32_t blockRangeEnd, uint64_t operationBegin, bool onlyVirtual, uint64_t operationFilterLow, uint64_t operationFilterHigh,
+   uint32_t limit, std::function<void(const rocksdb_operation_object&)> processor) const
+{
+   return _my->findOperationsByBlockRange(blockRangeBegin, blockRangeEnd, operationBegin, onlyVirtual,
+      op_type_mask_pair(operationFilterLow, operationFilterHigh), limit, processor);
+}
+
 } } }
 
 FC_REFLECT( blurt::plugins::account_history_rocksdb::account_history_info,
-   (id)(oldestEntryId)(newestEntryId)(oldestEntryTimestamp) )
+   (id)(oldestEntryId)(newestEntryId)(oldestEntryTimestamp)(newestChunkTypesLow)(newestChunkTypesHigh) )
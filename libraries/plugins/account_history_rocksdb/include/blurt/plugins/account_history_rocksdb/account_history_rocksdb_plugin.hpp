@@ -36,13 +36,40 @@ public:
    virtual void plugin_startup() override;
    virtual void plugin_shutdown() override;
 
-   void find_account_history_data(const protocol::account_name_type& name, uint64_t start, uint32_t limit,
+   /** Enumerates account history entries going back from `start`.
+    *  If any operation filter mask is nonzero, up to `limit` operations matching it are reported,
+    *  otherwise all entries in [start - limit, start] sequence range are reported.
+    *  Filtered enumeration examines a bounded number of entries. When it stops before finding `limit`
+    *  operations, it returns true and stores the sequence to continue from in `nextStart`.
+    */
+   bool find_account_history_data(const protocol::account_name_type& name, uint64_t start, uint32_t limit,
+      uint64_t operationFilterLow, uint64_t operationFilterHigh,
+      std::function<void(unsigned int, const rocksdb_operation_object&)> processor, uint64_t* nextStart) const;
+   /** Reads up to `limit` account history entries (matching operation filter masks, if nonzero), keeping
+    *  storage snapshot and iterator position in a cursor, so next pages are consistent and continue without
+    *  seeking again. Passing `cursorId` == 0 opens new cursor positioned at `start`, otherwise given cursor
+    *  is continued (`start` and filters are ignored then).
+    *  Returns id of the cursor to pass to the next call, or 0 if there are no more entries.
+    */
+   uint64_t find_account_history_page(const protocol::account_name_type& name, uint64_t start, uint32_t limit,
+      uint64_t operationFilterLow, uint64_t operationFilterHigh, uint64_t cursorId,
       std::function<void(unsigned int, const rocksdb_operation_object&)> processor) const;
    bool find_operation_object(size_t opId, rocksdb_operation_object* data) const;
+   bool find_transaction_info(const protocol::transaction_id_type& trxId, uint32_t* blockNo, uint32_t* txInBlock) const;
    void find_operations_by_block(size_t blockNum,
       std::function<void(const rocksdb_operation_object&)> processor) const;
    uint32_t enum_operations_from_block_range(uint32_t blockRangeBegin, uint32_t blockRangeEnd,
       std::function<void(const rocksdb_operation_object&)> processor) const;
+   /** Reports up to `limit` operations stored in [blockRangeBegin, blockRangeEnd) range, starting at `operationBegin`
+    *  position of `blockRangeBegin` block. All of them are read from single storage snapshot.
+    *  If any operation filter mask is nonzero, only operations matching it are reported.
+    *  Single call examines a bounded number of entries, so it can report less than `limit` operations
+    *  (even none) when most of them are skipped by `onlyVirtual` or filters.
+    *  Returns (block, operation position) pair to resume from, or (0, 0) if the range has been exhausted.
+    */
+   std::pair<uint32_t, uint64_t> find_operations_by_block_range(uint32_t blockRangeBegin, uint32_t blockRangeEnd,
+      uint64_t operationBegin, bool onlyVirtual, uint64_t operationFilterLow, uint64_t operationFilterHigh, uint32_t limit,
+      std::function<void(const rocksdb_operation_object&)> processor) const;
 
 private:
    class impl;
@@ -50,6 +77,7 @@ private:
    std::unique_ptr<impl> _my;
    uint32_t              _blockLimit = 0;
    bool                  _doImmediateImport = false;
+   uint32_t              _compressionReportSize = 0;
 };
 
 
@@ -3,10 +3,51 @@
 
 #include <blurt/plugins/account_history_rocksdb/account_history_rocksdb_plugin.hpp>
 
+/// Filtered get_account_history (chainbase) visits at most this many entries per requested operation...
+#define FILTERED_HISTORY_SCAN_FACTOR 10
+/// ...but no less than this many, so small pages can still skip over longer runs of other operations.
+#define FILTERED_HISTORY_MIN_SCAN 1000
+
 namespace blurt { namespace plugins { namespace account_history {
 
 namespace detail {
 
+/// Returns true if operation type is selected by `operation_filter_low`/`operation_filter_high` masks.
+inline bool is_selected_operation_type( uint32_t op_type, uint64_t filter_low, uint64_t filter_high )
+{
+   if( op_type < 64 )
+      return filter_low & ( uint64_t( 1 ) << op_type );
+   if( op_type < 128 )
+      return filter_high & ( uint64_t( 1 ) << ( op_type - 64 ) );
+   return false;
+}
+
+/** Builds api object of operation stored by account_history plugin. Operations stored as locators only
+ *  (with empty `serialized_op`, see `account-history-locators-only`) are read back from their blocks,
+ *  which are cached in `blocks`, so operations sharing a block need it to be read only once.
+ */
+api_operation_object load_api_operation( const chain::database& db, const chain::operation_object& op_obj,
+   std::map< uint32_t, protocol::signed_block >& blocks )
+{
+   if( !op_obj.serialized_op.empty() )
+      return api_operation_object( op_obj );
+
+   auto block_itr = blocks.find( op_obj.block );
+   if( block_itr == blocks.end() )
+   {
+      auto blk = db.fetch_block_by_number( op_obj.block );
+      FC_ASSERT( blk.valid(), "Missing block ${b} of stored operation", ("b",op_obj.block) );
+      block_itr = blocks.emplace( op_obj.block, std::move( *blk ) ).first;
+   }
+
+   const auto& transactions = block_itr->second.transactions;
+   FC_ASSERT( op_obj.trx_in_block < transactions.size() &&
+      op_obj.op_in_trx < transactions[ op_obj.trx_in_block ].operations.size(),
+      "Invalid location of operation stored in block ${b}", ("b",op_obj.block) );
+
+   return api_operation_object( op_obj, transactions[ op_obj.trx_in_block ].operations[ op_obj.op_in_trx ] );
+}
+
 class abstract_account_history_api_impl
 {
    public:
@@ -17,6 +58,7 @@ class abstract_account_history_api_impl
       virtual get_transaction_return get_transaction( const get_transaction_args& ) = 0;
       virtual get_account_history_return get_account_history( const get_account_history_args& ) = 0;
       virtual enum_virtual_ops_return enum_virtual_ops( const enum_virtual_ops_args& ) = 0;
+      virtual get_ops_in_block_range_return get_ops_in_block_range( const get_ops_in_block_range_args& ) = 0;
 
       chain::database& _db;
 };
@@ -31,6 +73,7 @@ class account_history_api_chainbase_impl : public abstract_account_history_api_i
       get_transaction_return get_transaction( const get_transaction_args& ) override;
       get_account_history_return get_account_history( const get_account_history_args& ) override;
       enum_virtual_ops_return enum_virtual_ops( const enum_virtual_ops_args& ) override;
+      get_ops_in_block_range_return get_ops_in_block_range( const get_ops_in_block_range_args& ) override;
 };
 
 DEFINE_API_IMPL( account_history_api_chainbase_impl, get_ops_in_block )
@@ -41,10 +84,18 @@ DEFINE_API_IMPL( account_history_api_chainbase_impl, get_ops_in_block )
       auto itr = idx.lower_bound( args.block_num );
 
       get_ops_in_block_return result;
+      std::map< uint32_t, protocol::signed_block > blocks;
 
       while( itr != idx.end() && itr->block == args.block_num )
       {
-         api_operation_object temp = *itr;
+         if( args.only_virtual && itr->serialized_op.empty() )
+         {
+            // Only non-virtual operations are stored as locators
+            ++itr;
+            continue;
+         }
+
+         api_operation_object temp = load_api_operation( _db, *itr, blocks );
          if( !args.only_virtual || is_virtual_operation( temp.op ) )
             result.ops.emplace( std::move( temp ) );
          ++itr;
@@ -87,16 +138,26 @@ DEFINE_API_IMPL( account_history_api_chainbase_impl, get_transaction )
 
 DEFINE_API_IMPL( account_history_api_chainbase_impl, get_account_history )
 {
+   const uint64_t filter_low = args.operation_filter_low.valid() ? *args.operation_filter_low : 0;
+   const uint64_t filter_high = args.operation_filter_high.valid() ? *args.operation_filter_high : 0;
+   const bool filtered = filter_low != 0 || filter_high != 0;
+
    FC_ASSERT( args.limit <= 10000, "limit of ${l} is greater than maxmimum allowed", ("l",args.limit) );
-   FC_ASSERT( args.start >= args.limit, "start must be greater than limit" );
+   FC_ASSERT( filtered || args.start >= args.limit, "start must be greater than limit" );
+   FC_ASSERT( !args.cursor.valid() && !args.open_cursor, "Cursors are supported only by account_history_rocksdb plugin" );
+
+   // Filtered request scans under read lock, so it must not walk whole history looking for rare operations
+   const uint64_t scan_budget = std::max< uint64_t >( uint64_t( args.limit ) * FILTERED_HISTORY_SCAN_FACTOR, FILTERED_HISTORY_MIN_SCAN );
 
    return _db.with_read_lock( [&]()
    {
       const auto& idx = _db.get_index< chain::account_history_index, chain::by_account >();
       auto itr = idx.lower_bound( boost::make_tuple( args.account, args.start ) );
       uint32_t n = 0;
+      uint64_t scanned = 0;
 
       get_account_history_return result;
+      std::map< uint32_t, protocol::signed_block > blocks;
       while( true )
       {
          if( itr == idx.end() )
@@ -105,9 +166,22 @@ DEFINE_API_IMPL( account_history_api_chainbase_impl, get_account_history )
             break;
          if( n >= args.limit )
             break;
-         result.history[ itr->sequence ] = _db.get( itr->op );
+         if( filtered && scanned >= scan_budget )
+         {
+            result.next_start = itr->sequence;
+            break;
+         }
+
+         const auto& op_obj = _db.get( itr->op );
+         // Stored type allows to skip operations without reading them back from their blocks
+         if( !filtered || is_selected_operation_type( op_obj.op_type, filter_low, filter_high ) )
+         {
+            result.history[ itr->sequence ] = load_api_operation( _db, op_obj, blocks );
+            ++n;
+         }
+
+         ++scanned;
          ++itr;
-         ++n;
       }
 
       return result;
@@ -119,6 +193,11 @@ DEFINE_API_IMPL( account_history_api_chainbase_impl, enum_virtual_ops )
    FC_ASSERT( false, "This API is not supported for account history backed by Chainbase" );
 }
 
+DEFINE_API_IMPL( account_history_api_chainbase_impl, get_ops_in_block_range )
+{
+   FC_ASSERT( false, "This API is not supported for account history backed by Chainbase" );
+}
+
 class account_history_api_rocksdb_impl : public abstract_account_history_api_impl
 {
    public:
@@ -130,6 +209,7 @@ class account_history_api_rocksdb_impl : public abstract_account_history_api_imp
       get_transaction_return get_transaction( const get_transaction_args& ) override;
       get_account_history_return get_account_history( const get_account_history_args& ) override;
       enum_virtual_ops_return enum_virtual_ops( const enum_virtual_ops_args& ) override;
+      get_ops_in_block_range_return get_ops_in_block_range( const get_ops_in_block_range_args& ) override;
 
       const account_history_rocksdb::account_history_rocksdb_plugin& _dataSource;
 };
@@ -150,23 +230,60 @@ DEFINE_API_IMPL( account_history_api_rocksdb_impl, get_ops_in_block )
 
 DEFINE_API_IMPL( account_history_api_rocksdb_impl, get_account_history )
 {
+   const uint64_t filter_low = args.operation_filter_low.valid() ? *args.operation_filter_low : 0;
+   const uint64_t filter_high = args.operation_filter_high.valid() ? *args.operation_filter_high : 0;
+   const bool filtered = filter_low != 0 || filter_high != 0;
+
    FC_ASSERT( args.limit <= 10000, "limit of ${l} is greater than maxmimum allowed", ("l",args.limit) );
-   FC_ASSERT( args.start >= args.limit, "start must be greater than limit" );
+   FC_ASSERT( filtered || args.cursor.valid() || args.start >= args.limit, "start must be greater than limit" );
 
    get_account_history_return result;
 
-   _dataSource.find_account_history_data(args.account, args.start, args.limit,
-      [&result](unsigned int sequence, const account_history_rocksdb::rocksdb_operation_object& op)
-      {
-         result.history[sequence] = api_operation_object( op );
-      });
+   auto processor = [&result](unsigned int sequence, const account_history_rocksdb::rocksdb_operation_object& op)
+   {
+      result.history[sequence] = api_operation_object( op );
+   };
+
+   if( args.cursor.valid() || args.open_cursor )
+   {
+      FC_ASSERT( !args.cursor.valid() || *args.cursor != 0, "Invalid cursor" );
+
+      uint64_t cursor = _dataSource.find_account_history_page(args.account, args.start, args.limit,
+         filter_low, filter_high, args.cursor.valid() ? *args.cursor : 0, processor);
+      if( cursor != 0 )
+         result.cursor = cursor;
+   }
+   else
+   {
+      uint64_t next_start = 0;
+      if( _dataSource.find_account_history_data( args.account, args.start, args.limit, filter_low, filter_high, processor, &next_start ) )
+         result.next_start = next_start;
+   }
 
    return result;
 }
 
 DEFINE_API_IMPL( account_history_api_rocksdb_impl, get_transaction )
 {
-   FC_ASSERT( false, "This API is not supported for account history backed by RocksDB" );
+   uint32_t blockNo = 0;
+   uint32_t txInBlock = 0;
+
+   bool found = _dataSource.find_transaction_info( args.id, &blockNo, &txInBlock );
+   FC_ASSERT( found, "Unknown Transaction ${t}", ("t",args.id) );
+
+   return _db.with_read_lock( [&]()
+   {
+      get_transaction_return result;
+
+      auto blk = _db.fetch_block_by_number( blockNo );
+      FC_ASSERT( blk.valid() );
+      FC_ASSERT( blk->transactions.size() > txInBlock );
+      result = blk->transactions[txInBlock];
+      result.block_num       = blockNo;
+      result.transaction_num = txInBlock;
+
+      return result;
+   });
 }
 
 DEFINE_API_IMPL( account_history_api_rocksdb_impl, enum_virtual_ops)
@@ -184,6 +301,31 @@ DEFINE_API_IMPL( account_history_api_rocksdb_impl, enum_virtual_ops)
    return result;
 }
 
+DEFINE_API_IMPL( account_history_api_rocksdb_impl, get_ops_in_block_range )
+{
+   FC_ASSERT( args.limit <= 10000, "limit of ${l} is greater than maxmimum allowed", ("l",args.limit) );
+   FC_ASSERT( args.block_range_end > args.block_range_begin, "Block range must be upward" );
+
+   get_ops_in_block_range_return result;
+   result.ops.reserve( args.limit );
+
+   auto next = _dataSource.find_operations_by_block_range( args.block_range_begin, args.block_range_end,
+      args.operation_begin, args.only_virtual,
+      args.operation_filter_low.valid() ? *args.operation_filter_low : 0,
+      args.operation_filter_high.valid() ? *args.operation_filter_high : 0,
+      args.limit,
+      [&result](const account_history_rocksdb::rocksdb_operation_object& op)
+      {
+         result.ops.emplace_back(api_operation_object(op));
+      }
+   );
+
+   result.next_block_range_begin = next.first;
+   result.next_operation_begin = next.second;
+
+   return result;
+}
+
 } // detail
 
 account_history_api::account_history_api()
@@ -208,6 +350,21 @@ account_history_api::account_history_api()
    }
 
    JSON_RPC_REGISTER_API( BLURT_ACCOUNT_HISTORY_API_PLUGIN_NAME );
+
+   // Operations of irreversible blocks never change. History may still be written asynchronously,
+   // so an empty result is not cached.
+   auto& json_rpc = appbase::app().get_plugin< json_rpc::json_rpc_plugin >();
+   json_rpc.add_api_cache_predicate( BLURT_ACCOUNT_HISTORY_API_PLUGIN_NAME, "get_ops_in_block",
+      []( const fc::variant& args, const fc::variant& result, uint32_t last_irreversible_block )
+      {
+         return args.as< get_ops_in_block_args >().block_num <= last_irreversible_block && result[ "ops" ].size() > 0;
+      } );
+   json_rpc.add_api_cache_predicate( BLURT_ACCOUNT_HISTORY_API_PLUGIN_NAME, "get_transaction",
+      []( const fc::variant&, const fc::variant& result, uint32_t last_irreversible_block )
+      {
+         uint32_t block_num = result[ "block_num" ].as< uint32_t >();
+         return block_num > 0 && block_num <= last_irreversible_block;
+      } );
 }
 
 account_history_api::~account_history_api() {}
@@ -217,6 +374,7 @@ DEFINE_LOCKLESS_APIS( account_history_api ,
    (get_transaction)
    (get_account_history)
    (enum_virtual_ops)
+   (get_ops_in_block_range)
 )
 
 } } } // blurt::plugins::account_history
@@ -29,6 +29,17 @@ struct api_operation_object
       op = fc::raw::unpack_from_buffer< blurt::protocol::operation >( op_obj.serialized_op );
    }
 
+   /// Used for operations stored as locators only, which payload was read back from block_log.
+   template< typename T >
+   api_operation_object( const T& op_obj, const blurt::protocol::operation& o ) :
+      trx_id( op_obj.trx_id ),
+      block( op_obj.block ),
+      trx_in_block( op_obj.trx_in_block ),
+      virtual_op( op_obj.virtual_op ),
+      timestamp( op_obj.timestamp ),
+      op( o )
+   {}
+
    blurt::protocol::transaction_id_type trx_id;
    uint32_t                               block = 0;
    uint32_t                               trx_in_block = 0;
@@ -64,16 +75,35 @@ struct get_transaction_args
 typedef blurt::protocol::annotated_signed_transaction get_transaction_return;
 
 
+/** Optional operation filters are bitmasks of operation types (`operation::which()`):
+ *  `operation_filter_low` covers types 0-63 and `operation_filter_high` covers types 64-127.
+ *  When any filter bit is set, up to `limit` matching operations (going back from `start`) are returned.
+ *  Without a cursor a filtered call examines a bounded number of entries; when it stops before finding
+ *  `limit` operations, `next_start` holds the sequence to pass as `start` to continue the search.
+ *  A filtered call accepts `start` lower than `limit`.
+ *
+ *  Setting `open_cursor` (account_history_rocksdb only) returns `cursor` id, when there are more entries to read.
+ *  Passing it back as `cursor` returns next page of `limit` entries from the same storage snapshot, continuing
+ *  where the previous page stopped (`start` and filters are ignored then). Unused cursors expire after
+ *  `account-history-rocksdb-cursor-ttl` seconds, or earlier, when `account-history-rocksdb-max-cursors` is reached
+ *  and they are the least recently used ones.
+ */
 struct get_account_history_args
 {
    blurt::protocol::account_name_type   account;
    uint64_t                               start = -1;
    uint32_t                               limit = 1000;
+   fc::optional< uint64_t >               operation_filter_low;
+   fc::optional< uint64_t >               operation_filter_high;
+   fc::optional< uint64_t >               cursor;
+   bool                                   open_cursor = false;
 };
 
 struct get_account_history_return
 {
    std::map< uint32_t, api_operation_object > history;
+   fc::optional< uint64_t >                   cursor;
+   fc::optional< uint64_t >                   next_start;
 };
 
 /** Allows to specify range of blocks to retrieve virtual operations for.
@@ -92,6 +122,35 @@ struct enum_virtual_ops_return
    uint32_t                     next_block_range_begin = 0;
 };
 
+/** Allows to export operations from a range of blocks in bounded chunks.
+ *  \param block_range_begin - starting block number (inclusive)
+ *  \param block_range_end   - last block number (exclusive)
+ *  \param operation_begin   - position within `block_range_begin` block to resume from, as returned by previous call
+ *  \param limit             - maximum number of operations returned by single call
+ *  Operation filters work like in get_account_history.
+ *  To continue, call again with `block_range_begin` = `next_block_range_begin` and `operation_begin` = `next_operation_begin`.
+ *  `next_block_range_begin` is 0 when the whole range has been returned.
+ *  A filtered (or `only_virtual`) call examines a bounded number of operations, so it can return less than `limit`
+ *  of them before the range is exhausted.
+ */
+struct get_ops_in_block_range_args
+{
+   uint32_t                 block_range_begin = 1;
+   uint32_t                 block_range_end = 2;
+   uint64_t                 operation_begin = 0;
+   bool                     only_virtual = false;
+   uint32_t                 limit = 1000;
+   fc::optional< uint64_t > operation_filter_low;
+   fc::optional< uint64_t > operation_filter_high;
+};
+
+struct get_ops_in_block_range_return
+{
+   vector<api_operation_object> ops;
+   uint32_t                     next_block_range_begin = 0;
+   uint64_t                     next_operation_begin = 0;
+};
+
 
 class account_history_api
 {
@@ -104,6 +163,7 @@ class account_history_api
          (get_transaction)
          (get_account_history)
          (enum_virtual_ops)
+         (get_ops_in_block_range)
       )
 
    private:
@@ -125,13 +185,19 @@ FC_REFLECT( blurt::plugins::account_history::get_transaction_args,
    (id) )
 
 FC_REFLECT( blurt::plugins::account_history::get_account_history_args,
-   (account)(start)(limit) )
+   (account)(start)(limit)(operation_filter_low)(operation_filter_high)(cursor)(open_cursor) )
 
 FC_REFLECT( blurt::plugins::account_history::get_account_history_return,
-   (history) )
+   (history)(cursor)(next_start) )
 
 FC_REFLECT( blurt::plugins::account_history::enum_virtual_ops_args,
    (block_range_begin)(block_range_end) )
 
 FC_REFLECT( blurt::plugins::account_history::enum_virtual_ops_return,
    (ops)(next_block_range_begin) )
+
+FC_REFLECT( blurt::plugins::account_history::get_ops_in_block_range_args,
+   (block_range_begin)(block_range_end)(operation_begin)(only_virtual)(limit)(operation_filter_low)(operation_filter_high) )
+
+FC_REFLECT( blurt::plugins::account_history::get_ops_in_block_range_return,
+   (ops)(next_block_range_begin)(next_operation_begin) )
@@ -17,6 +17,7 @@ class block_api_impl
       DECLARE_API_IMPL(
          (get_block_header)
          (get_block)
+         (get_block_range)
       )
 
       chain::database& _db;
@@ -32,6 +33,37 @@ block_api::block_api()
    : my( new block_api_impl() )
 {
    JSON_RPC_REGISTER_API( BLURT_BLOCK_API_PLUGIN_NAME );
+
+   // Blocks at or below the last irreversible block never change.
+   auto& json_rpc = appbase::app().get_plugin< json_rpc::json_rpc_plugin >();
+   json_rpc.add_api_cache_predicate( BLURT_BLOCK_API_PLUGIN_NAME, "get_block_header",
+      []( const fc::variant& args, const fc::variant&, uint32_t last_irreversible_block )
+      {
+         return args.as< get_block_header_args >().block_num <= last_irreversible_block;
+      } );
+   json_rpc.add_api_cache_predicate( BLURT_BLOCK_API_PLUGIN_NAME, "get_block",
+      []( const fc::variant& args, const fc::variant&, uint32_t last_irreversible_block )
+      {
+         return args.as< get_block_args >().block_num <= last_irreversible_block;
+      } );
+   json_rpc.add_api_cache_predicate( BLURT_BLOCK_API_PLUGIN_NAME, "get_block_range",
+      []( const fc::variant& args, const fc::variant&, uint32_t last_irreversible_block )
+      {
+         auto range = args.as< get_block_range_args >();
+         return uint64_t( range.starting_block_num ) + range.count <= uint64_t( last_irreversible_block ) + 1;
+      } );
+
+   // Block consumers such as indexers can skip the JSON round trip.
+   json_rpc.add_api_raw_method( BLURT_BLOCK_API_PLUGIN_NAME, "get_block",
+      [this]( const fc::variant& args )
+      {
+         return fc::raw::pack_to_vector( get_block( args.as< get_block_args >(), true ) );
+      } );
+   json_rpc.add_api_raw_method( BLURT_BLOCK_API_PLUGIN_NAME, "get_block_range",
+      [this]( const fc::variant& args )
+      {
+         return fc::raw::pack_to_vector( get_block_range( args.as< get_block_range_args >(), true ) );
+      } );
 }
 
 block_api::~block_api() {}
@@ -69,9 +101,30 @@ DEFINE_API_IMPL( block_api_impl, get_block )
    return result;
 }
 
+DEFINE_API_IMPL( block_api_impl, get_block_range )
+{
+   FC_ASSERT( args.starting_block_num > 0, "starting_block_num must be greater than 0" );
+   FC_ASSERT( args.count <= BLOCK_API_SINGLE_QUERY_LIMIT, "count cannot be greater than ${l}", ("l", BLOCK_API_SINGLE_QUERY_LIMIT) );
+
+   get_block_range_return result;
+   result.blocks.reserve( args.count );
+
+   for( uint64_t block_num = args.starting_block_num; block_num < uint64_t( args.starting_block_num ) + args.count; ++block_num )
+   {
+      auto block = _db.fetch_block_by_number( uint32_t( block_num ) );
+      if( !block )
+         break;
+
+      result.blocks.emplace_back( *block );
+   }
+
+   return result;
+}
+
 DEFINE_READ_APIS( block_api,
    (get_block_header)
    (get_block)
+   (get_block_range)
 )
 
 } } } // blurt::plugins::block_api
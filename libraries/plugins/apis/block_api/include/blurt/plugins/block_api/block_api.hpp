@@ -35,6 +35,14 @@ class block_api
          * @return the referenced block, or null if no matching block was found
          */
          (get_block)
+
+         /**
+         * @brief Retrieve a range of full, signed blocks
+         * @param starting_block_num Height of the first block to be returned
+         * @param count Maximum number of blocks to be returned
+         * @return the referenced blocks, ending before the first block which was not found
+         */
+         (get_block_range)
       )
 
    private:
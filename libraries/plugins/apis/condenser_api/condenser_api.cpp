@@ -1531,10 +1531,20 @@ namespace detail
 
    DEFINE_API_IMPL( condenser_api_impl, get_account_history )
    {
-      CHECK_ARG_SIZE( 3 )
+      FC_ASSERT( args.size() >= 3 && args.size() <= 5, "Expected 3-5 arguments, was ${n}", ("n", args.size()) );
       FC_ASSERT( _account_history_api, "account_history_api_plugin not enabled." );
 
-      auto history = _account_history_api->get_account_history( { args[0].as< account_name_type >(), args[1].as< uint64_t >(), args[2].as< uint32_t >() } ).history;
+      account_history::get_account_history_args a;
+      a.account = args[0].as< account_name_type >();
+      a.start = args[1].as< uint64_t >();
+      a.limit = args[2].as< uint32_t >();
+
+      if( args.size() > 3 )
+         a.operation_filter_low = args[3].as< uint64_t >();
+      if( args.size() > 4 )
+         a.operation_filter_high = args[4].as< uint64_t >();
+
+      auto history = _account_history_api->get_account_history( a ).history;
       get_account_history_return result;
 
       legacy_operation l_op;
@@ -1935,6 +1945,20 @@ condenser_api::condenser_api()
    : my( new detail::condenser_api_impl() )
 {
    JSON_RPC_REGISTER_API( BLURT_CONDENSER_API_PLUGIN_NAME );
+
+   // Irreversible blocks and their operations never change. Operations may still be written
+   // to account history asynchronously, so an empty result is not cached.
+   auto& json_rpc = appbase::app().get_plugin< json_rpc::json_rpc_plugin >();
+   json_rpc.add_api_cache_predicate( BLURT_CONDENSER_API_PLUGIN_NAME, "get_block",
+      []( const fc::variant& args, const fc::variant&, uint32_t last_irreversible_block )
+      {
+         return args.size() == 1 && args[ size_t( 0 ) ].as< uint32_t >() <= last_irreversible_block;
+      } );
+   json_rpc.add_api_cache_predicate( BLURT_CONDENSER_API_PLUGIN_NAME, "get_ops_in_block",
+      []( const fc::variant& args, const fc::variant& result, uint32_t last_irreversible_block )
+      {
+         return args.size() == 2 && args[ size_t( 0 ) ].as< uint32_t >() <= last_irreversible_block && result.size() > 0;
+      } );
 }
 
 condenser_api::~condenser_api() {}
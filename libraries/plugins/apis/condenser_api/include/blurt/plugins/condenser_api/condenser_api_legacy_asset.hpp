@@ -55,3 +55,4 @@ FC_REFLECT( blurt::plugins::condenser_api::legacy_asset,
    (amount)
    (symbol)
    )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::plugins::condenser_api::legacy_asset )
@@ -25,6 +25,7 @@ class database_api_impl
       (
          (get_config)
          (get_version)
+         (get_database_statistics)
          (get_dynamic_global_properties)
          (get_witness_schedule)
          (get_hardfork_properties)
@@ -157,6 +158,35 @@ DEFINE_API_IMPL( database_api_impl, get_version )
    );
 }
 
+DEFINE_API_IMPL( database_api_impl, get_database_statistics )
+{
+   get_database_statistics_return result;
+
+   for( auto& index_stats : _db.get_rocksdb_statistics() )
+   {
+      api_index_statistics stats;
+      stats.index = index_stats.first;
+      stats.counters = std::move( index_stats.second );
+
+      auto counter = [&]( const string& name ) -> uint64_t
+      {
+         auto itr = stats.counters.find( name );
+         return itr != stats.counters.end() ? itr->second : 0;
+      };
+
+      uint64_t cache_lookups = counter( "block_cache_hit" ) + counter( "block_cache_miss" );
+      if( cache_lookups > 0 )
+         stats.block_cache_hit_rate = double( counter( "block_cache_hit" ) ) / cache_lookups;
+
+      if( counter( "keys_read" ) > 0 )
+         stats.read_amplification = double( counter( "sst_reads" ) ) / counter( "keys_read" );
+
+      result.indices.push_back( std::move( stats ) );
+   }
+
+   return result;
+}
+
 DEFINE_API_IMPL( database_api_impl, get_dynamic_global_properties )
 {
    return _db.get_dynamic_global_properties();
@@ -1514,6 +1544,7 @@ DEFINE_API_IMPL( database_api_impl, verify_signatures )
 DEFINE_LOCKLESS_APIS( database_api, (get_config)(get_version) )
 
 DEFINE_READ_APIS( database_api,
+   (get_database_statistics)
    (get_dynamic_global_properties)
    (get_witness_schedule)
    (get_hardfork_properties)
@@ -33,6 +33,11 @@ class database_api
           */
          (get_version)
 
+         /**
+          * @brief Return RocksDB statistics for each MIRA index (empty without MIRA)
+          */
+         (get_database_statistics)
+
          /**
          * @brief Retrieve the current @ref dynamic_global_property_object
          */
@@ -91,6 +91,24 @@ struct get_version_return
    chain_id_type  chain_id;
 };
 
+/* get_database_statistics */
+typedef void_type          get_database_statistics_args;
+
+struct api_index_statistics
+{
+   string                              index;
+   /// Ratio of block cache hits to total block cache lookups
+   double                              block_cache_hit_rate = 0;
+   /// Data blocks read from SST files per key read
+   double                              read_amplification = 0;
+   std::map< string, uint64_t >        counters;
+};
+
+struct get_database_statistics_return
+{
+   vector< api_index_statistics >      indices;
+};
+
 
 /* Singletons */
 
@@ -510,6 +528,12 @@ struct verify_signatures_return
 FC_REFLECT( blurt::plugins::database_api::get_version_return,
             (blockchain_version)(blurt_revision)(fc_revision)(chain_id) )
 
+FC_REFLECT( blurt::plugins::database_api::api_index_statistics,
+            (index)(block_cache_hit_rate)(read_amplification)(counters) )
+
+FC_REFLECT( blurt::plugins::database_api::get_database_statistics_return,
+            (indices) )
+
 FC_REFLECT_ENUM( blurt::plugins::database_api::sort_order_type,
    (by_name)
    (by_proxy)
@@ -1,4 +1,5 @@
 #include <blurt/chain/database_exceptions.hpp>
+#include <blurt/chain/util/signal.hpp>
 
 #include <blurt/plugins/chain/abstract_block_producer.hpp>
 #include <blurt/plugins/chain/chain_plugin.hpp>
@@ -70,6 +71,9 @@ class chain_plugin_impl
       void start_write_processing();
       void stop_write_processing();
       void write_default_database_config( bfs::path& p );
+#ifdef ENABLE_MIRA
+      void publish_rocksdb_statistics();
+#endif
 
       uint64_t                         shared_memory_size = 0;
       uint16_t                         shared_file_full_threshold = 0;
@@ -102,6 +106,8 @@ class chain_plugin_impl
       vector< string >                 loaded_plugins;
       fc::mutable_variant_object       plugin_state_opts;
       bfs::path                        database_cfg;
+      uint32_t                         rocksdb_stats_interval = 0;
+      boost::signals2::connection      post_apply_block_conn;
 
       database  db;
       std::string block_generator_registrant;
@@ -304,6 +310,27 @@ void chain_plugin_impl::write_default_database_config( bfs::path &p )
    fc::json::save_to_file( blurt::utilities::default_database_configuration(), p );
 }
 
+#ifdef ENABLE_MIRA
+void chain_plugin_impl::publish_rocksdb_statistics()
+{
+   if( !blurt::plugins::statsd::util::statsd_enabled() )
+      return;
+
+   for( const auto& index_stats : db.get_rocksdb_statistics() )
+   {
+      // Statsd keys are dot separated, strip the namespace from the index type name
+      std::vector< std::string > split_v;
+      boost::split( split_v, index_stats.first, boost::is_any_of( ":" ) );
+      const auto& index_name = *(split_v.rbegin());
+
+      for( const auto& stat : index_stats.second )
+      {
+         STATSD_GAUGE( "mira", index_name, stat.first, stat.second, 1.0f )
+      }
+   }
+}
+#endif
+
 } // detail
 
 
@@ -334,6 +361,7 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
             "flush shared memory changes to disk every N blocks")
 #ifdef ENABLE_MIRA
          ("memory-replay-indices", bpo::value<vector<string>>()->multitoken()->composing(), "Specify which indices should be in memory during replay")
+         ("rocksdb-stats-interval", bpo::value<uint32_t>()->default_value(0), "Publish RocksDB statistics of every index to statsd each N blocks (0 to disable)")
 #endif
          ("spam-accounts", bpo::value<vector<string>>()->composing(), "Defines a list of accounts which will be explicitly ignored in account history storage and post content. Eg., spam-accounts = account1 account2")
          ;
@@ -441,6 +469,7 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
    }
 
    my->replay_in_memory = options.at( "memory-replay" ).as< bool >();
+   my->rocksdb_stats_interval = options.at( "rocksdb-stats-interval" ).as< uint32_t >();
    if ( options.count( "memory-replay-indices" ) )
    {
       std::vector<std::string> indices = options.at( "memory-replay-indices" ).as< vector< string > >();
@@ -631,6 +660,18 @@ void chain_plugin::plugin_startup()
    }
 
    ilog( "Started on blockchain with ${n} blocks", ("n", my->db.head_block_num()) );
+
+#ifdef ENABLE_MIRA
+   if( my->rocksdb_stats_interval > 0 )
+   {
+      my->post_apply_block_conn = my->db.add_post_apply_block_handler( [&]( const block_notification& note )
+      {
+         if( note.block_num % my->rocksdb_stats_interval == 0 )
+            my->publish_rocksdb_statistics();
+      }, *this, 0 );
+   }
+#endif
+
    on_sync();
 
    my->start_write_processing();
@@ -639,6 +680,7 @@ void chain_plugin::plugin_startup()
 void chain_plugin::plugin_shutdown()
 {
    ilog("closing chain database");
+   chain::util::disconnect_signal( my->post_apply_block_conn );
    my->stop_write_processing();
    my->db.close();
    ilog("database closed successfully");
@@ -0,0 +1,94 @@
+#include <blurt/plugins/json_rpc/admission_control.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+/// Cost of methods without a configured cost.
+#define DEFAULT_METHOD_COST 1
+
+/// Idle clients are forgotten once at least this many clients are tracked.
+#define MIN_PRUNE_SIZE 1024
+
+namespace blurt { namespace plugins { namespace json_rpc {
+
+admission_control::admission_control( uint32_t rate, uint32_t burst )
+   : _rate( rate ), _burst( std::max( burst, 1u ) ), _next_prune_size( MIN_PRUNE_SIZE )
+{
+   FC_ASSERT( rate > 0, "Admission control rate must be greater than 0" );
+}
+
+void admission_control::set_method_cost( const std::string& method, uint32_t cost )
+{
+   _method_costs[ method ] = cost;
+}
+
+uint32_t admission_control::method_cost( const std::string& method )const
+{
+   auto itr = _method_costs.find( method );
+   return itr != _method_costs.end() ? itr->second : DEFAULT_METHOD_COST;
+}
+
+bool admission_control::admit( const std::string& client, uint32_t cost, const fc::time_point& now, fc::microseconds& retry_after )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   auto itr = _buckets.find( client );
+   if( itr == _buckets.end() )
+   {
+      if( _buckets.size() >= _next_prune_size )
+         prune( now );
+
+      bucket b;
+      b.tokens = _burst;
+      b.updated = now;
+      itr = _buckets.emplace( client, b ).first;
+   }
+
+   bucket& b = itr->second;
+   refill( b, now );
+
+   if( b.tokens <= 0 )
+   {
+      retry_after = fc::microseconds( static_cast< int64_t >( std::ceil( ( 1 - b.tokens ) * 1000000 / _rate ) ) );
+      return false;
+   }
+
+   b.tokens -= cost;
+   return true;
+}
+
+size_t admission_control::client_count()const
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+   return _buckets.size();
+}
+
+void admission_control::refill( bucket& b, const fc::time_point& now )const
+{
+   if( now > b.updated )
+   {
+      b.tokens = std::min( _burst, b.tokens + ( now - b.updated ).count() * _rate / 1000000 );
+      b.updated = now;
+   }
+}
+
+void admission_control::prune( const fc::time_point& now )
+{
+   // A full bucket is the same as no bucket, so those clients can be forgotten.
+   for( auto itr = _buckets.begin(); itr != _buckets.end(); )
+   {
+      refill( itr->second, now );
+
+      if( itr->second.tokens >= _burst )
+         itr = _buckets.erase( itr );
+      else
+         ++itr;
+   }
+
+   // Pruning again only after the map doubles keeps the cost per call constant.
+   _next_prune_size = std::max< size_t >( MIN_PRUNE_SIZE, _buckets.size() * 2 );
+}
+
+} } } // blurt::plugins::json_rpc
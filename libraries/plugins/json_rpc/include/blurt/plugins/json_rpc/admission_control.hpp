@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fc/time.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace blurt { namespace plugins { namespace json_rpc {
+
+/**
+ * Limits the work each client can request from the API.
+ *
+ * Every client (usually an IP address) has a token bucket which refills at `rate` tokens
+ * per second, up to `burst` tokens. Each call is charged the configured cost of its method.
+ * A call is admitted while the bucket is not empty and may drive it into debt, so
+ * expensive methods are never locked out, but the client has to wait longer afterwards.
+ */
+class admission_control
+{
+   public:
+      admission_control( uint32_t rate, uint32_t burst );
+
+      void set_method_cost( const std::string& method, uint32_t cost );
+      uint32_t method_cost( const std::string& method )const;
+
+      /**
+       * Charges `client` for a call costing `cost` tokens. A cost of 0 only checks that
+       * the client has any budget left.
+       *
+       * Returns false when the call is refused. `retry_after` is then set to the time
+       * until the bucket is no longer empty.
+       */
+      bool admit( const std::string& client, uint32_t cost, const fc::time_point& now, fc::microseconds& retry_after );
+
+      /// Number of clients currently tracked.
+      size_t client_count()const;
+
+   private:
+      struct bucket
+      {
+         double         tokens = 0;
+         fc::time_point updated;
+      };
+
+      void refill( bucket& b, const fc::time_point& now )const;
+      void prune( const fc::time_point& now );
+
+      const double                              _rate;
+      const double                              _burst;
+      std::map< std::string, uint32_t >         _method_costs;
+
+      mutable std::mutex                        _mutex;
+      std::unordered_map< std::string, bucket > _buckets;
+      size_t                                    _next_prune_size;
+};
+
+} } } // blurt::plugins::json_rpc
@@ -4,6 +4,8 @@
 
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_writer.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
 
@@ -52,6 +54,8 @@
 #define JSON_RPC_NO_PARAMS          (-32001)
 #define JSON_RPC_PARSE_PARAMS_ERROR (-32002)
 #define JSON_RPC_ERROR_DURING_CALL  (-32003)
+#define JSON_RPC_RATE_LIMITED       (-32004)
+#define JSON_RPC_SERVER_BUSY        (-32005)
 
 namespace blurt { namespace plugins { namespace json_rpc {
 
@@ -65,6 +69,18 @@ using namespace appbase;
  */
 typedef std::function< fc::variant(const fc::variant&) > api_method;
 
+/**
+ * @brief Same as api_method, but writes the result straight to JSON,
+ * without converting it to fc::variant first.
+ */
+typedef std::function< std::string(const fc::variant&) > api_json_method;
+
+/**
+ * @brief Same as api_method, but returns the result packed with fc::raw.
+ * Used by the binary protocol, see json_rpc_plugin::call_raw.
+ */
+typedef std::function< std::vector< char >(const fc::variant&) > api_raw_method;
+
 /**
  * @brief An API, containing APIs and Methods
  *
@@ -74,12 +90,48 @@ typedef std::function< fc::variant(const fc::variant&) > api_method;
  */
 typedef std::map< string, api_method > api_description;
 
+/**
+ * @brief Runs given task asynchronously (i.e. on a worker thread pool).
+ *
+ * Used to process elements of a batch request in parallel.
+ */
+typedef std::function< void( std::function< void() > ) > batch_task_dispatcher;
+
+/**
+ * @brief Decides whether the result of an API method call is immutable,
+ * so it can be served from the response cache.
+ *
+ * Arguments: method arguments, method result and the last irreversible block number
+ * known before the method was called.
+ */
+typedef std::function< bool( const fc::variant&, const fc::variant&, uint32_t ) > api_cache_predicate;
+
+/**
+ * Adds time spent writing a result to JSON to the API call running on this thread.
+ * Used by json_rpc_plugin for its per-method latency stats.
+ */
+void record_serialize_time( const fc::microseconds& time );
+
 struct api_method_signature
 {
    fc::variant args;
    fc::variant ret;
 };
 
+/**
+ * Response of a binary protocol call, packed with fc::raw. Requests are still JSON-RPC,
+ * only results are binary, so `id` and `error` hold JSON text.
+ */
+struct raw_rpc_response
+{
+   /// JSON of the request id.
+   string                  id;
+   /// JSON of the error object, set when the call failed.
+   fc::optional< string >  error;
+   /// fc::raw packed return type of the method, empty on error.
+   std::vector< char >     result;
+};
+
 namespace detail
 {
    class json_rpc_plugin_impl;
@@ -101,7 +153,54 @@ class json_rpc_plugin : public appbase::plugin< json_rpc_plugin >
       virtual void plugin_shutdown() override;
 
       void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
+      void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_json_method& json_api, const api_method_signature& sig );
+
+      /**
+       * Marks results of a method as cacheable. A result is cached only when `predicate`
+       * proves it can never change. Only irreversible data should pass the predicate.
+       */
+      void add_api_cache_predicate( const string& api_name, const string& method_name, const api_cache_predicate& predicate );
+
+      /**
+       * Allows calling a method with call_raw. Only methods with a stable fc::raw layout,
+       * such as those returning blocks, should be exposed this way.
+       */
+      void add_api_raw_method( const string& api_name, const string& method_name, const api_raw_method& raw_api );
+
+      /// Updates the last irreversible block number passed to cache predicates. Called by the chain's irreversible block signal.
+      void notify_irreversible_block( uint32_t block_num );
+
+      /**
+       * Charges `client` for a call of `method` answered outside of json_rpc (e.g. websocket subscriptions),
+       * so it counts against the same per-client budget as API calls. Returns false when the call is refused,
+       * `retry_after` is then set to the time until the client has budget again.
+       * Calls without a client, or with rate limiting disabled, are always admitted.
+       */
+      bool admit( const string& client, const string& method, fc::microseconds& retry_after );
+
       string call( const string& body );
+      /**
+       * Same as above, but elements of a batch request can be processed in parallel,
+       * by tasks passed to `dispatcher`. The calling thread takes part in processing too,
+       * so it never waits for a task which has not been started. Batches containing a
+       * broadcast method are processed serially, in request order.
+       *
+       * `received` is when the request arrived, if known. Time until this call counts as
+       * queue wait in the latency stats.
+       *
+       * `client` identifies the sender (e.g. its IP address) for per-client rate limiting.
+       * Calls without a client are never rate limited.
+       */
+      string call( const string& body, const batch_task_dispatcher& dispatcher, const fc::time_point& received = fc::time_point(),
+         const string& client = string() );
+
+      /**
+       * Same as above, but results are packed with fc::raw for high-volume consumers.
+       * Returns a packed raw_rpc_response, or a packed vector of them for batch requests.
+       * Methods not added with add_api_raw_method fail with an error.
+       */
+      std::vector< char > call_raw( const string& body, const batch_task_dispatcher& dispatcher,
+         const fc::time_point& received = fc::time_point(), const string& client = string() );
 
    private:
       std::unique_ptr< detail::json_rpc_plugin_impl > my;
@@ -130,6 +229,15 @@ namespace detail {
                {
                   return fc::variant( (plugin.*method)( args.as< Args >(), true ) );
                },
+               [&plugin,method]( const fc::variant& args ) -> std::string
+               {
+                  auto result = (plugin.*method)( args.as< Args >(), true );
+
+                  fc::time_point start = fc::time_point::now();
+                  std::string json = fc::json_writer::to_string( result );
+                  record_serialize_time( fc::time_point::now() - start );
+                  return json;
+               },
                api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) } );
          }
 
@@ -143,3 +251,4 @@ namespace detail {
 } } } // blurt::plugins::json_rpc
 
 FC_REFLECT( blurt::plugins::json_rpc::api_method_signature, (args)(ret) )
+FC_REFLECT( blurt::plugins::json_rpc::raw_rpc_response, (id)(error)(result) )
@@ -4,6 +4,7 @@
 
 #include <fc/reflect/reflect.hpp>
 #include <fc/macros.hpp>
+#include <fc/time.hpp>
 
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/cat.hpp>
@@ -47,7 +48,12 @@ BOOST_PP_CAT( method, _return ) class :: method ( const BOOST_PP_CAT( method, _a
 {                                                                                                        \
    if( lock )                                                                                            \
    {                                                                                                     \
-      return my->_db.with_read_lock( [&args, this](){ return my->method( args ); });                     \
+      fc::time_point lock_start = fc::time_point::now();                                                 \
+      return my->_db.with_read_lock( [&args, &lock_start, this]()                                        \
+      {                                                                                                  \
+         blurt::plugins::json_rpc::record_lock_wait( fc::time_point::now() - lock_start );               \
+         return my->method( args );                                                                      \
+      });                                                                                                \
    }                                                                                                     \
    else                                                                                                  \
    {                                                                                                     \
@@ -60,7 +66,12 @@ BOOST_PP_CAT( method, _return ) class :: method ( const BOOST_PP_CAT( method, _a
 {                                                                                                        \
    if( lock )                                                                                            \
    {                                                                                                     \
-      return my->_db.with_write_lock( [&args, this](){ return my->method( args ); });                    \
+      fc::time_point lock_start = fc::time_point::now();                                                 \
+      return my->_db.with_write_lock( [&args, &lock_start, this]()                                       \
+      {                                                                                                  \
+         blurt::plugins::json_rpc::record_lock_wait( fc::time_point::now() - lock_start );               \
+         return my->method( args );                                                                      \
+      });                                                                                                \
    }                                                                                                     \
    else                                                                                                  \
    {                                                                                                     \
@@ -88,6 +99,12 @@ namespace blurt { namespace plugins { namespace json_rpc {
 
 struct void_type {};
 
+/**
+ * Adds time spent waiting for the database lock to the API call running on this thread.
+ * Used by json_rpc_plugin for its per-method latency stats.
+ */
+void record_lock_wait( const fc::microseconds& wait );
+
 } } } // blurt::plugins::json_rpc
 
 FC_REFLECT( blurt::plugins::json_rpc::void_type, )
@@ -1,9 +1,14 @@
 #include <blurt/plugins/json_rpc/json_rpc_plugin.hpp>
 #include <blurt/plugins/json_rpc/utility.hpp>
+#include <blurt/plugins/json_rpc/admission_control.hpp>
 
+#include <blurt/plugins/chain/chain_plugin.hpp>
 #include <blurt/plugins/statsd/utility.hpp>
 
+#include <blurt/chain/util/signal.hpp>
+
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <fc/log/logger_config.hpp>
 #include <fc/exception/exception.hpp>
@@ -12,8 +17,33 @@
 
 #include <chainbase/chainbase.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 #define ENABLE_JSON_RPC_LOG
 
+/// Default maximum number of elements of a batch request processed in parallel.
+#define DEFAULT_BATCH_CONCURRENCY 8
+
+/// Default size limits of the response cache, in bytes.
+#define DEFAULT_CACHE_SIZE           (64*1024*1024)
+#define DEFAULT_CACHE_MAX_ENTRY_SIZE (1024*1024)
+
+/// Default duration in milliseconds above which calls are written to the slow query log.
+#define DEFAULT_SLOW_QUERY_THRESHOLD 1000
+
+/// Parameters longer than this are truncated in the slow query log.
+#define SLOW_QUERY_MAX_PARAMS_SIZE 256
+
+/// Default number of tokens a client can spend at once when rate limiting is enabled.
+#define DEFAULT_CLIENT_BURST 100
+
 namespace blurt { namespace plugins { namespace json_rpc {
 
 namespace detail
@@ -37,8 +67,306 @@ namespace detail
       fc::optional< fc::variant >      result;
       fc::optional< json_rpc_error >   error;
       fc::variant                      id;
+
+      /// Already serialized result, used instead of `result` when set. Not reflected.
+      std::shared_ptr< const std::string > result_json;
+      /// fc::raw packed result of a binary protocol call. Not reflected.
+      fc::optional< std::vector< char > >  result_raw;
+   };
+
+   /// State shared by all requests of a call.
+   struct call_context
+   {
+      /// Sender of the call for rate limiting, empty when not limited.
+      string   client;
+      /// Results are fc::raw packed instead of written as JSON.
+      bool     raw = false;
+   };
+
+   string to_json( const json_rpc_response& response )
+   {
+      if( !response.result_json )
+         return fc::json::to_string( response );
+
+      // Same layout as the reflected response, with the serialized result spliced in.
+      string json = "{\"jsonrpc\":" + fc::json::to_string( response.jsonrpc ) + ",\"result\":";
+      json += *response.result_json;
+      json += ",\"id\":" + fc::json::to_string( response.id ) + "}";
+      return json;
+   }
+
+   raw_rpc_response to_raw( json_rpc_response& response )
+   {
+      raw_rpc_response raw;
+      raw.id = fc::json::to_string( response.id );
+
+      if( response.error )
+         raw.error = fc::json::to_string( *response.error );
+      else if( response.result_raw )
+         raw.result = std::move( *response.result_raw );
+
+      return raw;
+   }
+
+   string to_json( const vector< json_rpc_response >& responses )
+   {
+      string json = "[";
+
+      for( size_t i = 0; i < responses.size(); ++i )
+      {
+         if( i )
+            json += ',';
+         json += to_json( responses[ i ] );
+      }
+
+      json += ']';
+      return json;
+   }
+
+   /// Returns a copy of `v` with keys of all objects sorted, so equal params map to the same cache key.
+   fc::variant canonicalize( const fc::variant& v )
+   {
+      if( v.is_object() )
+      {
+         const auto& obj = v.get_object();
+         vector< const fc::variant_object::entry* > entries;
+         entries.reserve( obj.size() );
+
+         for( const auto& e : obj )
+            entries.push_back( &e );
+
+         std::sort( entries.begin(), entries.end(),
+            []( const fc::variant_object::entry* a, const fc::variant_object::entry* b ) { return a->key() < b->key(); } );
+
+         fc::mutable_variant_object result;
+         for( const auto* e : entries )
+            result( e->key(), canonicalize( e->value() ) );
+
+         return fc::variant( std::move( result ) );
+      }
+      else if( v.is_array() )
+      {
+         const auto& arr = v.get_array();
+         fc::variants result;
+         result.reserve( arr.size() );
+
+         for( const auto& e : arr )
+            result.push_back( canonicalize( e ) );
+
+         return fc::variant( std::move( result ) );
+      }
+
+      return v;
+   }
+
+   /**
+    * Holds serialized results of immutable API calls, keyed by method name and canonical params.
+    * The least recently used entries are evicted when the size limit is reached.
+    */
+   class json_rpc_response_cache
+   {
+   public:
+      typedef std::shared_ptr< const std::string > entry_type;
+
+      json_rpc_response_cache( uint64_t max_size, uint64_t max_entry_size )
+         : _max_size( max_size ), _max_entry_size( max_entry_size ) {}
+
+      entry_type get( const std::string& key )
+      {
+         std::lock_guard< std::mutex > guard( _mutex );
+
+         auto itr = _entries.find( key );
+         if( itr == _entries.end() )
+         {
+            ++_misses;
+            return entry_type();
+         }
+
+         ++_hits;
+         _lru.splice( _lru.begin(), _lru, itr->second );
+         return itr->second->second;
+      }
+
+      /// Returns false when the entry is too big to be admitted.
+      bool put( const std::string& key, const entry_type& value )
+      {
+         uint64_t entry_size = key.size() + value->size();
+         if( entry_size > _max_entry_size || entry_size > _max_size )
+            return false;
+
+         std::lock_guard< std::mutex > guard( _mutex );
+
+         if( _entries.find( key ) != _entries.end() )
+            return true; // Added by a concurrent call. The results are identical.
+
+         while( _size + entry_size > _max_size )
+         {
+            const auto& oldest = _lru.back();
+            _size -= oldest.first.size() + oldest.second->size();
+            _entries.erase( oldest.first );
+            _lru.pop_back();
+            ++_evictions;
+         }
+
+         _lru.emplace_front( key, value );
+         _entries[ key ] = _lru.begin();
+         _size += entry_size;
+
+         STATSD_GAUGE( "jsonrpc", "cache", "size", _size, 1.0f );
+         return true;
+      }
+
+      void log_stats()
+      {
+         std::lock_guard< std::mutex > guard( _mutex );
+         uint64_t requests = _hits + _misses;
+
+         ilog( "JSON-RPC response cache: ${h} hits, ${m} misses (${r}% hit rate), ${e} evictions, ${n} entries using ${s} bytes",
+            ("h", _hits)("m", _misses)("r", requests ? _hits * 100 / requests : 0)("e", _evictions)("n", _entries.size())("s", _size) );
+      }
+
+   private:
+      typedef std::list< std::pair< std::string, entry_type > > lru_list;
+
+      uint64_t                                                 _max_size;
+      uint64_t                                                 _max_entry_size;
+      uint64_t                                                 _size = 0;
+      uint64_t                                                 _hits = 0;
+      uint64_t                                                 _misses = 0;
+      uint64_t                                                 _evictions = 0;
+      lru_list                                                 _lru;
+      std::unordered_map< std::string, lru_list::iterator >    _entries;
+      std::mutex                                               _mutex;
+   };
+
+   enum call_phase
+   {
+      queue_phase,
+      parse_phase,
+      lock_phase,
+      execute_phase,
+      serialize_phase,
+      total_phase,
+      call_phase_count
    };
 
+   const char* const call_phase_names[ call_phase_count ] = { "queue", "parse", "lock", "execute", "serialize", "total" };
+
+   /// Time spent in each phase of a single API call.
+   typedef std::array< fc::microseconds, call_phase_count > call_timing;
+
+   /// Timing of the API call running on this thread, filled in by record_lock_wait() and record_serialize_time().
+   thread_local call_timing* current_call_timing = nullptr;
+
+   struct latency_summary
+   {
+      uint64_t count = 0;
+      uint64_t mean = 0;
+      uint64_t p50 = 0;
+      uint64_t p90 = 0;
+      uint64_t p99 = 0;
+      uint64_t p999 = 0;
+      uint64_t max = 0;
+   };
+
+   /**
+    * Log-linear histogram of durations in microseconds, in the style of HdrHistogram.
+    * Values below 16 have their own bucket, larger values are split into 8 buckets per
+    * power of two, so reported percentiles are within 12.5% of the recorded values.
+    * Buckets are atomic, recording never blocks.
+    */
+   class latency_histogram
+   {
+   public:
+      latency_histogram()
+      {
+         for( auto& bucket : _buckets )
+            bucket = 0;
+      }
+
+      void record( uint64_t value )
+      {
+         ++_buckets[ bucket_index( value ) ];
+         ++_count;
+         _sum += value;
+
+         uint64_t max = _max.load();
+         while( max < value && !_max.compare_exchange_weak( max, value ) );
+      }
+
+      latency_summary summary()const
+      {
+         latency_summary result;
+         result.count = _count.load();
+         if( result.count == 0 )
+            return result;
+
+         result.mean = _sum.load() / result.count;
+         result.max = _max.load();
+         result.p50 = percentile( 0.5, result.count, result.max );
+         result.p90 = percentile( 0.9, result.count, result.max );
+         result.p99 = percentile( 0.99, result.count, result.max );
+         result.p999 = percentile( 0.999, result.count, result.max );
+         return result;
+      }
+
+   private:
+      static const uint32_t linear_buckets = 16;
+      static const uint32_t sub_buckets = 8;
+      /// Values of 2^(max_msb+1) and above, over a day, share the last bucket.
+      static const uint32_t max_msb = 36;
+      static const uint32_t bucket_count = linear_buckets + ( max_msb - 3 ) * sub_buckets;
+
+      static uint32_t bucket_index( uint64_t value )
+      {
+         if( value < linear_buckets )
+            return uint32_t( value );
+
+         if( value >> ( max_msb + 1 ) )
+            return bucket_count - 1;
+
+         uint32_t msb = 4;
+         while( value >> ( msb + 1 ) )
+            ++msb;
+
+         return linear_buckets + ( msb - 4 ) * sub_buckets + uint32_t( ( value >> ( msb - 3 ) ) & ( sub_buckets - 1 ) );
+      }
+
+      /// Highest value that falls into the bucket.
+      static uint64_t bucket_max( uint32_t index )
+      {
+         if( index < linear_buckets )
+            return index;
+
+         uint32_t msb = 4 + ( index - linear_buckets ) / sub_buckets;
+         uint64_t sub = ( index - linear_buckets ) % sub_buckets;
+         uint64_t width = uint64_t( 1 ) << ( msb - 3 );
+         return ( sub_buckets + sub ) * width + width - 1;
+      }
+
+      uint64_t percentile( double p, uint64_t count, uint64_t max )const
+      {
+         uint64_t target = std::max< uint64_t >( 1, uint64_t( std::ceil( p * count ) ) );
+         uint64_t seen = 0;
+
+         for( uint32_t i = 0; i < bucket_count; ++i )
+         {
+            seen += _buckets[ i ].load();
+            if( seen >= target )
+               return std::min( bucket_max( i ), max );
+         }
+
+         return max;
+      }
+
+      std::array< std::atomic< uint64_t >, bucket_count > _buckets;
+      std::atomic< uint64_t >                              _count{ 0 };
+      std::atomic< uint64_t >                              _sum{ 0 };
+      std::atomic< uint64_t >                              _max{ 0 };
+   };
+
+   typedef std::array< latency_histogram, call_phase_count > method_latency_stats;
+
    typedef void_type             get_methods_args;
    typedef vector< string >      get_methods_return;
 
@@ -49,6 +377,25 @@ namespace detail
 
    typedef api_method_signature  get_signature_return;
 
+   struct get_method_stats_args
+   {
+      fc::optional< string > method;
+   };
+
+   /// Latency percentiles of an API method per call phase, in microseconds.
+   struct method_stats
+   {
+      string            method;
+      latency_summary   queue;
+      latency_summary   parse;
+      latency_summary   lock;
+      latency_summary   execute;
+      latency_summary   serialize;
+      latency_summary   total;
+   };
+
+   typedef vector< method_stats > get_method_stats_return;
+
    class json_rpc_logger
    {
    public:
@@ -114,6 +461,8 @@ namespace detail
 
          if (error)
             fc::json::save_to_file(response.error, file);
+         else if (response.result_json)
+            fc::json::save_to_file(fc::json::from_string(*response.result_json), file);
          else
             fc::json::save_to_file(response.result, file);
       }
@@ -134,12 +483,22 @@ namespace detail
          ~json_rpc_plugin_impl();
 
          void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
+         void add_api_json_method( const string& api_name, const string& method_name, const api_json_method& json_api );
 
+         void call_api_method( const api_method& call, const string& method_name, const fc::variant& func_args, json_rpc_response& response, bool raw );
+         std::shared_ptr< const std::string > serialize_result( const fc::variant& result );
+         void record_call( const string& method_name, const fc::variant& func_args, call_timing& timing );
+         bool admit( const string& client, const string& method_name, json_rpc_response& response );
          api_method* find_api_method( std::string api, std::string method );
          api_method* process_params( string method, const fc::variant_object& request, fc::variant& func_args, string* method_name );
          void rpc_id( const fc::variant_object& request, json_rpc_response& response );
-         void rpc_jsonrpc( const fc::variant_object& request, json_rpc_response& response );
-         json_rpc_response rpc( const fc::variant& message );
+         void rpc_jsonrpc( const fc::variant_object& request, json_rpc_response& response, call_timing& timing, const call_context& context );
+         json_rpc_response rpc( const fc::variant& message, call_timing& timing, const call_context& context );
+         vector< json_rpc_response > rpc_batch( const vector< fc::variant >& messages, const batch_task_dispatcher* dispatcher,
+            const call_timing& timing, const call_context& context );
+         /// Returns one response, or one per request when `batch` is set.
+         vector< json_rpc_response > call( const string& message, const batch_task_dispatcher* dispatcher,
+            const fc::time_point& received, const call_context& context, bool& batch );
 
          void initialize();
 
@@ -151,12 +510,109 @@ namespace detail
 
          DECLARE_API(
             (get_methods)
-            (get_signature) )
+            (get_signature)
+            (get_method_stats) )
 
          map< string, api_description >                     _registered_apis;
          vector< string >                                   _methods;
          map< string, map< string, api_method_signature > > _method_sigs;
          std::unique_ptr< json_rpc_logger >                 _logger;
+         uint32_t                                           _max_batch_size = 0;
+         uint32_t                                           _batch_concurrency = DEFAULT_BATCH_CONCURRENCY;
+         map< string, api_json_method >                     _json_methods;
+         map< string, api_raw_method >                      _raw_methods;
+         map< string, api_cache_predicate >                 _cache_predicates;
+         std::unique_ptr< json_rpc_response_cache >         _cache;
+         std::atomic< uint32_t >                            _last_irreversible_block{ 0 };
+         boost::signals2::connection                        _on_irreversible_block_conn;
+         /// Created when methods are registered, read only afterwards.
+         map< string, std::unique_ptr< method_latency_stats > > _latency_stats;
+         fc::microseconds                                   _slow_query_threshold = fc::milliseconds( DEFAULT_SLOW_QUERY_THRESHOLD );
+         /// Per-client rate limiting, not set when disabled.
+         std::unique_ptr< admission_control >               _admission;
+   };
+
+   json_rpc_error rate_limited_error( const fc::microseconds& retry_after )
+   {
+      STATSD_INCREMENT( "jsonrpc", "admission", "rate_limited", 1.0f );
+      return json_rpc_error( JSON_RPC_RATE_LIMITED, "Rate limit exceeded, retry later",
+         fc::variant( fc::mutable_variant_object( "retry_after_ms", ( retry_after.count() + 999 ) / 1000 ) ) );
+   }
+
+   /**
+    * Returns true for a request calling a method which broadcasts transactions or blocks,
+    * either through network_broadcast_api or a broadcast_* method of another api.
+    */
+   bool is_broadcast_request( const fc::variant& message )
+   {
+      if( !message.is_object() )
+         return false;
+
+      const auto& request = message.get_object();
+      auto method_itr = request.find( "method" );
+      if( method_itr == request.end() || !method_itr->value().is_string() )
+         return false;
+
+      string api;
+      string method = method_itr->value().get_string();
+
+      if( method == "call" )
+      {
+         auto params_itr = request.find( "params" );
+         if( params_itr == request.end() || !params_itr->value().is_array() )
+            return false;
+
+         const auto& params = params_itr->value().get_array();
+         if( params.size() < 2 || !params[0].is_string() || !params[1].is_string() )
+            return false;
+
+         api = params[0].get_string();
+         method = params[1].get_string();
+      }
+      else
+      {
+         auto pos = method.find( '.' );
+         if( pos == string::npos )
+            return false;
+
+         api = method.substr( 0, pos );
+         method = method.substr( pos + 1 );
+      }
+
+      return api == "network_broadcast_api" || boost::algorithm::starts_with( method, "broadcast_" );
+   }
+
+   /**
+    * Makes `timing` the timing of the API call running on this thread while in scope,
+    * then records the wall time not spent waiting for locks or serializing as execute time.
+    */
+   class call_timer
+   {
+   public:
+      call_timer( json_rpc_plugin_impl& impl, const string& method_name, const fc::variant& func_args, call_timing& timing )
+         : _impl( impl ), _method_name( method_name ), _func_args( func_args ), _timing( timing ), _start( fc::time_point::now() )
+      {
+         current_call_timing = &_timing;
+      }
+
+      ~call_timer()
+      {
+         current_call_timing = nullptr;
+         _timing[ execute_phase ] = fc::time_point::now() - _start - _timing[ lock_phase ] - _timing[ serialize_phase ];
+
+         try
+         {
+            _impl.record_call( _method_name, _func_args, _timing );
+         }
+         catch( ... ) {}
+      }
+
+   private:
+      json_rpc_plugin_impl&   _impl;
+      const string&           _method_name;
+      const fc::variant&      _func_args;
+      call_timing&            _timing;
+      fc::time_point          _start;
    };
 
    json_rpc_plugin_impl::json_rpc_plugin_impl() {}
@@ -170,6 +626,126 @@ namespace detail
       std::stringstream canonical_name;
       canonical_name << api_name << '.' << method_name;
       _methods.push_back( canonical_name.str() );
+      _latency_stats[ canonical_name.str() ].reset( new method_latency_stats() );
+   }
+
+   void json_rpc_plugin_impl::add_api_json_method( const string& api_name, const string& method_name, const api_json_method& json_api )
+   {
+      _json_methods[ api_name + '.' + method_name ] = json_api;
+   }
+
+   void json_rpc_plugin_impl::call_api_method( const api_method& call, const string& method_name, const fc::variant& func_args, json_rpc_response& response, bool raw )
+   {
+      if( raw )
+      {
+         auto raw_method = _raw_methods.find( method_name );
+         FC_ASSERT( raw_method != _raw_methods.end(), "Method ${method} does not support binary results", ("method", method_name) );
+
+         response.result_raw = raw_method->second( func_args );
+         return;
+      }
+
+      auto predicate = _cache ? _cache_predicates.find( method_name ) : _cache_predicates.end();
+
+      if( predicate == _cache_predicates.end() )
+      {
+         // Results are written straight to JSON when the method supports it. The cache predicate needs a variant.
+         auto json_method = _json_methods.find( method_name );
+
+         if( json_method != _json_methods.end() )
+            response.result_json = std::make_shared< const std::string >( json_method->second( func_args ) );
+         else
+            response.result_json = serialize_result( call( func_args ) );
+
+         return;
+      }
+
+      string key = method_name + ':' + fc::json_writer::to_string( canonicalize( func_args ) );
+
+      response.result_json = _cache->get( key );
+      if( response.result_json )
+      {
+         STATSD_INCREMENT( "jsonrpc", "cache", "hit", 1.0f );
+         return;
+      }
+
+      STATSD_INCREMENT( "jsonrpc", "cache", "miss", 1.0f );
+
+      // Must be read before the call, the result may come from a block that becomes irreversible during the call.
+      uint32_t last_irreversible_block = _last_irreversible_block.load();
+      fc::variant result = call( func_args );
+      bool immutable = false;
+
+      try
+      {
+         immutable = predicate->second( func_args, result, last_irreversible_block );
+      }
+      catch( fc::exception& e )
+      {
+         wlog( "Cache predicate of ${m} failed: ${e}", ("m", method_name)("e", e.to_detail_string()) );
+      }
+
+      response.result_json = serialize_result( result );
+
+      if( immutable )
+         _cache->put( key, response.result_json );
+   }
+
+   std::shared_ptr< const std::string > json_rpc_plugin_impl::serialize_result( const fc::variant& result )
+   {
+      fc::time_point start = fc::time_point::now();
+      auto json = std::make_shared< const std::string >( fc::json_writer::to_string( result ) );
+      record_serialize_time( fc::time_point::now() - start );
+      return json;
+   }
+
+   void json_rpc_plugin_impl::record_call( const string& method_name, const fc::variant& func_args, call_timing& timing )
+   {
+      timing[ total_phase ] = fc::microseconds();
+      for( size_t i = 0; i < total_phase; ++i )
+      {
+         // Clock adjustments can make a measured phase negative.
+         if( timing[ i ].count() < 0 )
+            timing[ i ] = fc::microseconds();
+         timing[ total_phase ] += timing[ i ];
+      }
+
+      auto stats = _latency_stats.find( method_name );
+      if( stats != _latency_stats.end() )
+      {
+         for( size_t i = 0; i < call_phase_count; ++i )
+         {
+            (*stats->second)[ i ].record( timing[ i ].count() );
+            STATSD_TIMER( "jsonrpc", call_phase_names[ i ], method_name, timing[ i ], 1.0f );
+         }
+      }
+
+      if( _slow_query_threshold.count() && timing[ total_phase ] >= _slow_query_threshold )
+      {
+         string params = fc::json_writer::to_string( func_args );
+         if( params.size() > SLOW_QUERY_MAX_PARAMS_SIZE )
+         {
+            params.resize( SLOW_QUERY_MAX_PARAMS_SIZE );
+            params += "...";
+         }
+
+         wlog( "Slow JSON-RPC call ${m} took ${t}us (queue ${q}us, parse ${p}us, lock ${l}us, execute ${e}us, serialize ${s}us), params: ${a}",
+            ("m", method_name)("t", timing[ total_phase ].count())("q", timing[ queue_phase ].count())("p", timing[ parse_phase ].count())
+            ("l", timing[ lock_phase ].count())("e", timing[ execute_phase ].count())("s", timing[ serialize_phase ].count())("a", params) );
+      }
+   }
+
+   bool json_rpc_plugin_impl::admit( const string& client, const string& method_name, json_rpc_response& response )
+   {
+      if( !_admission || client.empty() )
+         return true;
+
+      fc::microseconds retry_after;
+      if( _admission->admit( client, _admission->method_cost( method_name ), fc::time_point::now(), retry_after ) )
+         return true;
+
+      response.error = rate_limited_error( retry_after );
+      return false;
    }
 
    void json_rpc_plugin_impl::initialize()
@@ -199,6 +775,42 @@ namespace detail
       return method_itr->second;
    }
 
+   get_method_stats_return json_rpc_plugin_impl::get_method_stats( const get_method_stats_args& args, bool lock )
+   {
+      FC_UNUSED( lock )
+      get_method_stats_return result;
+
+      auto add_stats = [&result]( const string& method, const method_latency_stats& stats )
+      {
+         method_stats s;
+         s.method = method;
+         s.queue = stats[ queue_phase ].summary();
+         s.parse = stats[ parse_phase ].summary();
+         s.lock = stats[ lock_phase ].summary();
+         s.execute = stats[ execute_phase ].summary();
+         s.serialize = stats[ serialize_phase ].summary();
+         s.total = stats[ total_phase ].summary();
+         result.push_back( std::move( s ) );
+      };
+
+      if( args.method )
+      {
+         auto itr = _latency_stats.find( *args.method );
+         FC_ASSERT( itr != _latency_stats.end(), "Method ${method} does not exist.", ("method", *args.method) );
+         add_stats( itr->first, *itr->second );
+      }
+      else
+      {
+         for( const auto& entry : _latency_stats )
+         {
+            if( (*entry.second)[ total_phase ].summary().count )
+               add_stats( entry.first, *entry.second );
+         }
+      }
+
+      return result;
+   }
+
    api_method* json_rpc_plugin_impl::find_api_method( std::string api, std::string method )
    {
       STATSD_START_TIMER( "jsonrpc", "overhead", "find_api_method", 1.0f );
@@ -274,7 +886,7 @@ namespace detail
       }
    }
 
-   void json_rpc_plugin_impl::rpc_jsonrpc( const fc::variant_object& request, json_rpc_response& response )
+   void json_rpc_plugin_impl::rpc_jsonrpc( const fc::variant_object& request, json_rpc_response& response, call_timing& timing, const call_context& context )
    {
       STATSD_START_TIMER( "jsonrpc", "overhead", "rpc_jsonrpc", 1.0f );
       if( request.contains( "jsonrpc" ) && request[ "jsonrpc" ].is_string() && request[ "jsonrpc" ].as_string() == "2.0" )
@@ -303,10 +915,11 @@ namespace detail
 
                   try
                   {
-                     if( call )
+                     if( call && admit( context.client, method_name, response ) )
                      {
                         STATSD_START_TIMER( "jsonrpc", "api", method_name, 1.0f );
-                        response.result = (*call)( func_args );
+                        call_timer timer( *this, method_name, func_args, timing );
+                        call_api_method( *call, method_name, func_args, response, context.raw );
                      }
                   }
                   catch( chainbase::lock_exception& e )
@@ -341,7 +954,7 @@ namespace detail
    log(request, response);
    }
 
-   json_rpc_response json_rpc_plugin_impl::rpc( const fc::variant& message )
+   json_rpc_response json_rpc_plugin_impl::rpc( const fc::variant& message, call_timing& timing, const call_context& context )
    {
       json_rpc_response response;
 
@@ -359,7 +972,7 @@ namespace detail
          try
          {
             if( !response.error.valid() )
-               rpc_jsonrpc( request, response );
+               rpc_jsonrpc( request, response, timing, context );
          }
          catch( fc::exception& e )
          {
@@ -397,11 +1010,167 @@ namespace detail
 
       return response;
    }
+
+   vector< json_rpc_response > json_rpc_plugin_impl::rpc_batch( const vector< fc::variant >& messages, const batch_task_dispatcher* dispatcher,
+      const call_timing& timing, const call_context& context )
+   {
+      vector< json_rpc_response > responses( messages.size() );
+
+      size_t concurrency = std::min< size_t >( _batch_concurrency, messages.size() );
+      fc::time_point start = fc::time_point::now();
+
+      // Logger keeps its own counters and is not meant for concurrent use.
+      // Broadcasts run in request order, as later transactions of a batch may depend on earlier ones.
+      if( dispatcher == nullptr || concurrency <= 1 || _logger
+         || std::any_of( messages.begin(), messages.end(), is_broadcast_request ) )
+      {
+         for( size_t i = 0; i < messages.size(); ++i )
+         {
+            // Waiting for earlier elements of the batch counts as queue wait.
+            call_timing element_timing = timing;
+            element_timing[ queue_phase ] += fc::time_point::now() - start;
+            responses[ i ] = rpc( messages[ i ], element_timing, context );
+         }
+
+         return responses;
+      }
+
+      // Tasks can be started after the batch is completed, so shared state must outlive this call.
+      struct batch_state
+      {
+         const vector< fc::variant >*  messages = nullptr;
+         vector< json_rpc_response >*  responses = nullptr;
+         call_timing                   timing;
+         fc::time_point                start;
+         call_context                  context;
+         size_t                        count = 0;
+         std::atomic< size_t >         next{ 0 };
+         std::atomic< size_t >         done{ 0 };
+         std::mutex                    mutex;
+         std::condition_variable       completed;
+      };
+
+      auto state = std::make_shared< batch_state >();
+      state->messages = &messages;
+      state->responses = &responses;
+      state->timing = timing;
+      state->start = start;
+      state->context = context;
+      state->count = messages.size();
+
+      // Each worker claims subsequent elements, so responses are stored in request order.
+      auto worker = [state, this]()
+      {
+         size_t i;
+         while( ( i = state->next++ ) < state->count )
+         {
+            call_timing element_timing = state->timing;
+            element_timing[ queue_phase ] += fc::time_point::now() - state->start;
+            (*state->responses)[ i ] = rpc( (*state->messages)[ i ], element_timing, state->context );
+
+            if( ++state->done == state->count )
+            {
+               std::lock_guard< std::mutex > lock( state->mutex );
+               state->completed.notify_all();
+            }
+         }
+      };
+
+      for( size_t i = 1; i < concurrency; ++i )
+         (*dispatcher)( worker );
+
+      worker();
+
+      std::unique_lock< std::mutex > lock( state->mutex );
+      state->completed.wait( lock, [&state]() { return state->done == state->count; } );
+
+      return responses;
+   }
+
+   vector< json_rpc_response > json_rpc_plugin_impl::call( const string& message, const batch_task_dispatcher* dispatcher,
+      const fc::time_point& received, const call_context& context, bool& batch )
+   {
+      STATSD_START_TIMER( "jsonrpc", "overhead", "call", 1.0f );
+      call_timing timing;
+      fc::time_point start = fc::time_point::now();
+      vector< json_rpc_response > responses( 1 );
+      batch = false;
+
+      if( received != fc::time_point() )
+         timing[ queue_phase ] = start - received;
+
+      // Clients out of budget are refused before the request is even parsed.
+      fc::microseconds retry_after;
+      if( _admission && !context.client.empty() && !_admission->admit( context.client, 0, start, retry_after ) )
+      {
+         responses[0].error = rate_limited_error( retry_after );
+         return responses;
+      }
+
+      try
+      {
+         fc::variant v = fc::json::from_string( message, fc::json::fast_parser );
+         timing[ parse_phase ] = fc::time_point::now() - start;
+
+         if( v.is_array() )
+         {
+            vector< fc::variant > messages = v.as< vector< fc::variant > >();
+
+            if( _max_batch_size && messages.size() > _max_batch_size )
+            {
+               responses[0].error = json_rpc_error( JSON_RPC_INVALID_REQUEST, "Batch size " + std::to_string( messages.size() )
+                  + " exceeds limit of " + std::to_string( _max_batch_size ) + " requests" );
+            }
+            else if( messages.size() )
+            {
+               // Parsing is shared by all requests of the batch.
+               timing[ parse_phase ] = fc::microseconds( timing[ parse_phase ].count() / int64_t( messages.size() ) );
+               batch = true;
+               return rpc_batch( messages, dispatcher, timing, context );
+            }
+            else
+            {
+               //For example: message == "[]"
+               responses[0].error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Array is invalid" );
+            }
+         }
+         else
+         {
+            responses[0] = rpc( v, timing, context );
+         }
+      }
+      catch( fc::exception& e )
+      {
+         responses[0] = json_rpc_response();
+         responses[0].error = json_rpc_error( JSON_RPC_SERVER_ERROR, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+      }
+      catch( ... )
+      {
+         responses[0] = json_rpc_response();
+         responses[0].error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown exception", fc::variant(
+            fc::unhandled_exception( FC_LOG_MESSAGE( warn, "Unknown Exception" ), std::current_exception() ).to_detail_string() ) );
+      }
+
+      return responses;
+   }
+}
+
+void record_lock_wait( const fc::microseconds& wait )
+{
+   if( detail::current_call_timing )
+      (*detail::current_call_timing)[ detail::lock_phase ] += wait;
+}
+
+void record_serialize_time( const fc::microseconds& time )
+{
+   if( detail::current_call_timing )
+      (*detail::current_call_timing)[ detail::serialize_phase ] += time;
 }
 
 using detail::json_rpc_error;
 using detail::json_rpc_response;
 using detail::json_rpc_logger;
+using detail::to_json;
 
 json_rpc_plugin::json_rpc_plugin() : my( new detail::json_rpc_plugin_impl() ) {}
 json_rpc_plugin::~json_rpc_plugin() {}
@@ -410,6 +1179,23 @@ void json_rpc_plugin::set_program_options( options_description& , options_descri
 {
    cfg.add_options()
       ("log-json-rpc", bpo::value< string >(), "json-rpc log directory name.")
+      ("json-rpc-max-batch-size", bpo::value< uint32_t >()->default_value( 0 ),
+       "Maximum number of requests in a single batch request. 0 means no limit.")
+      ("json-rpc-batch-concurrency", bpo::value< uint32_t >()->default_value( DEFAULT_BATCH_CONCURRENCY ),
+       "Maximum number of requests of a single batch processed in parallel. 1 processes batches serially. "
+       "Batches containing a broadcast method are always processed serially.")
+      ("json-rpc-cache-size", bpo::value< uint64_t >()->default_value( DEFAULT_CACHE_SIZE ),
+       "Maximum size in bytes of cached results of calls over irreversible data. 0 disables the cache.")
+      ("json-rpc-cache-max-entry-size", bpo::value< uint64_t >()->default_value( DEFAULT_CACHE_MAX_ENTRY_SIZE ),
+       "Maximum size in bytes of a single cached result.")
+      ("json-rpc-slow-query-threshold", bpo::value< uint32_t >()->default_value( DEFAULT_SLOW_QUERY_THRESHOLD ),
+       "Calls taking at least this many milliseconds are logged with their parameters and time spent in each phase. 0 disables the log.")
+      ("json-rpc-client-rate", bpo::value< uint32_t >()->default_value( 0 ),
+       "Tokens per second each client (IP address) earns for API calls. Calls over budget fail with a rate limit error. 0 disables rate limiting.")
+      ("json-rpc-client-burst", bpo::value< uint32_t >()->default_value( DEFAULT_CLIENT_BURST ),
+       "Maximum number of tokens a client can save up and spend at once.")
+      ("json-rpc-method-cost", bpo::value< vector< string > >()->composing(),
+       "Tokens charged for a call of a method, as api.method=cost. Methods without a cost are charged 1 token. Can be specified multiple times.")
       ;
 }
 
@@ -429,6 +1215,55 @@ void json_rpc_plugin::plugin_initialize( const variables_map& options )
       fc::create_directories(p);
       my->_logger.reset(new json_rpc_logger(dir_name));
    }
+
+   if( options.count( "json-rpc-max-batch-size" ) )
+      my->_max_batch_size = options.at( "json-rpc-max-batch-size" ).as< uint32_t >();
+
+   if( options.count( "json-rpc-batch-concurrency" ) )
+      my->_batch_concurrency = std::max( options.at( "json-rpc-batch-concurrency" ).as< uint32_t >(), 1u );
+
+   if( options.count( "json-rpc-slow-query-threshold" ) )
+      my->_slow_query_threshold = fc::milliseconds( options.at( "json-rpc-slow-query-threshold" ).as< uint32_t >() );
+
+   uint32_t client_rate = options.count( "json-rpc-client-rate" ) ? options.at( "json-rpc-client-rate" ).as< uint32_t >() : 0;
+   if( client_rate )
+   {
+      uint32_t client_burst = options.count( "json-rpc-client-burst" ) ?
+         options.at( "json-rpc-client-burst" ).as< uint32_t >() : DEFAULT_CLIENT_BURST;
+      my->_admission.reset( new admission_control( client_rate, client_burst ) );
+
+      if( options.count( "json-rpc-method-cost" ) )
+      {
+         for( const string& entry : options.at( "json-rpc-method-cost" ).as< vector< string > >() )
+         {
+            vector< string > v;
+            boost::split( v, entry, boost::is_any_of( "=" ) );
+            FC_ASSERT( v.size() == 2, "Invalid json-rpc-method-cost ${e}, expected api.method=cost", ("e", entry) );
+
+            boost::trim( v[0] );
+            boost::trim( v[1] );
+            my->_admission->set_method_cost( v[0], boost::lexical_cast< uint32_t >( v[1] ) );
+         }
+      }
+
+      ilog( "Rate limiting API clients to ${r} tokens per second, burst ${b}", ("r", client_rate)("b", client_burst) );
+   }
+
+   uint64_t cache_size = options.count( "json-rpc-cache-size" ) ? options.at( "json-rpc-cache-size" ).as< uint64_t >() : 0;
+   if( cache_size )
+   {
+      uint64_t max_entry_size = options.count( "json-rpc-cache-max-entry-size" ) ?
+         options.at( "json-rpc-cache-max-entry-size" ).as< uint64_t >() : DEFAULT_CACHE_MAX_ENTRY_SIZE;
+      my->_cache.reset( new detail::json_rpc_response_cache( cache_size, max_entry_size ) );
+   }
+
+   // Connected before the chain starts, so no irreversible block (including those of a replay) is missed.
+   auto chain = appbase::app().find_plugin< chain::chain_plugin >();
+   if( chain != nullptr )
+   {
+      my->_on_irreversible_block_conn = chain->db().add_irreversible_block_handler(
+         [this]( uint32_t block_num ){ notify_irreversible_block( block_num ); }, *this );
+   }
 }
 
 void json_rpc_plugin::plugin_startup()
@@ -436,61 +1271,84 @@ void json_rpc_plugin::plugin_startup()
    std::sort( my->_methods.begin(), my->_methods.end() );
 }
 
-void json_rpc_plugin::plugin_shutdown() {}
+void json_rpc_plugin::plugin_shutdown()
+{
+   chain::util::disconnect_signal( my->_on_irreversible_block_conn );
+
+   if( my->_cache )
+      my->_cache->log_stats();
+}
 
 void json_rpc_plugin::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig )
 {
    my->add_api_method( api_name, method_name, api, sig );
 }
 
+void json_rpc_plugin::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_json_method& json_api, const api_method_signature& sig )
+{
+   my->add_api_method( api_name, method_name, api, sig );
+   my->add_api_json_method( api_name, method_name, json_api );
+}
+
+void json_rpc_plugin::add_api_raw_method( const string& api_name, const string& method_name, const api_raw_method& raw_api )
+{
+   my->_raw_methods[ api_name + '.' + method_name ] = raw_api;
+}
+
+void json_rpc_plugin::add_api_cache_predicate( const string& api_name, const string& method_name, const api_cache_predicate& predicate )
+{
+   my->_cache_predicates[ api_name + '.' + method_name ] = predicate;
+}
+
+void json_rpc_plugin::notify_irreversible_block( uint32_t block_num )
+{
+   uint32_t last = my->_last_irreversible_block.load();
+   while( last < block_num && !my->_last_irreversible_block.compare_exchange_weak( last, block_num ) );
+}
+
+bool json_rpc_plugin::admit( const string& client, const string& method, fc::microseconds& retry_after )
+{
+   if( !my->_admission || client.empty() )
+      return true;
+
+   return my->_admission->admit( client, my->_admission->method_cost( method ), fc::time_point::now(), retry_after );
+}
+
 string json_rpc_plugin::call( const string& message )
 {
-   STATSD_START_TIMER( "jsonrpc", "overhead", "call", 1.0f );
-   try
-   {
-      fc::variant v = fc::json::from_string( message );
+   return call( message, batch_task_dispatcher() );
+}
 
-      if( v.is_array() )
-      {
-         vector< fc::variant > messages = v.as< vector< fc::variant > >();
-         vector< json_rpc_response > responses;
+string json_rpc_plugin::call( const string& message, const batch_task_dispatcher& dispatcher, const fc::time_point& received,
+   const string& client )
+{
+   detail::call_context context;
+   context.client = client;
 
-         if( messages.size() )
-         {
-            responses.reserve( messages.size() );
+   bool batch = false;
+   auto responses = my->call( message, dispatcher ? &dispatcher : nullptr, received, context, batch );
+   return batch ? to_json( responses ) : to_json( responses.front() );
+}
 
-            for( auto& m : messages )
-               responses.push_back( my->rpc( m ) );
+vector< char > json_rpc_plugin::call_raw( const string& message, const batch_task_dispatcher& dispatcher, const fc::time_point& received,
+   const string& client )
+{
+   detail::call_context context;
+   context.client = client;
+   context.raw = true;
 
-            return fc::json::to_string( responses );
-         }
-         else
-         {
-            //For example: message == "[]"
-            json_rpc_response response;
-            response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Array is invalid" );
-            return fc::json::to_string( response );
-         }
-      }
-      else
-      {
-         return fc::json::to_string( my->rpc( v ) );
-      }
-   }
-   catch( fc::exception& e )
-   {
-      json_rpc_response response;
-      response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
-      return fc::json::to_string( response );
-   }
-   catch( ... )
-   {
-      json_rpc_response response;
-      response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown exception", fc::variant(
-         fc::unhandled_exception( FC_LOG_MESSAGE( warn, "Unknown Exception" ), std::current_exception() ).to_detail_string() ) );
-      return fc::json::to_string( response );
-   }
+   bool batch = false;
+   auto responses = my->call( message, dispatcher ? &dispatcher : nullptr, received, context, batch );
+
+   if( !batch )
+      return fc::raw::pack_to_vector( detail::to_raw( responses.front() ) );
+
+   vector< raw_rpc_response > raw;
+   raw.reserve( responses.size() );
+   for( auto& response : responses )
+      raw.push_back( detail::to_raw( response ) );
 
+   return fc::raw::pack_to_vector( raw );
 }
 
 } } } // blurt::plugins::json_rpc
@@ -499,3 +1357,6 @@ FC_REFLECT( blurt::plugins::json_rpc::detail::json_rpc_error, (code)(message)(da
 FC_REFLECT( blurt::plugins::json_rpc::detail::json_rpc_response, (jsonrpc)(result)(error)(id) )
 
 FC_REFLECT( blurt::plugins::json_rpc::detail::get_signature_args, (method) )
+FC_REFLECT( blurt::plugins::json_rpc::detail::get_method_stats_args, (method) )
+FC_REFLECT( blurt::plugins::json_rpc::detail::latency_summary, (count)(mean)(p50)(p90)(p99)(p999)(max) )
+FC_REFLECT( blurt::plugins::json_rpc::detail::method_stats, (method)(queue)(parse)(lock)(execute)(serialize)(total) )
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <blurt/protocol/operations.hpp>
+#include <blurt/protocol/types.hpp>
+
+#include <fc/container/flat.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <string>
+
+namespace blurt { namespace plugins { namespace webserver {
+
+enum class subscription_type
+{
+   head_block,
+   irreversible_block,
+   operations
+};
+
+const size_t subscription_type_count = 3;
+
+struct subscribe_args
+{
+   /// "head_block", "irreversible_block" or "operations"
+   std::string                                     type;
+   /// Operations impacting any of these accounts, all operations when empty.
+   fc::flat_set< protocol::account_name_type >     accounts;
+   /// Operations of these types, e.g. transfer_operation, all operations when empty.
+   fc::flat_set< std::string >                     operation_types;
+   /**
+    * Operations are published once their block is irreversible instead of when it is applied.
+    * Otherwise, operations of a block which is later popped in a fork switch have already been
+    * published, and the operations of the replacing block are published as well.
+    */
+   bool                                            irreversible = false;
+};
+
+/// Returns the fully qualified type name of `op`, e.g. blurt::protocol::transfer_operation.
+std::string operation_type_name( const protocol::operation& op );
+
+/**
+ * Decides which chain events a websocket subscription receives.
+ *
+ * Built from validated subscribe arguments, independent of the websocket server.
+ */
+class subscription_filter
+{
+   public:
+      /// Throws when `args` name an unknown subscription or operation type, or filter a block subscription.
+      explicit subscription_filter( const subscribe_args& args );
+
+      subscription_type type()const { return _type; }
+
+      /// True for an operations subscription waiting for blocks to become irreversible.
+      bool irreversible()const { return _irreversible; }
+
+      /**
+       * Returns true for an operations subscription accepting an operation of type `op_type`
+       * (as returned by operation_type_name) which impacts `impacted` accounts.
+       */
+      bool matches_operation( const std::string& op_type, const fc::flat_set< protocol::account_name_type >& impacted )const;
+
+   private:
+      subscription_type                               _type;
+      fc::flat_set< protocol::account_name_type >     _accounts;
+      fc::flat_set< std::string >                     _operation_types;
+      bool                                            _irreversible = false;
+};
+
+} } } // blurt::plugins::webserver
+
+FC_REFLECT( blurt::plugins::webserver::subscribe_args, (type)(accounts)(operation_types)(irreversible) )
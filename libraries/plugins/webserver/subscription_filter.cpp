@@ -0,0 +1,94 @@
+#include <blurt/plugins/webserver/subscription_filter.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+/// Namespace of operation types, which can be omitted in subscribe arguments.
+#define OPERATION_TYPE_PREFIX "blurt::protocol::"
+
+namespace blurt { namespace plugins { namespace webserver {
+
+namespace {
+
+struct operation_type_name_visitor
+{
+   typedef std::string result_type;
+
+   template< typename T >
+   std::string operator()( const T& )const { return fc::get_typename< T >::name(); }
+};
+
+const fc::flat_set< std::string >& known_operation_types()
+{
+   static const fc::flat_set< std::string > types = []()
+   {
+      fc::flat_set< std::string > names;
+      protocol::operation op;
+      for( int64_t i = 0; i < protocol::operation::count(); ++i )
+      {
+         op.set_which( i );
+         names.insert( operation_type_name( op ) );
+      }
+      return names;
+   }();
+
+   return types;
+}
+
+} // anonymous
+
+std::string operation_type_name( const protocol::operation& op )
+{
+   return op.visit( operation_type_name_visitor() );
+}
+
+subscription_filter::subscription_filter( const subscribe_args& args )
+{
+   if( args.type == "head_block" )
+      _type = subscription_type::head_block;
+   else if( args.type == "irreversible_block" )
+      _type = subscription_type::irreversible_block;
+   else if( args.type == "operations" )
+      _type = subscription_type::operations;
+   else
+      FC_ASSERT( false, "Unknown subscription type ${t}, expected head_block, irreversible_block or operations", ("t", args.type) );
+
+   if( _type == subscription_type::operations )
+   {
+      _accounts = args.accounts;
+      _irreversible = args.irreversible;
+
+      for( const auto& name : args.operation_types )
+      {
+         std::string type = boost::algorithm::starts_with( name, OPERATION_TYPE_PREFIX ) ? name : OPERATION_TYPE_PREFIX + name;
+         FC_ASSERT( known_operation_types().count( type ), "Unknown operation type ${t}", ("t", name) );
+         _operation_types.insert( type );
+      }
+   }
+   else
+   {
+      FC_ASSERT( args.accounts.empty() && args.operation_types.empty() && !args.irreversible,
+         "Only operations subscriptions can be filtered" );
+   }
+}
+
+bool subscription_filter::matches_operation( const std::string& op_type,
+   const fc::flat_set< protocol::account_name_type >& impacted )const
+{
+   if( _type != subscription_type::operations )
+      return false;
+   if( _operation_types.size() && !_operation_types.count( op_type ) )
+      return false;
+   if( _accounts.empty() )
+      return true;
+
+   for( const auto& account : impacted )
+   {
+      if( _accounts.count( account ) )
+         return true;
+   }
+   return false;
+}
+
+} } } // blurt::plugins::webserver
@@ -1,13 +1,23 @@
 #include <blurt/plugins/webserver/webserver_plugin.hpp>
+#include <blurt/plugins/webserver/subscription_filter.hpp>
 
 #include <blurt/plugins/chain/chain_plugin.hpp>
+#include <blurt/plugins/statsd/utility.hpp>
+
+#include <blurt/chain/util/impacted.hpp>
+#include <blurt/chain/util/signal.hpp>
 
 #include <fc/network/ip.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
 #include <fc/network/resolve.hpp>
+#include <fc/compress/zlib.hpp>
+#include <fc/io/json_writer.hpp>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 #include <boost/bind.hpp>
 #include <boost/preprocessor/stringize.hpp>
@@ -20,10 +30,18 @@
 #include <websocketpp/logger/stub.hpp>
 #include <websocketpp/logger/syslog.hpp>
 
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <thread>
 #include <memory>
 #include <iostream>
 
+#ifndef _WIN32
+#include <netinet/tcp.h>
+#endif
+
 namespace blurt { namespace plugins { namespace webserver {
 
 namespace asio = boost::asio;
@@ -34,6 +52,9 @@ using boost::optional;
 using boost::asio::ip::tcp;
 using std::shared_ptr;
 using websocketpp::connection_hdl;
+using fc::flat_set;
+using blurt::chain::block_notification;
+using blurt::chain::operation_notification;
 
 typedef uint32_t thread_pool_size_t;
 
@@ -79,21 +100,786 @@ namespace detail {
 
 using websocket_server_type = websocketpp::server< detail::asio_with_stub_log >;
 
-class webserver_plugin_impl
+enum class content_encoding
+{
+   identity,
+   gzip,
+   deflate
+};
+
+/**
+ * Picks the response encoding from an Accept-Encoding request header,
+ * preferring gzip over deflate and honoring codings refused with q=0.
+ */
+content_encoding negotiate_content_encoding( const string& accept_encoding )
+{
+   bool gzip = false;
+   bool deflate = false;
+
+   std::vector< string > codings;
+   boost::split( codings, accept_encoding, boost::is_any_of( "," ) );
+
+   for( const auto& coding : codings )
+   {
+      std::vector< string > params;
+      boost::split( params, coding, boost::is_any_of( ";" ) );
+
+      bool refused = false;
+      for( size_t i = 1; i < params.size(); ++i )
+      {
+         string param = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[i] ) );
+         if( boost::algorithm::starts_with( param, "q=" ) )
+            refused = std::strtod( param.c_str() + 2, nullptr ) <= 0;
+      }
+
+      if( refused )
+         continue;
+
+      string name = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ) );
+      if( name == "gzip" || name == "x-gzip" || name == "*" )
+         gzip = true;
+      else if( name == "deflate" )
+         deflate = true;
+   }
+
+   if( gzip )
+      return content_encoding::gzip;
+   if( deflate )
+      return content_encoding::deflate;
+   return content_encoding::identity;
+}
+
+/// Media type of fc::raw packed responses, see json_rpc_plugin::call_raw.
+#define RAW_CONTENT_TYPE "application/octet-stream"
+
+/// Websocket subprotocol whose responses are fc::raw packed binary messages.
+#define RAW_SUBPROTOCOL "blurt-raw"
+
+/// Whether an Accept request header asks for fc::raw packed results.
+bool accepts_raw_results( const string& accept )
+{
+   std::vector< string > types;
+   boost::split( types, accept, boost::is_any_of( "," ) );
+
+   for( const auto& type : types )
+   {
+      std::vector< string > params;
+      boost::split( params, type, boost::is_any_of( ";" ) );
+
+      bool refused = false;
+      for( size_t i = 1; i < params.size(); ++i )
+      {
+         string param = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[i] ) );
+         if( boost::algorithm::starts_with( param, "q=" ) )
+            refused = std::strtod( param.c_str() + 2, nullptr ) <= 0;
+      }
+
+      if( !refused && boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ) ) == RAW_CONTENT_TYPE )
+         return true;
+   }
+
+   return false;
+}
+
+/// Responses of requests answered by the webserver itself, without json_rpc.
+string rpc_result_response( const fc::variant& id, const fc::variant& result )
+{
+   return fc::json::to_string( fc::mutable_variant_object()
+      ( "jsonrpc", "2.0" )
+      ( "result", result )
+      ( "id", id ) );
+}
+
+string rpc_error_response( const fc::variant& id, int32_t code, const string& message, const fc::variant& data = fc::variant() )
+{
+   fc::mutable_variant_object error( "code", code );
+   error( "message", message );
+   if( !data.is_null() )
+      error( "data", data );
+
+   return fc::json::to_string( fc::mutable_variant_object()
+      ( "jsonrpc", "2.0" )
+      ( "error", error )
+      ( "id", id ) );
+}
+
+/// Sent instead of a response when a request is shed.
+string server_busy_response()
+{
+   return rpc_error_response( fc::variant(), JSON_RPC_SERVER_BUSY, "Server busy, retry later" );
+}
+
+/**
+ * Reads the method names of a JSON-RPC request, or of each request of a batch, without
+ * parsing the whole body. Used to pick a thread pool on the io thread, so it only tracks
+ * strings and brackets. Malformed requests are left for json_rpc to report.
+ */
+class request_scanner
 {
    public:
-      webserver_plugin_impl(thread_pool_size_t thread_pool_size) :
-         thread_pool_work( this->thread_pool_ios )
+      request_scanner( const string& body ) : _pos( body.data() ), _end( body.data() + body.size() ) {}
+
+      bool scan( std::vector< string >& methods )
+      {
+         skip_white_space();
+         if( peek() != '[' )
+            return scan_request( methods );
+
+         ++_pos;
+         skip_white_space();
+         if( peek() == ']' )
+            return true;
+
+         while( true )
+         {
+            if( !scan_request( methods ) )
+               return false;
+
+            skip_white_space();
+            char c = peek();
+            ++_pos;
+
+            if( c == ']' )
+               return true;
+            if( c != ',' )
+               return false;
+         }
+      }
+
+   private:
+      char peek()const { return _pos != _end ? *_pos : 0; }
+
+      void skip_white_space()
+      {
+         while( _pos != _end && ( *_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r' ) )
+            ++_pos;
+      }
+
+      bool skip_string()
+      {
+         if( peek() != '"' )
+            return false;
+
+         for( ++_pos; _pos != _end; ++_pos )
+         {
+            if( *_pos == '\\' )
+            {
+               if( ++_pos == _end )
+                  return false;
+            }
+            else if( *_pos == '"' )
+            {
+               ++_pos;
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+      /// Escapes are kept as is, method names never contain any.
+      bool read_string( string& s )
+      {
+         const char* start = _pos + 1;
+         if( !skip_string() )
+            return false;
+
+         s.assign( start, _pos - 1 );
+         return true;
+      }
+
+      bool skip_value()
+      {
+         switch( peek() )
+         {
+            case '"':
+               return skip_string();
+            case '{':
+            case '[':
+            {
+               uint32_t depth = 0;
+               while( _pos != _end )
+               {
+                  switch( *_pos )
+                  {
+                     case '"':
+                        if( !skip_string() )
+                           return false;
+                        continue;
+                     case '{':
+                     case '[':
+                        ++depth;
+                        break;
+                     case '}':
+                     case ']':
+                        if( --depth == 0 )
+                        {
+                           ++_pos;
+                           return true;
+                        }
+                        break;
+                  }
+                  ++_pos;
+               }
+               return false;
+            }
+            default:
+               while( _pos != _end && !strchr( ",}] \t\n\r", *_pos ) )
+                  ++_pos;
+               return true;
+         }
+      }
+
+      bool scan_request( std::vector< string >& methods )
+      {
+         skip_white_space();
+         if( peek() != '{' )
+            return false;
+         ++_pos;
+
+         string method;
+         const char* params = nullptr;
+
+         while( true )
+         {
+            skip_white_space();
+            if( peek() == '}' )
+            {
+               ++_pos;
+               break;
+            }
+
+            string key;
+            if( !read_string( key ) )
+               return false;
+
+            skip_white_space();
+            if( peek() != ':' )
+               return false;
+            ++_pos;
+            skip_white_space();
+
+            if( key == "method" && peek() == '"' )
+            {
+               if( !read_string( method ) )
+                  return false;
+            }
+            else
+            {
+               if( key == "params" )
+                  params = _pos;
+               if( !skip_value() )
+                  return false;
+            }
+
+            skip_white_space();
+            if( peek() == ',' )
+               ++_pos;
+         }
+
+         // Legacy calls name the API and method in params: ["api", "method", args]
+         if( method == "call" && params )
+         {
+            const char* end = _pos;
+            string api, api_method;
+            _pos = params;
+
+            if( peek() == '[' )
+            {
+               ++_pos;
+               skip_white_space();
+               if( read_string( api ) )
+               {
+                  skip_white_space();
+                  if( peek() == ',' )
+                  {
+                     ++_pos;
+                     skip_white_space();
+                     if( read_string( api_method ) )
+                        method = api + '.' + api_method;
+                  }
+               }
+            }
+
+            _pos = end;
+         }
+
+         methods.push_back( std::move( method ) );
+         return true;
+      }
+
+      const char* _pos;
+      const char* _end;
+};
+
+/// Threads processing API requests, with their own queue.
+class api_thread_pool
+{
+   public:
+      api_thread_pool( const string& pool_name, thread_pool_size_t size ) :
+         name( pool_name ),
+         work( ios )
+      {
+         for( uint32_t i = 0; i < size; ++i )
+            threads.create_thread( boost::bind( &asio::io_service::run, &ios ) );
+
+         batch_dispatcher = [this]( std::function< void() > task )
+         {
+            ios.post( std::move( task ) );
+         };
+      }
+
+      void post( std::function< void() > task )
+      {
+         uint32_t depth = ++queued;
+         STATSD_GAUGE( "webserver", "queue_depth", name, depth, 1.0f );
+
+         fc::time_point posted = fc::time_point::now();
+         ios.post( [this, task, posted]()
+         {
+            --queued;
+            STATSD_TIMER( "webserver", "queue_wait", name, fc::time_point::now() - posted, 1.0f );
+            task();
+         });
+      }
+
+      void stop()
+      {
+         ios.stop();
+         threads.join_all();
+      }
+
+      const string               name;
+      boost::thread_group        threads;
+      asio::io_service           ios;
+      asio::io_service::work     work;
+      /// Requests posted and not yet picked up by a thread.
+      std::atomic< uint32_t >    queued{ 0 };
+      /// Lets json_rpc process elements of batch requests on idle threads of this pool.
+      plugins::json_rpc::batch_task_dispatcher batch_dispatcher;
+};
+
+/// Prefix of the methods handled by the webserver itself, only over websocket.
+#define SUBSCRIPTION_API_PREFIX "subscription_api."
+
+/// Maximum number of subscriptions of a single websocket connection.
+#define MAX_SUBSCRIPTIONS_PER_CONNECTION 16
+
+struct unsubscribe_args
+{
+   uint64_t subscription = 0;
+};
+
+struct block_notice
+{
+   uint32_t                block_num = 0;
+   protocol::block_id_type block_id;
+   protocol::signed_block  block;
+};
+
+struct irreversible_block_notice
+{
+   uint32_t block_num = 0;
+};
+
+struct operation_notice
+{
+   protocol::transaction_id_type trx_id;
+   uint32_t                      block = 0;
+   protocol::block_id_type       block_id;
+   uint32_t                      trx_in_block = 0;
+   uint32_t                      op_in_trx = 0;
+   uint32_t                      virtual_op = 0;
+   fc::time_point_sec            timestamp;
+   protocol::operation           op;
+};
+
+/**
+ * Pushes chain events to websocket connections which subscribed to them.
+ *
+ * Chain handlers only copy what is needed and return. Each notification is then
+ * serialized once on a dedicated thread and sent to every matching connection.
+ * Connections which fall behind by more than max_buffered bytes are closed instead of
+ * letting their send queue grow without bound.
+ *
+ * Operations are published when their block is applied. A block popped in a fork switch is
+ * not retracted, so operations subscribers also get the operations of the replacing block,
+ * with a different block_id. Subscriptions made with `irreversible` only get operations once
+ * their block is irreversible, which never happens for popped blocks.
+ */
+class subscription_manager
+{
+   public:
+      subscription_manager( uint64_t max_buffered ) :
+         _max_buffered( max_buffered ),
+         _work( _ios )
+      {
+         for( auto& count : _counts )
+            count = 0;
+
+         _thread = std::make_shared< std::thread >( [this]()
+         {
+            ilog( "start processing subscription thread" );
+            _ios.run();
+         });
+      }
+
+      void connect( blurt::chain::database& db, const abstract_plugin& plugin );
+      void stop();
+
+      uint64_t subscribe( websocket_server_type* server, connection_hdl hdl, const subscribe_args& args );
+      bool unsubscribe( connection_hdl hdl, uint64_t id );
+      void remove( connection_hdl hdl );
+
+   private:
+      struct subscriber
+      {
+         websocket_server_type*                    server = nullptr;
+         map< uint64_t, subscription_filter >      subscriptions;
+      };
+
+      typedef map< connection_hdl, subscriber, std::owner_less< connection_hdl > > subscriber_map;
+
+      bool has_subscribers( subscription_type type )const { return _counts[ size_t( type ) ].load() > 0; }
+
+      void on_pre_apply_block( const block_notification& note );
+      void on_post_apply_operation( const operation_notification& note );
+      void on_post_apply_block( const block_notification& note );
+      void on_irreversible_block( uint32_t block_num );
+
+      void publish( const std::function< bool( const subscription_filter& ) >& matches, const std::function< string() >& serialize );
+      /// Publishes `ops` to operations subscriptions waiting for irreversible blocks, or to the others.
+      void publish_operations( const std::vector< operation_notice >& ops, bool irreversible );
+      bool send( connection_hdl hdl, const subscriber& sub, const string& message );
+      subscriber_map::iterator erase( subscriber_map::iterator itr );
+
+      template< typename T >
+      static string notification( const char* method, const T& params )
+      {
+         string message = "{\"jsonrpc\":\"2.0\",\"method\":\"" SUBSCRIPTION_API_PREFIX;
+         message += method;
+         message += "\",\"params\":";
+         fc::json_writer( message ).write( params );
+         message += '}';
+         return message;
+      }
+
+      const uint64_t                         _max_buffered;
+
+      /// Guards subscribers, which are changed by API threads and read by the notification thread.
+      std::mutex                             _mutex;
+      subscriber_map                         _subscribers;
+      uint64_t                               _next_id = 0;
+      std::atomic< uint32_t >                _counts[ subscription_type_count ];
+      /// Operations subscriptions waiting for irreversible blocks.
+      std::atomic< uint32_t >                _irreversible_count{ 0 };
+
+      blurt::chain::database*                _db = nullptr;
+      /// Operations of the block being applied, only used on the chain thread.
+      std::vector< operation_notice >        _block_ops;
+      /// Operations of applied blocks which are not irreversible yet, by block number, only used on the chain thread.
+      std::deque< std::pair< uint32_t, std::shared_ptr< std::vector< operation_notice > > > > _reversible_ops;
+      boost::signals2::connection            _pre_apply_block_conn;
+      boost::signals2::connection            _post_apply_operation_conn;
+      boost::signals2::connection            _post_apply_block_conn;
+      boost::signals2::connection            _irreversible_block_conn;
+
+      asio::io_service                       _ios;
+      asio::io_service::work                 _work;
+      shared_ptr< std::thread >              _thread;
+};
+
+void subscription_manager::connect( blurt::chain::database& db, const abstract_plugin& plugin )
+{
+   _db = &db;
+
+   _pre_apply_block_conn = db.add_pre_apply_block_handler(
+      [this]( const block_notification& note ){ on_pre_apply_block( note ); }, plugin, 0 );
+   _post_apply_operation_conn = db.add_post_apply_operation_handler(
+      [this]( const operation_notification& note ){ on_post_apply_operation( note ); }, plugin, 0 );
+   _post_apply_block_conn = db.add_post_apply_block_handler(
+      [this]( const block_notification& note ){ on_post_apply_block( note ); }, plugin, 0 );
+   _irreversible_block_conn = db.add_irreversible_block_handler(
+      [this]( uint32_t block_num ){ on_irreversible_block( block_num ); }, plugin, 0 );
+}
+
+void subscription_manager::stop()
+{
+   blurt::chain::util::disconnect_signal( _pre_apply_block_conn );
+   blurt::chain::util::disconnect_signal( _post_apply_operation_conn );
+   blurt::chain::util::disconnect_signal( _post_apply_block_conn );
+   blurt::chain::util::disconnect_signal( _irreversible_block_conn );
+
+   _ios.stop();
+   if( _thread )
+   {
+      _thread->join();
+      _thread.reset();
+   }
+}
+
+uint64_t subscription_manager::subscribe( websocket_server_type* server, connection_hdl hdl, const subscribe_args& args )
+{
+   subscription_filter s( args );
+
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   auto& sub = _subscribers[ hdl ];
+   FC_ASSERT( sub.subscriptions.size() < MAX_SUBSCRIPTIONS_PER_CONNECTION,
+      "A connection can have at most ${n} subscriptions", ("n", MAX_SUBSCRIPTIONS_PER_CONNECTION) );
+
+   sub.server = server;
+   uint64_t id = ++_next_id;
+   ++_counts[ size_t( s.type() ) ];
+   if( s.irreversible() )
+      ++_irreversible_count;
+   sub.subscriptions.emplace( id, std::move( s ) );
+   return id;
+}
+
+bool subscription_manager::unsubscribe( connection_hdl hdl, uint64_t id )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   auto itr = _subscribers.find( hdl );
+   if( itr == _subscribers.end() )
+      return false;
+
+   auto s = itr->second.subscriptions.find( id );
+   if( s == itr->second.subscriptions.end() )
+      return false;
+
+   --_counts[ size_t( s->second.type() ) ];
+   if( s->second.irreversible() )
+      --_irreversible_count;
+   itr->second.subscriptions.erase( s );
+
+   if( itr->second.subscriptions.empty() )
+      _subscribers.erase( itr );
+
+   return true;
+}
+
+void subscription_manager::remove( connection_hdl hdl )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   auto itr = _subscribers.find( hdl );
+   if( itr != _subscribers.end() )
+      erase( itr );
+}
+
+subscription_manager::subscriber_map::iterator subscription_manager::erase( subscriber_map::iterator itr )
+{
+   for( const auto& s : itr->second.subscriptions )
+   {
+      --_counts[ size_t( s.second.type() ) ];
+      if( s.second.irreversible() )
+         --_irreversible_count;
+   }
+
+   return _subscribers.erase( itr );
+}
+
+void subscription_manager::on_pre_apply_block( const block_notification& )
+{
+   // Left over when the previous block failed to apply.
+   _block_ops.clear();
+}
+
+void subscription_manager::on_post_apply_operation( const operation_notification& note )
+{
+   // Operations of pending transactions are only published once they are included in a block.
+   if( !has_subscribers( subscription_type::operations ) || !_db->is_processing_block() )
+      return;
+
+   operation_notice op;
+   op.trx_id = note.trx_id;
+   op.block = note.block;
+   op.trx_in_block = note.trx_in_block;
+   op.op_in_trx = note.op_in_trx;
+   op.virtual_op = note.virtual_op;
+   op.op = note.op;
+   _block_ops.push_back( std::move( op ) );
+}
+
+void subscription_manager::on_post_apply_block( const block_notification& note )
+{
+   std::shared_ptr< block_notice > block;
+   if( has_subscribers( subscription_type::head_block ) )
+   {
+      block = std::make_shared< block_notice >();
+      block->block_num = note.block_num;
+      block->block_id = note.block_id;
+      block->block = note.block;
+   }
+
+   auto ops = std::make_shared< std::vector< operation_notice > >( std::move( _block_ops ) );
+   _block_ops.clear();
+
+   for( auto& op : *ops )
+   {
+      op.block_id = note.block_id;
+      op.timestamp = note.block.timestamp;
+   }
+
+   if( _irreversible_count.load() > 0 )
+   {
+      // Blocks at or above this one were popped in a fork switch, their operations never become irreversible.
+      while( _reversible_ops.size() && _reversible_ops.back().first >= note.block_num )
+         _reversible_ops.pop_back();
+
+      if( ops->size() )
+         _reversible_ops.emplace_back( note.block_num, ops );
+   }
+   else
+   {
+      _reversible_ops.clear();
+   }
+
+   if( !block && ops->empty() )
+      return;
+
+   _ios.post( [this, block, ops]()
+   {
+      if( block )
+      {
+         publish(
+            []( const subscription_filter& s ) { return s.type() == subscription_type::head_block; },
+            [&block]() { return notification( "on_head_block", *block ); } );
+      }
+
+      publish_operations( *ops, false );
+   });
+}
+
+void subscription_manager::on_irreversible_block( uint32_t block_num )
+{
+   std::vector< std::shared_ptr< std::vector< operation_notice > > > irreversible_ops;
+   while( _reversible_ops.size() && _reversible_ops.front().first <= block_num )
+   {
+      irreversible_ops.push_back( std::move( _reversible_ops.front().second ) );
+      _reversible_ops.pop_front();
+   }
+
+   bool notify_block = has_subscribers( subscription_type::irreversible_block );
+   if( !notify_block && irreversible_ops.empty() )
+      return;
+
+   _ios.post( [this, block_num, notify_block, irreversible_ops]()
+   {
+      if( notify_block )
       {
-         for( uint32_t i = 0; i < thread_pool_size; ++i )
-            thread_pool.create_thread( boost::bind( &asio::io_service::run, &thread_pool_ios ) );
+         irreversible_block_notice notice;
+         notice.block_num = block_num;
+
+         publish(
+            []( const subscription_filter& s ) { return s.type() == subscription_type::irreversible_block; },
+            [&notice]() { return notification( "on_irreversible_block", notice ); } );
       }
 
+      for( const auto& ops : irreversible_ops )
+         publish_operations( *ops, true );
+   });
+}
+
+void subscription_manager::publish_operations( const std::vector< operation_notice >& ops, bool irreversible )
+{
+   flat_set< protocol::account_name_type > impacted;
+   for( const auto& op : ops )
+   {
+      string type = operation_type_name( op.op );
+      impacted.clear();
+      blurt::app::operation_get_impacted_accounts( op.op, impacted );
+
+      publish(
+         [&type, &impacted, irreversible]( const subscription_filter& s )
+         {
+            return s.irreversible() == irreversible && s.matches_operation( type, impacted );
+         },
+         [&op]() { return notification( "on_operation", op ); } );
+   }
+}
+
+void subscription_manager::publish( const std::function< bool( const subscription_filter& ) >& matches, const std::function< string() >& serialize )
+{
+   // Serialized on first match, so notifications nobody wants cost nothing.
+   optional< string > message;
+
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   for( auto itr = _subscribers.begin(); itr != _subscribers.end(); )
+   {
+      bool match = false;
+      for( const auto& s : itr->second.subscriptions )
+      {
+         if( matches( s.second ) )
+         {
+            match = true;
+            break;
+         }
+      }
+
+      if( !match )
+      {
+         ++itr;
+         continue;
+      }
+
+      if( !message )
+         message = serialize();
+
+      if( send( itr->first, itr->second, *message ) )
+         ++itr;
+      else
+         itr = erase( itr );
+   }
+}
+
+bool subscription_manager::send( connection_hdl hdl, const subscriber& sub, const string& message )
+{
+   websocketpp::lib::error_code ec;
+   auto con = sub.server->get_con_from_hdl( hdl, ec );
+   if( ec )
+      return false;
+
+   if( con->get_buffered_amount() > _max_buffered )
+   {
+      wlog( "Closing websocket subscriber which fell ${n} bytes behind", ("n", con->get_buffered_amount()) );
+      con->close( websocketpp::close::status::try_again_later, "Subscriber too slow", ec );
+      return false;
+   }
+
+   ec = con->send( message, websocketpp::frame::opcode::text );
+   return !ec;
+}
+
+class webserver_plugin_impl
+{
+   public:
+      webserver_plugin_impl(thread_pool_size_t thread_pool_size) :
+         default_pool( new api_thread_pool( "default", thread_pool_size ) )
+      {}
+
       void start_webserver();
       void stop_webserver();
 
+      void configure_server( websocket_server_type& server );
+      void configure_socket( connection_hdl, tcp::socket& socket );
+
+      bool validate_ws_connection( websocket_server_type*, connection_hdl );
       void handle_ws_message( websocket_server_type*, connection_hdl, detail::websocket_server_type::message_ptr );
       void handle_http_message( websocket_server_type*, connection_hdl );
+      void set_http_body( const websocket_server_type::connection_ptr& con, string body );
+      void set_http_busy( const websocket_server_type::connection_ptr& con );
+
+      string client_id( const websocket_server_type::connection_ptr& con );
+      bool is_subscription_request( const string& body )const;
+      string handle_subscription_request( websocket_server_type* server, connection_hdl hdl, const string& body, const string& client );
+      void add_thread_pool( const std::vector< string >& apis, thread_pool_size_t size );
+      api_thread_pool& route( const string& body );
+      bool queue_full( const api_thread_pool& pool )const;
+      bool past_deadline( const fc::time_point& received )const;
 
       shared_ptr< std::thread >  http_thread;
       asio::io_service           http_ios;
@@ -105,14 +891,58 @@ class webserver_plugin_impl
       optional< tcp::endpoint >  ws_endpoint;
       websocket_server_type      ws_server;
 
-      boost::thread_group        thread_pool;
-      asio::io_service           thread_pool_ios;
-      asio::io_service::work     thread_pool_work;
+      std::unique_ptr< api_thread_pool >                default_pool;
+      std::vector< std::unique_ptr< api_thread_pool > > api_pools;
+      /// Dedicated pool of each routed API ("api") or API method ("api.method").
+      map< string, api_thread_pool* >                   pool_routes;
+
+      /// Responses of at least this many bytes are compressed when the client accepts it, 0 disables compression.
+      uint64_t                   compression_threshold = 0;
+      uint64_t                   max_body_size = 0;
+      /// Idle seconds before TCP keepalive probes are sent on accepted sockets, 0 leaves keepalive off.
+      uint32_t                   tcp_keepalive_seconds = 0;
+
+      /// Requests waiting for a thread of a pool are refused above this, 0 means no limit.
+      uint32_t                   max_queued_requests = 0;
+      /// Requests which waited longer than this for a pool thread are dropped, 0 disables the deadline.
+      fc::microseconds           queue_deadline;
+      /// Header carrying the client address when behind a reverse proxy, empty to use the peer address.
+      string                     client_ip_header;
+
+      /// Websocket subscriptions to chain events, not set when disabled.
+      std::unique_ptr< subscription_manager > subscriptions;
+      /// Bytes of notifications a subscriber can fall behind before it is disconnected, 0 disables subscriptions.
+      uint64_t                   subscription_buffer_size = 0;
 
       plugins::json_rpc::json_rpc_plugin* api;
       boost::signals2::connection         chain_sync_con;
 };
 
+void webserver_plugin_impl::configure_server( websocket_server_type& server )
+{
+   server.set_max_http_body_size( max_body_size );
+   server.set_max_message_size( max_body_size );
+
+   if( tcp_keepalive_seconds )
+      server.set_socket_init_handler( boost::bind( &webserver_plugin_impl::configure_socket, this, _1, _2 ) );
+}
+
+void webserver_plugin_impl::configure_socket( connection_hdl, tcp::socket& socket )
+{
+   boost::system::error_code ec;
+   socket.set_option( asio::socket_base::keep_alive( true ), ec );
+   if( ec )
+   {
+      wlog( "Could not enable TCP keepalive: ${e}", ("e", ec.message()) );
+      return;
+   }
+
+#ifdef TCP_KEEPIDLE
+   int idle = static_cast< int >( tcp_keepalive_seconds );
+   setsockopt( socket.native_handle(), IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof( idle ) );
+#endif
+}
+
 void webserver_plugin_impl::start_webserver()
 {
    if( ws_endpoint )
@@ -126,9 +956,14 @@ void webserver_plugin_impl::start_webserver()
             ws_server.clear_error_channels( websocketpp::log::elevel::all );
             ws_server.init_asio( &ws_ios );
             ws_server.set_reuse_addr( true );
+            configure_server( ws_server );
 
+            ws_server.set_validate_handler( boost::bind( &webserver_plugin_impl::validate_ws_connection, this, &ws_server, _1 ) );
             ws_server.set_message_handler( boost::bind( &webserver_plugin_impl::handle_ws_message, this, &ws_server, _1, _2 ) );
 
+            if( subscriptions )
+               ws_server.set_close_handler( [this]( connection_hdl hdl ){ subscriptions->remove( hdl ); } );
+
             if( http_endpoint && http_endpoint == ws_endpoint )
             {
                ws_server.set_http_handler( boost::bind( &webserver_plugin_impl::handle_http_message, this, &ws_server, _1 ) );
@@ -160,6 +995,7 @@ void webserver_plugin_impl::start_webserver()
             http_server.clear_error_channels( websocketpp::log::elevel::all );
             http_server.init_asio( &http_ios );
             http_server.set_reuse_addr( true );
+            configure_server( http_server );
 
             http_server.set_http_handler( boost::bind( &webserver_plugin_impl::handle_http_message, this, &http_server, _1 ) );
 
@@ -180,14 +1016,18 @@ void webserver_plugin_impl::start_webserver()
 
 void webserver_plugin_impl::stop_webserver()
 {
+   if( subscriptions )
+      subscriptions->stop();
+
    if( ws_server.is_listening() )
    ws_server.stop_listening();
 
    if( http_server.is_listening() )
       http_server.stop_listening();
 
-   thread_pool_ios.stop();
-   thread_pool.join_all();
+   default_pool->stop();
+   for( auto& pool : api_pools )
+      pool->stop();
 
    if( ws_thread )
    {
@@ -204,18 +1044,196 @@ void webserver_plugin_impl::stop_webserver()
    }
 }
 
+string webserver_plugin_impl::client_id( const websocket_server_type::connection_ptr& con )
+{
+   if( client_ip_header.size() )
+   {
+      // Earlier addresses are supplied by the client and cannot be trusted, the last one is added by the proxy.
+      string forwarded = con->get_request_header( client_ip_header );
+      auto pos = forwarded.rfind( ',' );
+      string address = boost::algorithm::trim_copy( pos == string::npos ? forwarded : forwarded.substr( pos + 1 ) );
+
+      if( address.size() )
+         return address;
+   }
+
+   boost::system::error_code ec;
+   auto endpoint = con->get_raw_socket().remote_endpoint( ec );
+   return ec ? string() : endpoint.address().to_string();
+}
+
+void webserver_plugin_impl::add_thread_pool( const std::vector< string >& apis, thread_pool_size_t size )
+{
+   api_pools.emplace_back( new api_thread_pool( apis.front(), size ) );
+
+   for( const auto& api : apis )
+   {
+      FC_ASSERT( pool_routes.find( api ) == pool_routes.end(), "${api} is routed to more than one thread pool", ("api", api) );
+      pool_routes[ api ] = api_pools.back().get();
+   }
+}
+
+api_thread_pool& webserver_plugin_impl::route( const string& body )
+{
+   if( pool_routes.empty() )
+      return *default_pool;
+
+   std::vector< string > methods;
+   if( !request_scanner( body ).scan( methods ) || methods.empty() )
+      return *default_pool;
+
+   // A batch goes to a dedicated pool only when all of its requests do.
+   api_thread_pool* pool = nullptr;
+   for( const auto& method : methods )
+   {
+      auto itr = pool_routes.find( method );
+      if( itr == pool_routes.end() )
+         itr = pool_routes.find( method.substr( 0, method.find( '.' ) ) );
+
+      api_thread_pool* method_pool = itr != pool_routes.end() ? itr->second : default_pool.get();
+      if( pool && pool != method_pool )
+         return *default_pool;
+      pool = method_pool;
+   }
+
+   return *pool;
+}
+
+bool webserver_plugin_impl::queue_full( const api_thread_pool& pool )const
+{
+   return max_queued_requests && pool.queued.load() >= max_queued_requests;
+}
+
+bool webserver_plugin_impl::past_deadline( const fc::time_point& received )const
+{
+   return queue_deadline.count() && fc::time_point::now() - received > queue_deadline;
+}
+
+bool webserver_plugin_impl::is_subscription_request( const string& body )const
+{
+   if( !subscriptions || body.find( SUBSCRIPTION_API_PREFIX ) == string::npos )
+      return false;
+
+   // Only single requests, subscriptions cannot be part of a batch.
+   auto first = body.find_first_not_of( " \t\n\r" );
+   if( first == string::npos || body[ first ] != '{' )
+      return false;
+
+   std::vector< string > methods;
+   return request_scanner( body ).scan( methods ) && methods.size() == 1
+      && boost::algorithm::starts_with( methods[0], SUBSCRIPTION_API_PREFIX );
+}
+
+string webserver_plugin_impl::handle_subscription_request( websocket_server_type* server, connection_hdl hdl, const string& body,
+   const string& client )
+{
+   fc::variant id;
+
+   try
+   {
+      auto request = fc::json::from_string( body, fc::json::fast_parser ).get_object();
+      if( request.contains( "id" ) )
+         id = request[ "id" ];
+
+      FC_ASSERT( request.contains( "method" ), "A member \"method\" does not exist" );
+      string method = request[ "method" ].as_string();
+      fc::variant params = request.contains( "params" ) ? request[ "params" ] : fc::variant( fc::variant_object() );
+
+      // Legacy call structure: ["subscription_api", "method", args]
+      if( method == "call" )
+      {
+         const auto& v = params.get_array();
+         FC_ASSERT( v.size() == 2 || v.size() == 3, "params should be {\"api\", \"method\", \"args\"" );
+         method = v[0].as_string() + '.' + v[1].as_string();
+         params = v.size() == 3 ? v[2] : fc::variant( fc::variant_object() );
+      }
+
+      // Subscriptions are answered here, not by json_rpc, so they are rate limited here too.
+      fc::microseconds retry_after;
+      if( !api->admit( client, method, retry_after ) )
+      {
+         STATSD_INCREMENT( "jsonrpc", "admission", "rate_limited", 1.0f );
+         return rpc_error_response( id, JSON_RPC_RATE_LIMITED, "Rate limit exceeded, retry later",
+            fc::variant( fc::mutable_variant_object( "retry_after_ms", ( retry_after.count() + 999 ) / 1000 ) ) );
+      }
+
+      if( method == SUBSCRIPTION_API_PREFIX "subscribe" )
+      {
+         uint64_t subscription = subscriptions->subscribe( server, hdl, params.as< subscribe_args >() );
+         return rpc_result_response( id, fc::mutable_variant_object( "subscription", subscription ) );
+      }
+
+      if( method == SUBSCRIPTION_API_PREFIX "unsubscribe" )
+         return rpc_result_response( id, subscriptions->unsubscribe( hdl, params.as< unsubscribe_args >().subscription ) );
+
+      return rpc_error_response( id, JSON_RPC_METHOD_NOT_FOUND, "Could not find method " + method );
+   }
+   catch( fc::parse_error_exception& e )
+   {
+      return rpc_error_response( id, JSON_RPC_PARSE_ERROR, e.to_string() );
+   }
+   catch( fc::exception& e )
+   {
+      return rpc_error_response( id, JSON_RPC_INVALID_PARAMS, e.to_string() );
+   }
+}
+
+bool webserver_plugin_impl::validate_ws_connection( websocket_server_type* server, connection_hdl hdl )
+{
+   auto con = server->get_con_from_hdl( hdl );
+
+   for( const auto& subprotocol : con->get_requested_subprotocols() )
+   {
+      if( subprotocol == RAW_SUBPROTOCOL )
+      {
+         con->select_subprotocol( subprotocol );
+         break;
+      }
+   }
+
+   return true;
+}
+
 void webserver_plugin_impl::handle_ws_message( websocket_server_type* server, connection_hdl hdl, detail::websocket_server_type::message_ptr msg )
 {
    auto con = server->get_con_from_hdl( hdl );
+   api_thread_pool* pool = default_pool.get();
+   bool subscription_request = false;
+
+   if( msg->get_opcode() == websocketpp::frame::opcode::text )
+   {
+      subscription_request = is_subscription_request( msg->get_payload() );
+      if( !subscription_request )
+         pool = &route( msg->get_payload() );
+   }
 
-   thread_pool_ios.post( [con, msg, this]()
+   if( queue_full( *pool ) )
+   {
+      con->send( server_busy_response() );
+      return;
+   }
+
+   fc::time_point received = fc::time_point::now();
+   string client = client_id( con );
+
+   pool->post( [server, hdl, con, msg, received, client, pool, subscription_request, this]()
    {
       try
       {
-         if( msg->get_opcode() == websocketpp::frame::opcode::text )
-            con->send( api->call( msg->get_payload() ) );
-         else
+         if( past_deadline( received ) )
+            con->send( server_busy_response() );
+         else if( subscription_request )
+            con->send( handle_subscription_request( server, hdl, msg->get_payload(), client ) );
+         else if( msg->get_opcode() != websocketpp::frame::opcode::text )
             con->send( "error: string payload expected" );
+         else if( con->get_subprotocol() == RAW_SUBPROTOCOL )
+         {
+            // Only API responses are binary, errors of the webserver itself stay text.
+            auto packed = api->call_raw( msg->get_payload(), pool->batch_dispatcher, received, client );
+            con->send( packed.data(), packed.size(), websocketpp::frame::opcode::binary );
+         }
+         else
+            con->send( api->call( msg->get_payload(), pool->batch_dispatcher, received, client ) );
       }
       catch( fc::exception& e )
       {
@@ -245,16 +1263,43 @@ void webserver_plugin_impl::handle_ws_message( websocket_server_type* server, co
 void webserver_plugin_impl::handle_http_message( websocket_server_type* server, connection_hdl hdl )
 {
    auto con = server->get_con_from_hdl( hdl );
+   api_thread_pool* pool = &route( con->get_request_body() );
+
+   // Refused on the io thread, so a full queue does not grow any further.
+   if( queue_full( *pool ) )
+   {
+      set_http_busy( con );
+      return;
+   }
+
    con->defer_http_response();
+   fc::time_point received = fc::time_point::now();
+   string client = client_id( con );
 
-   thread_pool_ios.post( [con, this]()
+   pool->post( [con, received, client, pool, this]()
    {
+      if( past_deadline( received ) )
+      {
+         set_http_busy( con );
+         con->send_http_response();
+         return;
+      }
+
       auto body = con->get_request_body();
 
       try
       {
-         con->set_body( api->call( body ) );
-         con->append_header( "Content-Type", "application/json" );
+         if( accepts_raw_results( con->get_request_header( "Accept" ) ) )
+         {
+            auto packed = api->call_raw( body, pool->batch_dispatcher, received, client );
+            set_http_body( con, string( packed.begin(), packed.end() ) );
+            con->append_header( "Content-Type", RAW_CONTENT_TYPE );
+         }
+         else
+         {
+            set_http_body( con, api->call( body, pool->batch_dispatcher, received, client ) );
+            con->append_header( "Content-Type", "application/json" );
+         }
          con->set_status( websocketpp::http::status_code::ok );
       }
       catch( fc::exception& e )
@@ -288,6 +1333,39 @@ void webserver_plugin_impl::handle_http_message( websocket_server_type* server,
    });
 }
 
+void webserver_plugin_impl::set_http_body( const websocket_server_type::connection_ptr& con, string body )
+{
+   // Runs on the thread pool, so compression never blocks the io service threads.
+   if( compression_threshold && body.size() >= compression_threshold )
+   {
+      con->append_header( "Vary", "Accept-Encoding" );
+
+      switch( negotiate_content_encoding( con->get_request_header( "Accept-Encoding" ) ) )
+      {
+         case content_encoding::gzip:
+            body = fc::gzip_compress( body );
+            con->append_header( "Content-Encoding", "gzip" );
+            break;
+         case content_encoding::deflate:
+            body = fc::zlib_compress( body );
+            con->append_header( "Content-Encoding", "deflate" );
+            break;
+         case content_encoding::identity:
+            break;
+      }
+   }
+
+   con->set_body( std::move( body ) );
+}
+
+void webserver_plugin_impl::set_http_busy( const websocket_server_type::connection_ptr& con )
+{
+   con->set_body( server_busy_response() );
+   con->append_header( "Content-Type", "application/json" );
+   con->append_header( "Retry-After", "1" );
+   con->set_status( websocketpp::http::status_code::service_unavailable );
+}
+
 } // detail
 
 webserver_plugin::webserver_plugin() {}
@@ -301,6 +1379,24 @@ void webserver_plugin::set_program_options( options_description&, options_descri
       ("rpc-endpoint", bpo::value< string >(), "Local http and websocket endpoint for webserver requests. Deprecated in favor of webserver-http-endpoint and webserver-ws-endpoint" )
       ("webserver-thread-pool-size", bpo::value<thread_pool_size_t>()->default_value(32),
        "Number of threads used to handle queries. Default: 32.")
+      ("webserver-api-thread-pool", bpo::value< std::vector< string > >()->composing(),
+       "Dedicated thread pool for some APIs or API methods, as api[,api.method...]=threads, e.g. network_broadcast_api=4. "
+       "Requests of other APIs are handled by the webserver-thread-pool-size threads. Can be specified multiple times.")
+      ("webserver-http-compression-threshold", bpo::value< uint64_t >()->default_value( 1024 ),
+       "Compress HTTP responses of at least this many bytes with gzip or deflate when the client accepts it. 0 disables compression.")
+      ("webserver-max-body-size", bpo::value< uint64_t >()->default_value( 32000000 ),
+       "Maximum size in bytes of an HTTP request body or websocket message.")
+      ("webserver-tcp-keepalive-seconds", bpo::value< uint32_t >()->default_value( 0 ),
+       "Idle seconds before TCP keepalive probes are sent on client connections. 0 disables TCP keepalive.")
+      ("webserver-max-queued-requests", bpo::value< uint32_t >()->default_value( 0 ),
+       "Maximum number of requests waiting for a thread of each thread pool. Requests over the limit fail with a server busy error. 0 means no limit.")
+      ("webserver-queue-deadline-ms", bpo::value< uint32_t >()->default_value( 0 ),
+       "Requests waiting for a thread longer than this many milliseconds fail with a server busy error. 0 disables the deadline.")
+      ("webserver-subscription-buffer-size", bpo::value< uint64_t >()->default_value( 16*1024*1024 ),
+       "Bytes of notifications a websocket subscriber can fall behind before it is disconnected. 0 disables subscriptions.")
+      ("webserver-client-ip-header", bpo::value< string >(),
+       "Request header holding the client address when behind a reverse proxy, e.g. X-Forwarded-For. "
+       "The last address in the header identifies the client for rate limiting.")
       ;
 }
 
@@ -313,6 +1409,41 @@ void webserver_plugin::plugin_initialize( const variables_map& options )
    ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
    my.reset(new detail::webserver_plugin_impl(thread_pool_size));
 
+   my->compression_threshold = options.at( "webserver-http-compression-threshold" ).as< uint64_t >();
+   my->max_body_size = options.at( "webserver-max-body-size" ).as< uint64_t >();
+   FC_ASSERT( my->max_body_size > 0, "webserver-max-body-size must be greater than 0" );
+   my->tcp_keepalive_seconds = options.at( "webserver-tcp-keepalive-seconds" ).as< uint32_t >();
+
+   if( options.count( "webserver-api-thread-pool" ) )
+   {
+      for( const string& entry : options.at( "webserver-api-thread-pool" ).as< std::vector< string > >() )
+      {
+         std::vector< string > v;
+         boost::split( v, entry, boost::is_any_of( "=" ) );
+         FC_ASSERT( v.size() == 2, "Invalid webserver-api-thread-pool ${e}, expected api[,api...]=threads", ("e", entry) );
+
+         std::vector< string > apis;
+         boost::split( apis, v[0], boost::is_any_of( "," ) );
+         for( auto& api : apis )
+         {
+            boost::trim( api );
+            FC_ASSERT( api.size(), "Invalid webserver-api-thread-pool ${e}, empty API name", ("e", entry) );
+         }
+
+         auto size = boost::lexical_cast< thread_pool_size_t >( boost::trim_copy( v[1] ) );
+         FC_ASSERT( size > 0, "Thread pool size of ${e} must be greater than 0", ("e", entry) );
+
+         my->add_thread_pool( apis, size );
+         ilog( "configured ${tps} threads for ${apis}", ("tps", size)("apis", apis) );
+      }
+   }
+   my->max_queued_requests = options.at( "webserver-max-queued-requests" ).as< uint32_t >();
+   my->queue_deadline = fc::milliseconds( options.at( "webserver-queue-deadline-ms" ).as< uint32_t >() );
+   my->subscription_buffer_size = options.at( "webserver-subscription-buffer-size" ).as< uint64_t >();
+
+   if( options.count( "webserver-client-ip-header" ) )
+      my->client_ip_header = options.at( "webserver-client-ip-header" ).as< string >();
+
    if( options.count( "webserver-http-endpoint" ) )
    {
       auto http_endpoint = options.at( "webserver-http-endpoint" ).as< string >();
@@ -359,6 +1490,13 @@ void webserver_plugin::plugin_startup()
    FC_ASSERT( my->api != nullptr, "Could not find API Register Plugin" );
 
    plugins::chain::chain_plugin* chain = appbase::app().find_plugin< plugins::chain::chain_plugin >();
+
+   if( chain != nullptr && my->ws_endpoint && my->subscription_buffer_size )
+   {
+      my->subscriptions.reset( new detail::subscription_manager( my->subscription_buffer_size ) );
+      my->subscriptions->connect( chain->db(), *this );
+   }
+
    if( chain != nullptr && chain->get_state() != appbase::abstract_plugin::started )
    {
       ilog( "Waiting for chain plugin to start" );
@@ -379,3 +1517,8 @@ void webserver_plugin::plugin_shutdown()
 }
 
 } } } // blurt::plugins::webserver
+
+FC_REFLECT( blurt::plugins::webserver::detail::unsubscribe_args, (subscription) )
+FC_REFLECT( blurt::plugins::webserver::detail::block_notice, (block_num)(block_id)(block) )
+FC_REFLECT( blurt::plugins::webserver::detail::irreversible_block_notice, (block_num) )
+FC_REFLECT( blurt::plugins::webserver::detail::operation_notice, (trx_id)(block)(block_id)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(op) )
@@ -3,6 +3,8 @@
 #include <blurt/protocol/config.hpp>
 #include <blurt/protocol/asset_symbol.hpp>
 
+#include <fc/io/json_writer.hpp>
+
 namespace blurt { namespace protocol {
 
    struct asset
@@ -156,4 +158,5 @@ namespace fc {
 }
 
 FC_REFLECT( blurt::protocol::asset, (amount)(symbol) )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::asset )
 FC_REFLECT( blurt::protocol::price, (base)(quote) )
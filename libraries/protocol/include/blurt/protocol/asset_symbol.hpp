@@ -1,6 +1,7 @@
 #pragma once
 
 #include <fc/io/raw.hpp>
+#include <fc/io/json_writer.hpp>
 #include <blurt/protocol/types_fwd.hpp>
 
 #define BLURT_ASSET_SYMBOL_PRECISION_BITS    4
@@ -126,6 +127,7 @@ class asset_symbol_type
 } } // blurt::protocol
 
 FC_REFLECT(blurt::protocol::asset_symbol_type, (asset_num))
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::asset_symbol_type )
 
 namespace fc { namespace raw {
 
@@ -136,3 +136,4 @@ FC_REFLECT( blurt::protocol::legacy_blurt_asset,
    (amount)
    (symbol)
    )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::legacy_blurt_asset )
@@ -18,6 +18,7 @@
 #include <fc/container/flat.hpp>
 #include <fc/string.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/uint128.hpp>
 #include <fc/static_variant.hpp>
 #include <fc/smart_ref_fwd.hpp>
@@ -172,6 +173,10 @@ FC_REFLECT( blurt::protocol::extended_public_key_type::binary_key, (check)(data)
 FC_REFLECT( blurt::protocol::extended_private_key_type, (key_data) )
 FC_REFLECT( blurt::protocol::extended_private_key_type::binary_key, (check)(data) )
 
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::public_key_type )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::extended_public_key_type )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::extended_private_key_type )
+
 FC_REFLECT_TYPENAME( blurt::protocol::share_type )
 
 FC_REFLECT( blurt::void_t, )
@@ -79,7 +79,10 @@ namespace fc
 } // fc
 
 #include <fc/reflect/reflect.hpp>
+#include <fc/io/json_writer.hpp>
 FC_REFLECT( blurt::protocol::version, (v_num) )
 FC_REFLECT_DERIVED( blurt::protocol::hardfork_version, (blurt::protocol::version), )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::version )
+FC_JSON_WRITE_THROUGH_VARIANT( blurt::protocol::hardfork_version )
 
 FC_REFLECT( blurt::protocol::hardfork_version_vote, (hf_version)(hf_time) )
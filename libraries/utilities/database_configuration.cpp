@@ -24,6 +24,7 @@ struct global {
    database::configuration::write_buffer_manager write_buffer_manager;
    uint64_t object_count;
    bool statistics;
+   std::map< std::string, std::string > index_placement;
 };
 
 struct bloom_filter_policy {
@@ -40,6 +41,7 @@ struct block_based_table_options {
 struct base_index {
    bool optimize_level_style_compaction;
    bool increase_parallelism;
+   uint32_t stats_dump_period_sec;
    database::configuration::block_based_table_options block_based_table_options;
 };
 
@@ -58,6 +60,10 @@ fc::variant default_database_configuration()
    config.global.object_count = 62500; // 4GB heaviest usage
    config.global.statistics = false;   // Incurs severe performance degradation when true
 
+   // global::index_placement
+   // Empty, every index lives in RocksDB ("mira"). Indices placed in memory ("bmic") only reach disk on a
+   // clean shutdown, so any crash of a node holding them requires a full replay. See doc/devs/mira.md.
+
    // global::shared_cache
    config.global.shared_cache.capacity = std::to_string( GB(5) );
 
@@ -67,6 +73,7 @@ fc::variant default_database_configuration()
    // base
    config.base.optimize_level_style_compaction = true;
    config.base.increase_parallelism = true;
+   config.base.stats_dump_period_sec = 600; // Period at which statistics are written to each index LOG, consumed by rocksdb_advisor.sh
 
    // base::block_based_table_options
    config.base.block_based_table_options.block_size = KB(8);
@@ -97,6 +104,7 @@ FC_REFLECT( blurt::utilities::database::configuration::global,
    (write_buffer_manager)
    (object_count)
    (statistics)
+   (index_placement)
 );
 
 FC_REFLECT( blurt::utilities::database::configuration::bloom_filter_policy,
@@ -113,6 +121,7 @@ FC_REFLECT( blurt::utilities::database::configuration::block_based_table_options
 FC_REFLECT( blurt::utilities::database::configuration::base_index,
    (optimize_level_style_compaction)
    (increase_parallelism)
+   (stats_dump_period_sec)
    (block_based_table_options)
 );
 
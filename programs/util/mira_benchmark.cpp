@@ -0,0 +1,751 @@
+/*
+ * Drives chain indices through representative access patterns and reports throughput
+ * and latency percentiles for each storage backend.
+ *
+ * Backends:
+ *    bmic - boost multi index container (shared memory, or process memory when built with MIRA)
+ *    mira - RocksDB backed multi index container (only available when built with MIRA)
+ *
+ * Workloads:
+ *    create      - populate the index
+ *    lookup      - random point lookups, on a secondary key where the index has one
+ *    scan        - lower_bound on a secondary key followed by a bounded forward scan
+ *    modify      - random modifications that do not change any key, as done by votes
+ *    undo_squash - blocks of transactions in nested undo sessions; transactions are squashed
+ *                  into their block and every other block is undone
+ */
+
+#include <blurt/chain/account_object.hpp>
+#include <blurt/chain/comment_object.hpp>
+#include <blurt/chain/history_object.hpp>
+
+#include <blurt/utilities/database_configuration.hpp>
+
+#include <chainbase/chainbase.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/reflect/variant.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+namespace bfs = boost::filesystem;
+
+using namespace blurt::chain;
+
+struct benchmark_result
+{
+   std::string backend;
+   std::string index;
+   std::string workload;
+   uint64_t    operations = 0;
+   double      ops_per_sec = 0;
+   uint64_t    p50_ns = 0;
+   uint64_t    p90_ns = 0;
+   uint64_t    p99_ns = 0;
+   uint64_t    p999_ns = 0;
+   uint64_t    max_ns = 0;
+};
+
+FC_REFLECT( benchmark_result, (backend)(index)(workload)(operations)(ops_per_sec)(p50_ns)(p90_ns)(p99_ns)(p999_ns)(max_ns) )
+
+struct benchmark_args
+{
+   uint64_t object_count = 0;
+   uint64_t operation_count = 0;
+   uint32_t scan_length = 0;
+   uint32_t ops_per_block = 0;
+   uint32_t ops_per_transaction = 0;
+   uint64_t seed = 0;
+};
+
+class latency_recorder
+{
+   public:
+      latency_recorder( uint64_t expected )
+      {
+         _samples.reserve( expected );
+      }
+
+      template< typename Operation >
+      void measure( Operation&& op )
+      {
+         auto start = std::chrono::steady_clock::now();
+         op();
+         auto end = std::chrono::steady_clock::now();
+         _samples.push_back( std::chrono::duration_cast< std::chrono::nanoseconds >( end - start ).count() );
+      }
+
+      benchmark_result result( const std::string& backend, const std::string& index, const std::string& workload )
+      {
+         benchmark_result r;
+         r.backend = backend;
+         r.index = index;
+         r.workload = workload;
+         r.operations = _samples.size();
+
+         if( _samples.empty() )
+            return r;
+
+         uint64_t total_ns = 0;
+         for( auto s : _samples )
+            total_ns += s;
+
+         std::sort( _samples.begin(), _samples.end() );
+
+         r.ops_per_sec = total_ns ? double( _samples.size() ) * 1000000000.0 / double( total_ns ) : 0;
+         r.p50_ns = percentile( 0.5 );
+         r.p90_ns = percentile( 0.9 );
+         r.p99_ns = percentile( 0.99 );
+         r.p999_ns = percentile( 0.999 );
+         r.max_ns = _samples.back();
+
+         return r;
+      }
+
+   private:
+      uint64_t percentile( double p )const
+      {
+         size_t i = size_t( p * ( _samples.size() - 1 ) );
+         return _samples[ i ];
+      }
+
+      std::vector< uint64_t > _samples;
+};
+
+/**
+ * Wide object, looked up and scanned by name.
+ */
+struct account_driver
+{
+   typedef account_index index_type;
+   static const char* name() { return "account_index"; }
+
+   static account_name_type key( uint64_t i )
+   {
+      return account_name_type( "bench" + std::to_string( i ) );
+   }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< account_object >( [&]( account_object& a )
+      {
+         a.name = key( i );
+         a.recovery_account = key( 0 );
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< account_object, by_name >( key( i ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< account_index, by_name >();
+      auto itr = idx.lower_bound( key( i ) );
+      uint32_t n = 0;
+      while( itr != idx.end() && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* a = db.find< account_object, by_name >( key( i ) );
+      if( a == nullptr ) return;
+
+      db.modify( *a, []( account_object& a )
+      {
+         a.lifetime_vote_count++;
+         a.last_vote_time = fc::time_point_sec( a.lifetime_vote_count );
+      });
+   }
+};
+
+/**
+ * Narrow object with composite keys. Votes are scanned per comment and modified in place.
+ */
+struct comment_vote_driver
+{
+   static const uint64_t votes_per_comment = 64;
+
+   typedef comment_vote_index index_type;
+   static const char* name() { return "comment_vote_index"; }
+
+   static comment_id_type comment( uint64_t i ) { return comment_id_type( i / votes_per_comment ); }
+   static account_id_type voter( uint64_t i ) { return account_id_type( i % votes_per_comment ); }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< comment_vote_object >( [&]( comment_vote_object& v )
+      {
+         v.comment = comment( i );
+         v.voter = voter( i );
+         v.vote_percent = BLURT_100_PERCENT;
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< comment_vote_object, by_comment_voter >( boost::make_tuple( comment( i ), voter( i ) ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< comment_vote_index, by_comment_voter >();
+      auto c = comment( i );
+      auto itr = idx.lower_bound( c );
+      uint32_t n = 0;
+      while( itr != idx.end() && itr->comment == c && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* v = db.find< comment_vote_object, by_comment_voter >( boost::make_tuple( comment( i ), voter( i ) ) );
+      if( v == nullptr ) return;
+
+      db.modify( *v, []( comment_vote_object& v )
+      {
+         v.rshares += 1000;
+         v.weight += 1;
+         v.vote_percent = int16_t( -v.vote_percent );
+         v.num_changes++;
+         v.last_update = fc::time_point_sec( v.weight );
+      });
+   }
+};
+
+/**
+ * Wide object with string keys. Replies are grouped into threads, which are scanned by root.
+ */
+struct comment_driver
+{
+   static const uint64_t comments_per_thread = 16;
+   static const uint64_t authors = 1024;
+
+   typedef comment_index index_type;
+   static const char* name() { return "comment_index"; }
+
+   static account_name_type author( uint64_t i ) { return account_name_type( "bench" + std::to_string( i % authors ) ); }
+   static std::string permlink( uint64_t i ) { return "benchmark-post-" + std::to_string( i ); }
+   static comment_id_type root( uint64_t i ) { return comment_id_type( i - i % comments_per_thread ); }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< comment_object >( [&]( comment_object& c )
+      {
+         c.author = author( i );
+         from_string( c.permlink, permlink( i ) );
+         from_string( c.category, "benchmark" );
+         if( i % comments_per_thread )
+         {
+            c.parent_author = author( root( i )._id );
+            from_string( c.parent_permlink, permlink( root( i )._id ) );
+         }
+         else
+         {
+            from_string( c.parent_permlink, "benchmark" );
+         }
+         c.root_comment = root( i );
+         c.created = c.last_update = c.active = fc::time_point_sec( i );
+         c.cashout_time = fc::time_point_sec( i + BLURT_CASHOUT_WINDOW_SECONDS );
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< comment_object, by_permlink >( boost::make_tuple( author( i ), permlink( i ) ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< comment_index, by_root >();
+      auto r = root( i );
+      auto itr = idx.lower_bound( r );
+      uint32_t n = 0;
+      while( itr != idx.end() && itr->root_comment == r && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* c = db.find< comment_object, by_permlink >( boost::make_tuple( author( i ), permlink( i ) ) );
+      if( c == nullptr ) return;
+
+      db.modify( *c, []( comment_object& c )
+      {
+         c.net_rshares += 1000;
+         c.abs_rshares += 1000;
+         c.vote_rshares += 1000;
+         c.total_vote_weight += 1;
+         c.net_votes++;
+         c.active = fc::time_point_sec( c.net_votes );
+      });
+   }
+};
+
+/**
+ * Large variable length object, looked up by comment and rewritten by edits.
+ */
+struct comment_content_driver
+{
+   static const size_t body_size = 2048;
+
+   typedef comment_content_index index_type;
+   static const char* name() { return "comment_content_index"; }
+
+   static std::string body( uint64_t i )
+   {
+      std::string b( body_size, ' ' );
+      for( size_t c = 0; c < b.size(); ++c )
+         b[ c ] = char( 'a' + ( i + c ) % 26 );
+      return b;
+   }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< comment_content_object >( [&]( comment_content_object& c )
+      {
+         c.comment = comment_id_type( i );
+         from_string( c.title, "Benchmark post " + std::to_string( i ) );
+         from_string( c.body, body( i ) );
+         from_string( c.json_metadata, "{\"tags\":[\"benchmark\"]}" );
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< comment_content_object, by_comment >( comment_id_type( i ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< comment_content_index, by_comment >();
+      auto itr = idx.lower_bound( comment_id_type( i ) );
+      uint32_t n = 0;
+      while( itr != idx.end() && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* c = db.find< comment_content_object, by_comment >( comment_id_type( i ) );
+      if( c == nullptr ) return;
+
+      db.modify( *c, [i]( comment_content_object& c )
+      {
+         from_string( c.body, body( i + 1 ) );
+      });
+   }
+};
+
+/**
+ * Append-only serialized operations, read back block by block.
+ */
+struct operation_driver
+{
+   static const uint64_t ops_per_block = 64;
+   static const size_t op_size = 128;
+
+   typedef operation_index index_type;
+   static const char* name() { return "operation_index"; }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< operation_object >( [&]( operation_object& o )
+      {
+         o.trx_id = transaction_id_type( fc::ripemd160::hash( std::to_string( i ) ) );
+         o.block = uint32_t( i / ops_per_block );
+         o.trx_in_block = uint32_t( i % ops_per_block );
+         o.timestamp = fc::time_point_sec( o.block * BLURT_BLOCK_INTERVAL );
+         o.serialized_op.resize( op_size );
+         std::fill( o.serialized_op.begin(), o.serialized_op.end(), char( i ) );
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< operation_object >( operation_id_type( i ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< operation_index, by_location >();
+      uint32_t block = uint32_t( i / ops_per_block );
+      auto itr = idx.lower_bound( block );
+      uint32_t n = 0;
+      while( itr != idx.end() && itr->block == block && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   /// Operations are not modified on a live node, except to drop their body once irreversible.
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* o = db.find< operation_object >( operation_id_type( i ) );
+      if( o == nullptr ) return;
+
+      db.modify( *o, []( operation_object& o )
+      {
+         o.virtual_op++;
+      });
+   }
+};
+
+/**
+ * Narrow object, scanned per account from the newest entry as by get_account_history.
+ */
+struct account_history_driver
+{
+   static const uint64_t entries_per_account = 256;
+
+   typedef account_history_index index_type;
+   static const char* name() { return "account_history_index"; }
+
+   static account_name_type account( uint64_t i ) { return account_name_type( "bench" + std::to_string( i / entries_per_account ) ); }
+   static uint32_t sequence( uint64_t i ) { return uint32_t( i % entries_per_account ); }
+
+   static void create( chainbase::database& db, uint64_t i )
+   {
+      db.create< account_history_object >( [&]( account_history_object& h )
+      {
+         h.account = account( i );
+         h.sequence = sequence( i );
+         h.op = operation_id_type( i );
+      });
+   }
+
+   static bool lookup( chainbase::database& db, uint64_t i )
+   {
+      return db.find< account_history_object, by_account >( boost::make_tuple( account( i ), sequence( i ) ) ) != nullptr;
+   }
+
+   static uint32_t scan( chainbase::database& db, uint64_t i, uint32_t length )
+   {
+      const auto& idx = db.get_index< account_history_index, by_account >();
+      auto a = account( i );
+      auto itr = idx.lower_bound( boost::make_tuple( a, sequence( i ) ) );
+      uint32_t n = 0;
+      while( itr != idx.end() && itr->account == a && n < length )
+      {
+         ++n;
+         ++itr;
+      }
+      return n;
+   }
+
+   /// History entries are never modified on a live node, this only exercises the write path.
+   static void modify( chainbase::database& db, uint64_t i )
+   {
+      const auto* h = db.find< account_history_object, by_account >( boost::make_tuple( account( i ), sequence( i ) ) );
+      if( h == nullptr ) return;
+
+      db.modify( *h, []( account_history_object& h )
+      {
+         h.op = operation_id_type( h.op._id + 1 );
+      });
+   }
+};
+
+template< typename Driver >
+void run_workloads( chainbase::database& db, const std::string& backend, const benchmark_args& args, std::vector< benchmark_result >& results )
+{
+   std::mt19937_64 rng( args.seed );
+   std::uniform_int_distribution< uint64_t > dist( 0, args.object_count - 1 );
+
+   auto block_boundary = [&]( uint64_t i )
+   {
+      if( args.ops_per_block && ( i + 1 ) % args.ops_per_block == 0 )
+         db.commit_write_batches();
+   };
+
+   {
+      latency_recorder rec( args.object_count );
+      for( uint64_t i = 0; i < args.object_count; ++i )
+      {
+         rec.measure( [&](){ Driver::create( db, i ); block_boundary( i ); } );
+      }
+      db.commit_write_batches();
+      results.push_back( rec.result( backend, Driver::name(), "create" ) );
+   }
+
+   {
+      latency_recorder rec( args.operation_count );
+      for( uint64_t i = 0; i < args.operation_count; ++i )
+      {
+         auto k = dist( rng );
+         rec.measure( [&](){ Driver::lookup( db, k ); } );
+      }
+      results.push_back( rec.result( backend, Driver::name(), "lookup" ) );
+   }
+
+   {
+      latency_recorder rec( args.operation_count );
+      for( uint64_t i = 0; i < args.operation_count; ++i )
+      {
+         auto k = dist( rng );
+         rec.measure( [&](){ Driver::scan( db, k, args.scan_length ); } );
+      }
+      results.push_back( rec.result( backend, Driver::name(), "scan" ) );
+   }
+
+   {
+      latency_recorder rec( args.operation_count );
+      for( uint64_t i = 0; i < args.operation_count; ++i )
+      {
+         auto k = dist( rng );
+         rec.measure( [&](){ Driver::modify( db, k ); block_boundary( i ); } );
+      }
+      db.commit_write_batches();
+      results.push_back( rec.result( backend, Driver::name(), "modify" ) );
+   }
+
+   {
+      // Each sample is one block
+      uint32_t ops_per_block = std::max( args.ops_per_block, 1u );
+      uint32_t ops_per_transaction = std::max( args.ops_per_transaction, 1u );
+      uint64_t blocks = std::max( args.operation_count / ops_per_block, uint64_t( 1 ) );
+      uint64_t next_object = args.object_count;
+
+      latency_recorder rec( blocks );
+      for( uint64_t b = 0; b < blocks; ++b )
+      {
+         rec.measure( [&]()
+         {
+            auto block_session = db.start_undo_session();
+
+            for( uint32_t op = 0; op < ops_per_block; op += ops_per_transaction )
+            {
+               auto tx_session = db.start_undo_session();
+               for( uint32_t t = 0; t < ops_per_transaction; ++t )
+                  Driver::modify( db, dist( rng ) );
+               Driver::create( db, next_object++ );
+               tx_session.squash();
+            }
+
+            if( b % 2 )
+            {
+               block_session.undo();
+            }
+            else
+            {
+               block_session.push();
+               db.commit( db.revision() );
+            }
+
+            db.commit_write_batches();
+         });
+      }
+      results.push_back( rec.result( backend, Driver::name(), "undo_squash" ) );
+   }
+}
+
+typedef std::function< void( chainbase::database&, const std::string&, const bfs::path&, const boost::any&,
+   const benchmark_args&, std::vector< benchmark_result >& ) > index_runner;
+
+template< typename Driver >
+void run_index( chainbase::database& db, const std::string& backend, const bfs::path& db_path, const boost::any& cfg,
+   const benchmark_args& args, std::vector< benchmark_result >& results )
+{
+   db.add_index< typename Driver::index_type >();
+
+#ifdef ENABLE_MIRA
+   if( backend == "bmic" )
+      db.get_mutable_index< typename Driver::index_type >().mutable_indices().set_index_type( mira::index_type::bmic, db_path, cfg );
+#endif
+
+   db.set_batch_writes( true );
+
+   std::cerr << "Running " << backend << " benchmarks on " << Driver::name() << "\n";
+   run_workloads< Driver >( db, backend, args, results );
+}
+
+/// Benchmarked indices by name, in the order they are run.
+std::vector< std::pair< std::string, index_runner > > index_runners()
+{
+   std::vector< std::pair< std::string, index_runner > > runners;
+   runners.emplace_back( account_driver::name(), &run_index< account_driver > );
+   runners.emplace_back( comment_driver::name(), &run_index< comment_driver > );
+   runners.emplace_back( comment_content_driver::name(), &run_index< comment_content_driver > );
+   runners.emplace_back( comment_vote_driver::name(), &run_index< comment_vote_driver > );
+   runners.emplace_back( operation_driver::name(), &run_index< operation_driver > );
+   runners.emplace_back( account_history_driver::name(), &run_index< account_history_driver > );
+   return runners;
+}
+
+void run_backend( const std::string& backend, const bfs::path& dir, uint64_t shared_file_size, const std::vector< std::string >& indices,
+   const benchmark_args& args, std::vector< benchmark_result >& results )
+{
+   auto db_path = dir / bfs::unique_path();
+   bfs::create_directories( db_path );
+
+   {
+      auto cfg = blurt::utilities::default_database_configuration();
+
+      chainbase::database db;
+      db.open( db_path, chainbase::skip_nothing, shared_file_size, cfg );
+
+      for( const auto& runner : index_runners() )
+      {
+         if( std::find( indices.begin(), indices.end(), runner.first ) != indices.end() )
+            runner.second( db, backend, db_path, cfg, args, results );
+      }
+
+      db.close();
+   }
+
+   bfs::remove_all( db_path );
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description opts;
+      opts.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("backend", bpo::value< std::vector< std::string > >()->composing(), "Backend to benchmark, bmic or mira. May be specified multiple times. Defaults to every available backend.")
+         ("index", bpo::value< std::vector< std::string > >()->composing(), "Index to benchmark, e.g. comment_index. May be specified multiple times. Defaults to every index.")
+         ("data-dir", bpo::value< bfs::path >()->default_value( bfs::temp_directory_path() ), "Directory in which the benchmark databases are created")
+         ("shared-file-size", bpo::value< uint64_t >()->default_value( 8192 ), "Size of the shared memory file in MiB when bmic is backed by shared memory")
+         ("objects", bpo::value< uint64_t >()->default_value( 1000000 ), "Number of objects created in each index")
+         ("operations", bpo::value< uint64_t >()->default_value( 1000000 ), "Number of operations per workload")
+         ("scan-length", bpo::value< uint32_t >()->default_value( 100 ), "Maximum number of objects visited per range scan")
+         ("ops-per-block", bpo::value< uint32_t >()->default_value( 1000 ), "Number of writes between write batch commits and per block in the undo workload")
+         ("ops-per-transaction", bpo::value< uint32_t >()->default_value( 10 ), "Number of modifications per transaction in the undo workload")
+         ("seed", bpo::value< uint64_t >()->default_value( 0 ), "Random number generator seed")
+         ("output,o", bpo::value< bfs::path >(), "Write results as JSON to this file")
+         ;
+
+      bpo::variables_map options;
+      bpo::store( bpo::parse_command_line( argc, argv, opts ), options );
+
+      if( options.count( "help" ) )
+      {
+         std::cout << opts << "\n";
+         return 0;
+      }
+
+      benchmark_args args;
+      args.object_count = options.at( "objects" ).as< uint64_t >();
+      args.operation_count = options.at( "operations" ).as< uint64_t >();
+      args.scan_length = options.at( "scan-length" ).as< uint32_t >();
+      args.ops_per_block = options.at( "ops-per-block" ).as< uint32_t >();
+      args.ops_per_transaction = options.at( "ops-per-transaction" ).as< uint32_t >();
+      args.seed = options.at( "seed" ).as< uint64_t >();
+
+      FC_ASSERT( args.object_count > 0, "objects must be greater than zero" );
+
+      std::vector< std::string > backends;
+      if( options.count( "backend" ) )
+      {
+         backends = options.at( "backend" ).as< std::vector< std::string > >();
+      }
+      else
+      {
+         backends.push_back( "bmic" );
+#ifdef ENABLE_MIRA
+         backends.push_back( "mira" );
+#endif
+      }
+
+      for( const auto& b : backends )
+      {
+#ifdef ENABLE_MIRA
+         FC_ASSERT( b == "bmic" || b == "mira", "Unknown backend '${b}'", ("b", b) );
+#else
+         FC_ASSERT( b == "bmic", "Unknown backend '${b}', mira requires building with ENABLE_MIRA", ("b", b) );
+#endif
+      }
+
+      std::vector< std::string > indices;
+      for( const auto& runner : index_runners() )
+         indices.push_back( runner.first );
+
+      if( options.count( "index" ) )
+      {
+         auto selected = options.at( "index" ).as< std::vector< std::string > >();
+         for( const auto& i : selected )
+            FC_ASSERT( std::find( indices.begin(), indices.end(), i ) != indices.end(), "Unknown index '${i}'", ("i", i) );
+         indices = selected;
+      }
+
+      std::vector< benchmark_result > results;
+      auto shared_file_size = options.at( "shared-file-size" ).as< uint64_t >() * 1024 * 1024;
+
+      for( const auto& b : backends )
+         run_backend( b, options.at( "data-dir" ).as< bfs::path >(), shared_file_size, indices, args, results );
+
+      std::cout << std::left
+         << std::setw( 6 )  << "backend"
+         << std::setw( 23 ) << " index"
+         << std::setw( 13 ) << " workload"
+         << std::right
+         << std::setw( 12 ) << "ops/s"
+         << std::setw( 10 ) << "p50 ns"
+         << std::setw( 10 ) << "p90 ns"
+         << std::setw( 10 ) << "p99 ns"
+         << std::setw( 11 ) << "p99.9 ns"
+         << std::setw( 12 ) << "max ns" << "\n";
+
+      for( const auto& r : results )
+      {
+         std::cout << std::left
+            << std::setw( 7 )  << r.backend
+            << std::setw( 23 ) << r.index
+            << std::setw( 12 ) << r.workload
+            << std::right << std::fixed << std::setprecision( 0 )
+            << std::setw( 12 ) << r.ops_per_sec
+            << std::setw( 10 ) << r.p50_ns
+            << std::setw( 10 ) << r.p90_ns
+            << std::setw( 10 ) << r.p99_ns
+            << std::setw( 11 ) << r.p999_ns
+            << std::setw( 12 ) << r.max_ns << "\n";
+      }
+
+      if( options.count( "output" ) )
+      {
+         std::ofstream out( options.at( "output" ).as< bfs::path >().string() );
+         out << fc::json::to_pretty_string( results ) << "\n";
+      }
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+
+   return 0;
+}
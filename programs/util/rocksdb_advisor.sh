@@ -34,6 +34,7 @@ OBJECTS=( "account_authority"                \
 DATA_DIR="$HOME/.blurtd"
 BLURTD_DIR="../.."
 STATS_DUMP_PERIOD=600
+RPC_URL=""
 
 ADVISOR_PATH="../../libraries/vendor/rocksdb/tools/advisor"
 
@@ -51,21 +52,43 @@ while (( "$#" )); do
          STATS_DUMP_PERIOD=$2
          shift 2
          ;;
+      -u|--rpc-url)
+         RPC_URL=$2
+         shift 2
+         ;;
       -h|--help)
          echo "Specify data directory with '--data-dir' (Default is ~/.blurtd)"
          echo "Specify blurtd directory with '--blurtd-dir' (Default is ../..)"
          echo "Specify stats dump period with '--stats-dump-period' (Default is 600)"
+         echo "Specify a node RPC endpoint with '--rpc-url' to print live per index statistics"
          exit 1
          ;;
       *)
          echo "Specify data directory with '--data-dir' (Default is ~/.blurtd)"
          echo "Specify blurtd directory with '--blurtd-dir' (Default is ../..)"
          echo "Specify stats dump period with '--stats-dump-period' (Default is 600)"
+         echo "Specify a node RPC endpoint with '--rpc-url' to print live per index statistics"
          exit 1
          ;;
    esac
 done
 
+# Live statistics come from database_api.get_database_statistics and require
+# "statistics": true in the global section of database.cfg for the ticker values.
+if [ -n "$RPC_URL" ]; then
+   echo "Live statistics from $RPC_URL..."
+   curl -s --data '{"jsonrpc":"2.0","method":"database_api.get_database_statistics","params":{},"id":1}' "$RPC_URL" | python3 -c '
+import json, sys
+indices = json.load( sys.stdin )[ "result" ][ "indices" ]
+print( "%-40s %10s %10s %16s %16s %14s" % ( "index", "cache_hit", "read_amp", "memtable_size", "pending_compact", "stall_micros" ) )
+for idx in indices:
+   c = idx[ "counters" ]
+   print( "%-40s %10.4f %10.4f %16d %16d %14d" % ( idx[ "index" ].split( ":" )[ -1 ], idx[ "block_cache_hit_rate" ], idx[ "read_amplification" ],
+      c.get( "memtable_size", 0 ), c.get( "pending_compaction_bytes", 0 ), c.get( "stall_micros", 0 ) ) )
+'
+   echo ''
+fi
+
 cd "$BLURTD_DIR/libraries/vendor/rocksdb/tools/advisor"
 
 for OBJ in "${OBJECTS[@]}"; do
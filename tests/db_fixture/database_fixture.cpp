@@ -727,7 +727,7 @@ void sps_proposal_database_fixture::post_comment( std::string _authro, std::stri
    trx.operations.clear();
 }
 
-json_rpc_database_fixture::json_rpc_database_fixture()
+json_rpc_database_fixture::json_rpc_database_fixture( const std::vector< std::string >& args )
 {
    try {
    int argc = boost::unit_test::framework::master_test_suite().argc;
@@ -741,6 +741,10 @@ json_rpc_database_fixture::json_rpc_database_fixture()
          std::cout << "running test " << boost::unit_test::framework::current_test_case().p_name << std::endl;
    }
 
+   std::vector< char* > plugin_argv( argv, argv + argc );
+   for( const auto& arg : args )
+      plugin_argv.push_back( const_cast< char* >( arg.c_str() ) );
+
    appbase::app().register_plugin< blurt::plugins::account_history::account_history_plugin >();
    db_plugin = &appbase::app().register_plugin< blurt::plugins::debug_node::debug_node_plugin >();
    appbase::app().register_plugin< blurt::plugins::witness::witness_plugin >();
@@ -757,7 +761,7 @@ json_rpc_database_fixture::json_rpc_database_fixture()
       blurt::plugins::block_api::block_api_plugin,
       blurt::plugins::database_api::database_api_plugin,
       blurt::plugins::condenser_api::condenser_api_plugin
-      >( argc, argv );
+      >( plugin_argv.size(), plugin_argv.data() );
 
    appbase::app().get_plugin< blurt::plugins::condenser_api::condenser_api_plugin >().plugin_startup();
 
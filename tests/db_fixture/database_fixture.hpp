@@ -327,7 +327,8 @@ struct json_rpc_database_fixture : public database_fixture
 
    public:
 
-      json_rpc_database_fixture();
+      /// `args` are passed to the plugins in addition to the test's command line.
+      json_rpc_database_fixture( const std::vector< std::string >& args = std::vector< std::string >() );
       virtual ~json_rpc_database_fixture();
 
       void make_array_request( std::string& request, int64_t code = 0, bool is_warning = false, bool is_fail = true );
@@ -0,0 +1,355 @@
+#ifdef IS_TEST_NET
+#include <BoostTestTargetConfig.h>
+
+#include <blurt/chain/account_object.hpp>
+#include <blurt/chain/history_object.hpp>
+#include <blurt/protocol/blurt_operations.hpp>
+#include <blurt/plugins/account_history/account_history_plugin.hpp>
+#include <blurt/plugins/account_history_api/account_history_api_plugin.hpp>
+#include <blurt/plugins/account_history_api/account_history_api.hpp>
+#include <blurt/plugins/condenser_api/condenser_api_plugin.hpp>
+#include <blurt/plugins/condenser_api/condenser_api.hpp>
+
+#include "../db_fixture/database_fixture.hpp"
+
+using namespace blurt::chain;
+using namespace blurt::protocol;
+
+namespace ah = blurt::plugins::account_history;
+namespace condenser = blurt::plugins::condenser_api;
+
+namespace {
+
+/// Runs chainbase account history with account_history_api and condenser_api, passing `args` to the plugins.
+struct account_history_fixture : public database_fixture
+{
+   std::shared_ptr< ah::account_history_api >     history_api;
+   std::shared_ptr< condenser::condenser_api >    condenser_api;
+
+   account_history_fixture( const std::vector< std::string >& args = std::vector< std::string >() )
+   {
+      try {
+      std::vector< const char* > argv = { boost::unit_test::framework::master_test_suite().argv[0] };
+      for( const auto& arg : args )
+         argv.push_back( arg.c_str() );
+
+      appbase::app().register_plugin< ah::account_history_plugin >();
+      appbase::app().register_plugin< ah::account_history_api_plugin >();
+      appbase::app().register_plugin< condenser::condenser_api_plugin >();
+      db_plugin = &appbase::app().register_plugin< blurt::plugins::debug_node::debug_node_plugin >();
+
+      db_plugin->logging = false;
+      appbase::app().initialize<
+         ah::account_history_plugin,
+         ah::account_history_api_plugin,
+         condenser::condenser_api_plugin,
+         blurt::plugins::debug_node::debug_node_plugin
+         >( argv.size(), (char**)argv.data() );
+
+      appbase::app().get_plugin< condenser::condenser_api_plugin >().plugin_startup();
+
+      history_api = appbase::app().get_plugin< ah::account_history_api_plugin >().api;
+      condenser_api = appbase::app().get_plugin< condenser::condenser_api_plugin >().api;
+      BOOST_REQUIRE( history_api );
+      BOOST_REQUIRE( condenser_api );
+
+      db = &appbase::app().get_plugin< blurt::plugins::chain::chain_plugin >().db();
+      BOOST_REQUIRE( db );
+
+      open_database();
+
+      generate_block();
+      db->set_hardfork( BLURT_BLOCKCHAIN_VERSION.minor_v() );
+      generate_block();
+
+      vest( BLURT_INIT_MINER_NAME, 10000 );
+
+      validate_database();
+      } FC_LOG_AND_RETHROW()
+   }
+
+   /// Pushes `count` transfers from `from` to `to`, in transactions of at most 100 operations, one per block.
+   void push_transfers( const std::string& from, const std::string& to, uint32_t count )
+   {
+      for( uint32_t pushed = 0; pushed < count; )
+      {
+         for( ; pushed < count && trx.operations.size() < 100; ++pushed )
+         {
+            transfer_operation op;
+            op.from = from;
+            op.to = to;
+            op.amount = asset( 1, BLURT_SYMBOL );
+            trx.operations.push_back( op );
+         }
+
+         trx.set_expiration( db->head_block_time() + BLURT_MAX_TIME_UNTIL_EXPIRATION );
+         db->push_transaction( trx, ~0 );
+         trx.clear();
+         generate_block();
+      }
+   }
+};
+
+struct locators_only_fixture : public account_history_fixture
+{
+   locators_only_fixture() : account_history_fixture( { "--account-history-locators-only", "true" } ) {}
+};
+
+uint64_t operation_mask( int64_t op_type )
+{
+   return uint64_t( 1 ) << op_type;
+}
+
+std::vector< char > pack_operation( const operation& op )
+{
+   return fc::raw::pack_to_vector( op );
+}
+
+} // anonymous
+
+BOOST_FIXTURE_TEST_SUITE( account_history, account_history_fixture )
+
+BOOST_AUTO_TEST_CASE( filtered_history )
+{
+   try
+   {
+      ACTORS( (alice)(bob) )
+      generate_block();
+      fund( "alice", asset( 1000000, BLURT_SYMBOL ) );
+      generate_block();
+
+      push_transfers( "alice", "bob", 30 );
+      vest( "alice", "alice", asset( 1000, BLURT_SYMBOL ) );
+      generate_block();
+
+      const uint64_t transfers = operation_mask( operation::tag< transfer_operation >::value );
+      const uint64_t creates = operation_mask( operation::tag< account_create_operation >::value );
+
+      ah::get_account_history_args args;
+      args.account = "alice";
+      args.start = -1;
+      args.limit = 1000;
+
+      // Sequences of the 10 newest transfers, picked out of unfiltered history
+      std::set< uint32_t > newest_transfers;
+      const auto all = history_api->get_account_history( args ).history;
+      for( auto itr = all.rbegin(); itr != all.rend() && newest_transfers.size() < 10; ++itr )
+      {
+         if( itr->second.op.which() == operation::tag< transfer_operation >::value )
+            newest_transfers.insert( itr->first );
+      }
+      BOOST_REQUIRE_EQUAL( newest_transfers.size(), 10u );
+
+      BOOST_TEST_MESSAGE( "--- Filter returns up to limit matching operations, newest first" );
+      args.limit = 10;
+      args.operation_filter_low = transfers;
+      auto result = history_api->get_account_history( args );
+      BOOST_REQUIRE_EQUAL( result.history.size(), 10u );
+      BOOST_REQUIRE( !result.next_start.valid() );
+      for( const auto& entry : result.history )
+      {
+         BOOST_REQUIRE( entry.second.op.which() == operation::tag< transfer_operation >::value );
+         BOOST_REQUIRE( newest_transfers.count( entry.first ) );
+      }
+
+      BOOST_TEST_MESSAGE( "--- Filter matching nothing returns nothing" );
+      args.operation_filter_low = 0;
+      args.operation_filter_high = 1;
+      BOOST_REQUIRE( history_api->get_account_history( args ).history.empty() );
+
+      BOOST_TEST_MESSAGE( "--- Filtered call accepts start lower than limit, unfiltered call does not" );
+      args.operation_filter_low = creates;
+      args.operation_filter_high.reset();
+      args.start = 5;
+      args.limit = 100;
+      result = history_api->get_account_history( args );
+      BOOST_REQUIRE_EQUAL( result.history.size(), 1u );
+      BOOST_REQUIRE( result.history.begin()->second.op.which() == operation::tag< account_create_operation >::value );
+
+      args.operation_filter_low.reset();
+      BOOST_REQUIRE_THROW( history_api->get_account_history( args ), fc::exception );
+
+      BOOST_TEST_MESSAGE( "--- Filtered scan stops after bounded number of entries and tells where to continue" );
+      push_transfers( "alice", "bob", 1200 );
+
+      args.operation_filter_low = creates;
+      args.start = -1;
+      args.limit = 1;
+      result = history_api->get_account_history( args );
+      BOOST_REQUIRE( result.history.empty() );
+      BOOST_REQUIRE( result.next_start.valid() );
+
+      args.start = *result.next_start;
+      result = history_api->get_account_history( args );
+      BOOST_REQUIRE_EQUAL( result.history.size(), 1u );
+      BOOST_REQUIRE( result.history.begin()->second.op.which() == operation::tag< account_create_operation >::value );
+      BOOST_REQUIRE( !result.next_start.valid() );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( condenser_filtered_history )
+{
+   try
+   {
+      ACTORS( (alice)(bob) )
+      generate_block();
+      fund( "alice", asset( 1000000, BLURT_SYMBOL ) );
+      generate_block();
+
+      push_transfers( "alice", "bob", 20 );
+
+      const uint64_t transfers = operation_mask( operation::tag< transfer_operation >::value );
+      const uint64_t creates = operation_mask( operation::tag< account_create_operation >::value );
+      const int64_t legacy_transfer = condenser::legacy_operation::tag< condenser::legacy_transfer_operation >::value;
+      const int64_t legacy_create = condenser::legacy_operation::tag< condenser::legacy_account_create_operation >::value;
+
+      BOOST_TEST_MESSAGE( "--- Three arguments return unfiltered history" );
+      auto history = condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 5 ) } );
+      BOOST_REQUIRE_EQUAL( history.size(), 5u );
+
+      BOOST_TEST_MESSAGE( "--- Fourth argument is operation_filter_low" );
+      history = condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 100 ),
+         fc::variant( transfers ) } );
+      BOOST_REQUIRE_EQUAL( history.size(), 20u );
+      for( const auto& entry : history )
+         BOOST_REQUIRE( entry.second.op.which() == legacy_transfer );
+
+      history = condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 100 ),
+         fc::variant( creates ) } );
+      BOOST_REQUIRE_EQUAL( history.size(), 1u );
+      BOOST_REQUIRE( history.begin()->second.op.which() == legacy_create );
+
+      BOOST_TEST_MESSAGE( "--- Fifth argument is operation_filter_high" );
+      history = condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 100 ),
+         fc::variant( transfers ), fc::variant( 0 ) } );
+      BOOST_REQUIRE_EQUAL( history.size(), 20u );
+
+      history = condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 100 ),
+         fc::variant( 0 ), fc::variant( 1 ) } );
+      BOOST_REQUIRE( history.empty() );
+
+      BOOST_TEST_MESSAGE( "--- More than five arguments are refused" );
+      BOOST_REQUIRE_THROW( condenser_api->get_account_history( { fc::variant( "alice" ), fc::variant( uint64_t( -1 ) ), fc::variant( 100 ),
+         fc::variant( transfers ), fc::variant( 0 ), fc::variant( 0 ) } ), fc::exception );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( locators_only, locators_only_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) )
+      generate_block();
+      fund( "alice", asset( 1000000, BLURT_SYMBOL ) );
+      generate_block();
+
+      signed_transaction tx;
+      for( int i = 1; i <= 3; ++i )
+      {
+         transfer_operation op;
+         op.from = "alice";
+         op.to = "bob";
+         op.amount = asset( i, BLURT_SYMBOL );
+         op.memo = "locator " + std::to_string( i );
+         tx.operations.push_back( op );
+      }
+      tx.set_expiration( db->head_block_time() + BLURT_MAX_TIME_UNTIL_EXPIRATION );
+      db->push_transaction( tx, ~0 );
+
+      const uint32_t block_num = db->head_block_num() + 1;
+      generate_block();
+
+      BOOST_TEST_MESSAGE( "--- Payloads of non-virtual operations are dropped once their block is irreversible" );
+      for( uint32_t i = 0; db->get_dynamic_global_properties().last_irreversible_block_num < block_num; ++i )
+      {
+         BOOST_REQUIRE( i < 100 );
+         generate_block();
+      }
+
+      const auto& op_idx = db->get_index< operation_index, by_location >();
+      uint32_t stored_ops = 0;
+      uint32_t stored_virtual_ops = 0;
+      for( auto itr = op_idx.lower_bound( block_num ); itr != op_idx.end() && itr->block == block_num; ++itr )
+      {
+         if( itr->virtual_op == 0 )
+         {
+            BOOST_REQUIRE( itr->serialized_op.empty() );
+            BOOST_REQUIRE( itr->op_type == uint32_t( operation::tag< transfer_operation >::value ) );
+            ++stored_ops;
+         }
+         else
+         {
+            BOOST_REQUIRE( !itr->serialized_op.empty() );
+            ++stored_virtual_ops;
+         }
+      }
+      BOOST_REQUIRE_EQUAL( stored_ops, 3u );
+      BOOST_REQUIRE( stored_virtual_ops > 0 );
+
+      BOOST_TEST_MESSAGE( "--- get_account_history reads operations back from their block" );
+      ah::get_account_history_args args;
+      args.account = "alice";
+      args.start = -1;
+      args.limit = 1000;
+
+      std::vector< operation > transfers;
+      for( const auto& entry : history_api->get_account_history( args ).history )
+      {
+         if( entry.second.op.which() == operation::tag< transfer_operation >::value )
+         {
+            BOOST_REQUIRE_EQUAL( entry.second.block, block_num );
+            transfers.push_back( entry.second.op );
+         }
+      }
+      BOOST_REQUIRE_EQUAL( transfers.size(), 3u );
+      for( size_t i = 0; i < transfers.size(); ++i )
+         BOOST_REQUIRE( pack_operation( transfers[ i ] ) == pack_operation( tx.operations[ i ] ) );
+
+      BOOST_TEST_MESSAGE( "--- Filtered read selects operations by their stored type" );
+      args.limit = 10;
+      args.operation_filter_low = operation_mask( operation::tag< transfer_operation >::value );
+      auto filtered = history_api->get_account_history( args ).history;
+      BOOST_REQUIRE_EQUAL( filtered.size(), 3u );
+      size_t i = 0;
+      for( const auto& entry : filtered )
+         BOOST_REQUIRE( pack_operation( entry.second.op ) == pack_operation( tx.operations[ i++ ] ) );
+
+      BOOST_TEST_MESSAGE( "--- get_ops_in_block reads operations back, virtual operations keep their payloads" );
+      auto block_ops = history_api->get_ops_in_block( { block_num, false } ).ops;
+      std::vector< operation > non_virtual;
+      uint32_t virtual_ops = 0;
+      for( const auto& api_op : block_ops )
+      {
+         if( api_op.virtual_op == 0 )
+         {
+            non_virtual.push_back( api_op.op );
+            continue;
+         }
+
+         BOOST_REQUIRE( is_virtual_operation( api_op.op ) );
+         auto stored = op_idx.lower_bound( block_num );
+         while( stored != op_idx.end() && stored->block == block_num && stored->virtual_op != api_op.virtual_op )
+            ++stored;
+         BOOST_REQUIRE( stored != op_idx.end() && stored->block == block_num );
+         BOOST_REQUIRE( pack_operation( api_op.op ) == std::vector< char >( stored->serialized_op.begin(), stored->serialized_op.end() ) );
+         ++virtual_ops;
+      }
+      BOOST_REQUIRE_EQUAL( virtual_ops, stored_virtual_ops );
+      BOOST_REQUIRE_EQUAL( non_virtual.size(), 3u );
+      for( size_t i = 0; i < non_virtual.size(); ++i )
+         BOOST_REQUIRE( pack_operation( non_virtual[ i ] ) == pack_operation( tx.operations[ i ] ) );
+
+      BOOST_TEST_MESSAGE( "--- get_transaction returns the original operations" );
+      auto trx = history_api->get_transaction( { tx.id() } );
+      BOOST_REQUIRE_EQUAL( trx.block_num, block_num );
+      BOOST_REQUIRE_EQUAL( trx.operations.size(), 3u );
+      for( size_t i = 0; i < trx.operations.size(); ++i )
+         BOOST_REQUIRE( pack_operation( trx.operations[ i ] ) == pack_operation( tx.operations[ i ] ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
@@ -5,12 +5,35 @@
 #include <blurt/chain/comment_object.hpp>
 #include <blurt/protocol/blurt_operations.hpp>
 #include <blurt/plugins/json_rpc/json_rpc_plugin.hpp>
+#include <blurt/plugins/json_rpc/admission_control.hpp>
+#include <blurt/plugins/database_api/database_api.hpp>
+#include <blurt/plugins/block_api/block_api_args.hpp>
 
 #include "../db_fixture/database_fixture.hpp"
 
+#include <atomic>
+#include <thread>
+
 using namespace blurt::chain;
 using namespace blurt::protocol;
 
+namespace {
+
+struct batch_limit_fixture : public json_rpc_database_fixture
+{
+   batch_limit_fixture() : json_rpc_database_fixture( { "--json-rpc-max-batch-size", "3" } ) {}
+};
+
+std::string get_config_batch( size_t size )
+{
+   std::string batch = "[";
+   for( size_t i = 0; i < size; ++i )
+      batch += ( i ? "," : "" ) + std::string( "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":" ) + std::to_string( i ) + "}";
+   return batch + "]";
+}
+
+} // anonymous
+
 BOOST_FIXTURE_TEST_SUITE( json_rpc, json_rpc_database_fixture )
 
 BOOST_AUTO_TEST_CASE( basic_validation )
@@ -312,5 +335,329 @@ BOOST_AUTO_TEST_CASE( semantics_validation )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( direct_json_results )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+      auto& db_api = *appbase::app().get_plugin< blurt::plugins::database_api::database_api_plugin >().api;
+
+      BOOST_TEST_MESSAGE( "--- Results written straight to JSON match the fc::variant output" );
+      std::string answer = rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.find_accounts\", \"params\":{\"accounts\":[\"initminer\"]}, \"id\":1}" );
+      blurt::plugins::database_api::find_accounts_args args;
+      args.accounts.push_back( "initminer" );
+      auto accounts = db_api.find_accounts( args, true );
+      BOOST_REQUIRE_EQUAL( accounts.accounts.size(), 1u );
+      BOOST_REQUIRE_EQUAL( answer, "{\"jsonrpc\":\"2.0\",\"result\":" + fc::json::to_string( fc::variant( accounts ) ) + ",\"id\":1}" );
+
+      answer = rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_dynamic_global_properties\", \"id\":\"x\"}" );
+      auto props = db_api.get_dynamic_global_properties( {}, true );
+      BOOST_REQUIRE_EQUAL( answer, "{\"jsonrpc\":\"2.0\",\"result\":" + fc::json::to_string( fc::variant( props ) ) + ",\"id\":\"x\"}" );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( response_cache )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+
+      generate_blocks( 30 );
+      BOOST_REQUIRE( db->get_dynamic_global_properties().last_irreversible_block_num >= 2 );
+
+      BOOST_TEST_MESSAGE( "--- Irreversible block is served from the cache, whatever the call style" );
+      std::string first = rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":2}, \"id\":1}" );
+      std::string second = rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"call\", \"params\":[\"block_api\", \"get_block\", {\"block_num\":2}], \"id\":1}" );
+      BOOST_REQUIRE_EQUAL( first, second );
+
+      BOOST_TEST_MESSAGE( "--- Cached result is spliced into the same layout as the reflected response" );
+      fc::variant answer = fc::json::from_string( second );
+      BOOST_REQUIRE_EQUAL( fc::json::to_string( answer ), second );
+      BOOST_REQUIRE( answer[ "result" ][ "block" ].is_object() );
+
+      BOOST_TEST_MESSAGE( "--- Cached result keeps the id of each request of a batch" );
+      std::string batch = rpc.call( "[{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":2}, \"id\":\"a\"},"
+         "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":2}, \"id\":7}]" );
+      fc::variant batch_answer = fc::json::from_string( batch );
+      BOOST_REQUIRE_EQUAL( fc::json::to_string( batch_answer ), batch );
+      BOOST_REQUIRE_EQUAL( batch_answer[ size_t( 0 ) ][ "id" ].as_string(), "a" );
+      BOOST_REQUIRE_EQUAL( batch_answer[ size_t( 1 ) ][ "id" ].as_int64(), 7 );
+      BOOST_REQUIRE_EQUAL( fc::json::to_string( batch_answer[ size_t( 0 ) ][ "result" ] ), fc::json::to_string( answer[ "result" ] ) );
+
+      BOOST_TEST_MESSAGE( "--- Reversible block is not cached" );
+      uint32_t head = db->head_block_num();
+      std::string request = "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":" + std::to_string( head + 1 ) + "}, \"id\":1}";
+      answer = fc::json::from_string( rpc.call( request ) );
+      BOOST_REQUIRE( !answer[ "result" ].get_object().contains( "block" ) );
+
+      generate_block();
+      answer = fc::json::from_string( rpc.call( request ) );
+      BOOST_REQUIRE( answer[ "result" ][ "block" ].is_object() );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( method_latency_stats )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+
+      auto get_stats = [&rpc]()
+      {
+         fc::variant answer = fc::json::from_string( rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"jsonrpc.get_method_stats\", "
+            "\"params\":{\"method\":\"database_api.get_dynamic_global_properties\"}, \"id\":1}" ) );
+         const auto& stats = answer[ "result" ].get_array();
+         BOOST_REQUIRE_EQUAL( stats.size(), 1u );
+         BOOST_REQUIRE_EQUAL( stats[0][ "method" ].as_string(), "database_api.get_dynamic_global_properties" );
+         return stats[0];
+      };
+
+      BOOST_TEST_MESSAGE( "--- Every call is recorded in each phase of its method" );
+      fc::variant before = get_stats();
+
+      for( int i = 0; i < 5; ++i )
+         rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_dynamic_global_properties\", \"id\":1}" );
+      rpc.call( "[{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_dynamic_global_properties\", \"id\":1},"
+         "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":2}]" );
+
+      fc::variant after = get_stats();
+      for( const char* phase : { "queue", "parse", "lock", "execute", "serialize", "total" } )
+         BOOST_REQUIRE_EQUAL( after[ phase ][ "count" ].as_uint64() - before[ phase ][ "count" ].as_uint64(), 6u );
+
+      const auto& total = after[ "total" ];
+      BOOST_REQUIRE( total[ "p50" ].as_uint64() <= total[ "p99" ].as_uint64() );
+      BOOST_REQUIRE( total[ "p99" ].as_uint64() <= total[ "max" ].as_uint64() );
+
+      BOOST_TEST_MESSAGE( "--- Without a method, all methods that were called are listed" );
+      fc::variant answer = fc::json::from_string( rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"jsonrpc.get_method_stats\", \"params\":{}, \"id\":1}" ) );
+      std::set< std::string > methods;
+      for( const auto& entry : answer[ "result" ].get_array() )
+         methods.insert( entry[ "method" ].as_string() );
+      BOOST_REQUIRE( methods.count( "database_api.get_dynamic_global_properties" ) );
+      BOOST_REQUIRE( methods.count( "database_api.get_config" ) );
+      BOOST_REQUIRE( !methods.count( "database_api.find_change_recovery_account_requests" ) );
+
+      BOOST_TEST_MESSAGE( "--- Unknown method is an error" );
+      answer = fc::json::from_string( rpc.call( "{\"jsonrpc\":\"2.0\", \"method\":\"jsonrpc.get_method_stats\", \"params\":{\"method\":\"foo.bar\"}, \"id\":1}" ) );
+      BOOST_REQUIRE( answer.get_object().contains( "error" ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( client_rate_limiting )
+{
+   try
+   {
+      blurt::plugins::json_rpc::admission_control admission( 10, 20 );
+      admission.set_method_cost( "account_history_api.get_account_history", 15 );
+      fc::time_point now = fc::time_point::now();
+      fc::microseconds retry_after;
+
+      BOOST_TEST_MESSAGE( "--- Methods are charged their configured cost" );
+      BOOST_REQUIRE_EQUAL( admission.method_cost( "account_history_api.get_account_history" ), 15u );
+      BOOST_REQUIRE_EQUAL( admission.method_cost( "database_api.get_config" ), 1u );
+
+      BOOST_TEST_MESSAGE( "--- A new client can spend its whole burst at once" );
+      for( int i = 0; i < 20; ++i )
+         BOOST_REQUIRE( admission.admit( "10.0.0.1", 1, now, retry_after ) );
+      BOOST_REQUIRE( !admission.admit( "10.0.0.1", 1, now, retry_after ) );
+      BOOST_REQUIRE_EQUAL( retry_after.count(), 100000 );
+
+      BOOST_TEST_MESSAGE( "--- Clients have separate budgets" );
+      BOOST_REQUIRE( admission.admit( "10.0.0.2", 1, now, retry_after ) );
+      BOOST_REQUIRE_EQUAL( admission.client_count(), 2u );
+
+      BOOST_TEST_MESSAGE( "--- Budget refills over time" );
+      now += fc::milliseconds( 100 );
+      BOOST_REQUIRE( admission.admit( "10.0.0.1", 1, now, retry_after ) );
+      BOOST_REQUIRE( !admission.admit( "10.0.0.1", 1, now, retry_after ) );
+
+      BOOST_TEST_MESSAGE( "--- Cost 0 only checks the budget" );
+      BOOST_REQUIRE( admission.admit( "10.0.0.3", 0, now, retry_after ) );
+      BOOST_REQUIRE( !admission.admit( "10.0.0.1", 0, now, retry_after ) );
+
+      BOOST_TEST_MESSAGE( "--- Expensive calls are admitted while there is budget left and put the client into debt" );
+      BOOST_REQUIRE( admission.admit( "10.0.0.4", 15, now, retry_after ) );
+      BOOST_REQUIRE( admission.admit( "10.0.0.4", 15, now, retry_after ) );
+      BOOST_REQUIRE( !admission.admit( "10.0.0.4", 1, now, retry_after ) );
+      BOOST_REQUIRE_EQUAL( retry_after.count(), 1100000 );
+
+      now += fc::microseconds( 1100000 );
+      BOOST_REQUIRE( admission.admit( "10.0.0.4", 1, now, retry_after ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( raw_results )
+{
+   try
+   {
+      using blurt::plugins::json_rpc::raw_rpc_response;
+      using blurt::plugins::block_api::get_block_range_return;
+
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+      blurt::plugins::json_rpc::batch_task_dispatcher dispatcher;
+
+      generate_blocks( 5 );
+
+      BOOST_TEST_MESSAGE( "--- Packed results hold the same blocks as the JSON results" );
+      std::string request = "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block_range\", \"params\":{\"starting_block_num\":2, \"count\":3}, \"id\":4}";
+      auto response = fc::raw::unpack_from_vector< raw_rpc_response >( rpc.call_raw( request, dispatcher ), 0 );
+      BOOST_REQUIRE( !response.error.valid() );
+      BOOST_REQUIRE_EQUAL( response.id, "4" );
+
+      auto range = fc::raw::unpack_from_vector< get_block_range_return >( response.result, 0 );
+      BOOST_REQUIRE_EQUAL( range.blocks.size(), 3u );
+      BOOST_REQUIRE_EQUAL( range.blocks[0].block_num(), 2u );
+
+      fc::variant answer = fc::json::from_string( rpc.call( request ) );
+      BOOST_REQUIRE_EQUAL( fc::json::to_string( fc::variant( range ) ), fc::json::to_string( answer[ "result" ] ) );
+
+      BOOST_TEST_MESSAGE( "--- Range ends before the first missing block" );
+      request = "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block_range\", \"params\":{\"starting_block_num\":"
+         + std::to_string( db->head_block_num() ) + ", \"count\":10}, \"id\":1}";
+      response = fc::raw::unpack_from_vector< raw_rpc_response >( rpc.call_raw( request, dispatcher ), 0 );
+      BOOST_REQUIRE_EQUAL( fc::raw::unpack_from_vector< get_block_range_return >( response.result, 0 ).blocks.size(), 1u );
+
+      BOOST_TEST_MESSAGE( "--- Each request of a batch gets its own packed response" );
+      auto batch = fc::raw::unpack_from_vector< std::vector< raw_rpc_response > >( rpc.call_raw(
+         "[{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":2}, \"id\":\"a\"},"
+         "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":2}]", dispatcher ), 0 );
+      BOOST_REQUIRE_EQUAL( batch.size(), 2u );
+      BOOST_REQUIRE_EQUAL( batch[0].id, "\"a\"" );
+      auto block = fc::raw::unpack_from_vector< blurt::plugins::block_api::get_block_return >( batch[0].result, 0 );
+      BOOST_REQUIRE( block.block.valid() );
+      BOOST_REQUIRE( block.block->block_id == range.blocks[0].block_id );
+
+      BOOST_TEST_MESSAGE( "--- Methods without a binary binding are an error" );
+      BOOST_REQUIRE( batch[1].error.valid() );
+      BOOST_REQUIRE( batch[1].result.empty() );
+      answer = fc::json::from_string( *batch[1].error );
+      BOOST_REQUIRE_EQUAL( answer[ "code" ].as_int64(), JSON_RPC_ERROR_DURING_CALL );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( batch_response_order )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+
+      std::vector< std::thread > threads;
+      std::atomic< uint32_t > dispatched{ 0 };
+      blurt::plugins::json_rpc::batch_task_dispatcher dispatcher = [&threads, &dispatched]( std::function< void() > task )
+      {
+         ++dispatched;
+         threads.emplace_back( task );
+      };
+
+      generate_blocks( 5 );
+
+      BOOST_TEST_MESSAGE( "--- Responses of a parallel batch are in request order" );
+      std::string batch = "[";
+      for( uint32_t i = 0; i < 24; ++i )
+      {
+         if( i )
+            batch += ",";
+         if( i % 3 == 0 )
+            batch += "{\"jsonrpc\":\"2.0\", \"method\":\"block_api.get_block\", \"params\":{\"block_num\":" + std::to_string( i % 5 + 1 ) + "}, ";
+         else if( i % 3 == 1 )
+            batch += "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", ";
+         else
+            batch += "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.no_such_method\", ";
+         batch += "\"id\":" + std::to_string( i ) + "}";
+      }
+      batch += "]";
+
+      fc::variant answer = fc::json::from_string( rpc.call( batch, dispatcher ) );
+      for( auto& thread : threads )
+         thread.join();
+
+      BOOST_REQUIRE( dispatched > 0 );
+      const auto& responses = answer.get_array();
+      BOOST_REQUIRE_EQUAL( responses.size(), 24u );
+      for( uint32_t i = 0; i < responses.size(); ++i )
+      {
+         const auto& response = responses[ i ];
+         BOOST_REQUIRE_EQUAL( response[ "id" ].as_uint64(), i );
+
+         if( i % 3 == 0 )
+            BOOST_REQUIRE_EQUAL( block_header::num_from_id( response[ "result" ][ "block" ][ "block_id" ].as< block_id_type >() ), i % 5 + 1 );
+         else if( i % 3 == 1 )
+            BOOST_REQUIRE( response[ "result" ].get_object().contains( "BLURT_CHAIN_ID" ) );
+         else
+            BOOST_REQUIRE_EQUAL( response[ "error" ][ "code" ].as_int64(), JSON_RPC_METHOD_NOT_FOUND );
+      }
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( batch_broadcast_serial )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+
+      uint32_t dispatched = 0;
+      blurt::plugins::json_rpc::batch_task_dispatcher dispatcher = [&dispatched]( std::function< void() > task )
+      {
+         ++dispatched;
+         task();
+      };
+
+      BOOST_TEST_MESSAGE( "--- Read only batch is spread across tasks" );
+      rpc.call( get_config_batch( 4 ), dispatcher );
+      BOOST_REQUIRE_EQUAL( dispatched, 3u );
+
+      BOOST_TEST_MESSAGE( "--- Batch containing a broadcast is processed on the calling thread, in request order" );
+      const std::vector< std::string > broadcasts =
+      {
+         "{\"jsonrpc\":\"2.0\", \"method\":\"condenser_api.broadcast_transaction\", \"params\":[], \"id\":2}",
+         "{\"jsonrpc\":\"2.0\", \"method\":\"network_broadcast_api.broadcast_transaction\", \"params\":{}, \"id\":2}",
+         "{\"jsonrpc\":\"2.0\", \"method\":\"call\", \"params\":[\"condenser_api\", \"broadcast_transaction_synchronous\", []], \"id\":2}",
+         "{\"jsonrpc\":\"2.0\", \"method\":\"call\", \"params\":[\"network_broadcast_api\", \"broadcast_block\", {}], \"id\":2}"
+      };
+
+      for( const auto& broadcast : broadcasts )
+      {
+         dispatched = 0;
+         std::string batch = "[{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":0},"
+            "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":1}," + broadcast + ","
+            "{\"jsonrpc\":\"2.0\", \"method\":\"database_api.get_config\", \"id\":3}]";
+
+         fc::variant answer = fc::json::from_string( rpc.call( batch, dispatcher ) );
+         BOOST_REQUIRE_EQUAL( dispatched, 0u );
+
+         const auto& responses = answer.get_array();
+         BOOST_REQUIRE_EQUAL( responses.size(), 4u );
+         for( uint32_t i = 0; i < responses.size(); ++i )
+            BOOST_REQUIRE_EQUAL( responses[ i ][ "id" ].as_uint64(), i );
+         BOOST_REQUIRE( responses[ 2 ].get_object().contains( "error" ) );
+      }
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( batch_size_limit, batch_limit_fixture )
+{
+   try
+   {
+      auto& rpc = appbase::app().get_plugin< blurt::plugins::json_rpc::json_rpc_plugin >();
+
+      BOOST_TEST_MESSAGE( "--- Batch up to json-rpc-max-batch-size is processed" );
+      fc::variant answer = fc::json::from_string( rpc.call( get_config_batch( 3 ) ) );
+      BOOST_REQUIRE_EQUAL( answer.get_array().size(), 3u );
+
+      BOOST_TEST_MESSAGE( "--- Larger batch is refused with a single error" );
+      answer = fc::json::from_string( rpc.call( get_config_batch( 4 ) ) );
+      BOOST_REQUIRE( answer.is_object() );
+      BOOST_REQUIRE_EQUAL( answer[ "error" ][ "code" ].as_int64(), JSON_RPC_INVALID_REQUEST );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 #endif
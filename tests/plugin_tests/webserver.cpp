@@ -0,0 +1,103 @@
+#ifdef IS_TEST_NET
+#include <BoostTestTargetConfig.h>
+
+#include <blurt/protocol/blurt_operations.hpp>
+#include <blurt/plugins/webserver/subscription_filter.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/exception/exception.hpp>
+
+using namespace blurt::protocol;
+using namespace blurt::plugins::webserver;
+
+namespace {
+
+subscribe_args parse_subscribe_args( const std::string& json )
+{
+   return fc::json::from_string( json ).as< subscribe_args >();
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_SUITE( webserver )
+
+BOOST_AUTO_TEST_CASE( subscribe_validation )
+{
+   try
+   {
+      BOOST_TEST_MESSAGE( "--- Each subscription type is accepted" );
+      BOOST_REQUIRE( subscription_filter( parse_subscribe_args( "{\"type\":\"head_block\"}" ) ).type() == subscription_type::head_block );
+      BOOST_REQUIRE( subscription_filter( parse_subscribe_args( "{\"type\":\"irreversible_block\"}" ) ).type() == subscription_type::irreversible_block );
+      BOOST_REQUIRE( subscription_filter( parse_subscribe_args( "{\"type\":\"operations\"}" ) ).type() == subscription_type::operations );
+
+      BOOST_TEST_MESSAGE( "--- Unknown subscription type is refused" );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args( "{\"type\":\"blocks\"}" ) ), fc::exception );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args( "{}" ) ), fc::exception );
+
+      BOOST_TEST_MESSAGE( "--- Block subscriptions cannot be filtered" );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args( "{\"type\":\"head_block\",\"accounts\":[\"alice\"]}" ) ), fc::exception );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args(
+         "{\"type\":\"irreversible_block\",\"operation_types\":[\"transfer_operation\"]}" ) ), fc::exception );
+
+      BOOST_TEST_MESSAGE( "--- Only operations subscriptions can wait for irreversible blocks" );
+      BOOST_REQUIRE( !subscription_filter( parse_subscribe_args( "{\"type\":\"operations\"}" ) ).irreversible() );
+      BOOST_REQUIRE( subscription_filter( parse_subscribe_args( "{\"type\":\"operations\",\"irreversible\":true}" ) ).irreversible() );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args( "{\"type\":\"head_block\",\"irreversible\":true}" ) ), fc::exception );
+
+      BOOST_TEST_MESSAGE( "--- Operation types are accepted with or without namespace" );
+      subscription_filter( parse_subscribe_args( "{\"type\":\"operations\",\"operation_types\":[\"transfer_operation\"]}" ) );
+      subscription_filter( parse_subscribe_args( "{\"type\":\"operations\",\"operation_types\":[\"blurt::protocol::vote_operation\"]}" ) );
+
+      BOOST_TEST_MESSAGE( "--- Unknown operation type is refused" );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args(
+         "{\"type\":\"operations\",\"operation_types\":[\"no_such_operation\"]}" ) ), fc::exception );
+      BOOST_REQUIRE_THROW( subscription_filter( parse_subscribe_args(
+         "{\"type\":\"operations\",\"operation_types\":[\"fc::transfer_operation\"]}" ) ), fc::exception );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( operation_matching )
+{
+   try
+   {
+      const std::string transfer = operation_type_name( operation( transfer_operation() ) );
+      const std::string vote = operation_type_name( operation( vote_operation() ) );
+      BOOST_REQUIRE_EQUAL( transfer, "blurt::protocol::transfer_operation" );
+
+      fc::flat_set< account_name_type > alice_bob = { "alice", "bob" };
+      fc::flat_set< account_name_type > carol = { "carol" };
+
+      BOOST_TEST_MESSAGE( "--- Unfiltered subscription gets every operation" );
+      subscription_filter all( parse_subscribe_args( "{\"type\":\"operations\"}" ) );
+      BOOST_REQUIRE( all.matches_operation( transfer, alice_bob ) );
+      BOOST_REQUIRE( all.matches_operation( vote, carol ) );
+      BOOST_REQUIRE( all.matches_operation( vote, fc::flat_set< account_name_type >() ) );
+
+      BOOST_TEST_MESSAGE( "--- Type filter" );
+      subscription_filter transfers( parse_subscribe_args( "{\"type\":\"operations\",\"operation_types\":[\"transfer_operation\"]}" ) );
+      BOOST_REQUIRE( transfers.matches_operation( transfer, carol ) );
+      BOOST_REQUIRE( !transfers.matches_operation( vote, carol ) );
+
+      BOOST_TEST_MESSAGE( "--- Account filter matches any impacted account" );
+      subscription_filter bob( parse_subscribe_args( "{\"type\":\"operations\",\"accounts\":[\"bob\",\"dave\"]}" ) );
+      BOOST_REQUIRE( bob.matches_operation( vote, alice_bob ) );
+      BOOST_REQUIRE( !bob.matches_operation( vote, carol ) );
+      BOOST_REQUIRE( !bob.matches_operation( vote, fc::flat_set< account_name_type >() ) );
+
+      BOOST_TEST_MESSAGE( "--- Both filters must match" );
+      subscription_filter bob_transfers( parse_subscribe_args(
+         "{\"type\":\"operations\",\"accounts\":[\"bob\"],\"operation_types\":[\"transfer_operation\"]}" ) );
+      BOOST_REQUIRE( bob_transfers.matches_operation( transfer, alice_bob ) );
+      BOOST_REQUIRE( !bob_transfers.matches_operation( vote, alice_bob ) );
+      BOOST_REQUIRE( !bob_transfers.matches_operation( transfer, carol ) );
+
+      BOOST_TEST_MESSAGE( "--- Block subscriptions never get operations" );
+      subscription_filter blocks( parse_subscribe_args( "{\"type\":\"head_block\"}" ) );
+      BOOST_REQUIRE( !blocks.matches_operation( transfer, alice_bob ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
@@ -41,6 +41,8 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <fstream>
+
 #include "../db_fixture/database_fixture.hpp"
 
 using namespace blurt;
@@ -52,14 +54,15 @@ using namespace blurt::plugins;
 
 BOOST_AUTO_TEST_SUITE(block_tests)
 
-void open_test_database( database& db, const fc::path& dir )
+void open_test_database( database& db, const fc::path& dir,
+   const fc::variant& database_cfg = blurt::utilities::default_database_configuration() )
 {
    database::open_args args;
    args.data_dir = dir;
    args.shared_mem_dir = dir;
    args.initial_supply = BLURT_INIT_SUPPLY;
    args.shared_file_size = TEST_SHARED_MEM_SIZE;
-   args.database_cfg = blurt::utilities::default_database_configuration();
+   args.database_cfg = database_cfg;
    db.open( args );
 }
 
@@ -134,6 +137,76 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+#ifdef ENABLE_MIRA
+BOOST_AUTO_TEST_CASE( index_placement_restart )
+{
+   try {
+      fc::temp_directory data_dir( blurt::utilities::temp_directory_path() );
+      fc::path marker = data_dir.path() / "in_memory_indices";
+      auto init_account_priv_key = fc::ecc::private_key::regenerate( fc::sha256::hash( string( "init_key" ) ) );
+      uint32_t head_block_num = 0;
+
+      BOOST_TEST_MESSAGE( "--- The default configuration holds no index in memory" );
+      {
+         database db;
+         db._log_hardforks = false;
+         open_test_database( db, data_dir.path() );
+         BOOST_REQUIRE( db.get_index_placement( "witness_index" ) == mira::index_type::mira );
+         BOOST_REQUIRE( !fc::exists( marker ) );
+         db.close();
+      }
+
+      fc::mutable_variant_object global( blurt::utilities::default_database_configuration()[ "global" ].get_object() );
+      global.set( "index_placement", fc::mutable_variant_object( "witness_index", "bmic" ) );
+      fc::mutable_variant_object cfg( blurt::utilities::default_database_configuration().get_object() );
+      cfg.set( "global", global );
+      const fc::variant placement_cfg( cfg );
+
+      BOOST_TEST_MESSAGE( "--- Indices configured as bmic are held in memory" );
+      {
+         database db;
+         witness::block_producer bp( db );
+         db._log_hardforks = false;
+         open_test_database( db, data_dir.path(), placement_cfg );
+         BOOST_REQUIRE( db.get_index_placement( "witness_index" ) == mira::index_type::bmic );
+         BOOST_REQUIRE( db.get_index_placement( "comment_index" ) == mira::index_type::mira );
+         BOOST_REQUIRE( fc::exists( marker ) );
+
+         for( uint32_t i = 0; i < 5; ++i )
+            bp.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing );
+
+         head_block_num = db.head_block_num();
+         db.close();
+         BOOST_REQUIRE( !fc::exists( marker ) );
+      }
+
+      BOOST_TEST_MESSAGE( "--- A cleanly closed node reopens with the same placement" );
+      {
+         database db;
+         witness::block_producer bp( db );
+         db._log_hardforks = false;
+         open_test_database( db, data_dir.path(), placement_cfg );
+         BOOST_REQUIRE( db.get_index_placement( "witness_index" ) == mira::index_type::bmic );
+         BOOST_REQUIRE_EQUAL( db.head_block_num(), head_block_num );
+
+         bp.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing );
+         db.close();
+      }
+
+      BOOST_TEST_MESSAGE( "--- A marker left by an unclean shutdown is refused" );
+      std::ofstream( marker.string() );
+      {
+         database db;
+         db._log_hardforks = false;
+         BOOST_REQUIRE_THROW( open_test_database( db, data_dir.path(), placement_cfg ), fc::exception );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+#endif
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
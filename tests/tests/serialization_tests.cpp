@@ -35,11 +35,13 @@
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/elliptic.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/reflect/variant.hpp>
 
 #include "../db_fixture/database_fixture.hpp"
 
 #include <cmath>
+#include <random>
 
 using namespace blurt;
 using namespace blurt::chain;
@@ -343,6 +345,192 @@ BOOST_AUTO_TEST_CASE( json_tests )
    }
 }
 
+BOOST_AUTO_TEST_CASE( json_writer_test )
+{
+   try
+   {
+      auto check = []( const auto& v )
+      {
+         BOOST_REQUIRE_EQUAL( fc::json_writer::to_string( v ), fc::json::to_string( fc::variant( v ) ) );
+      };
+
+      BOOST_TEST_MESSAGE( "--- Test scalars and containers" );
+      check( int64_t( -5000000000 ) );
+      check( int64_t( 5000000000 ) );
+      check( uint64_t( 0xffffffff ) );
+      check( uint64_t( 0x100000000 ) );
+      check( int16_t( -7 ) );
+      check( true );
+      check( 1.5 );
+      check( std::string( "quote\" backslash\\ \b\f\n\r\t \x01\x0b\x1f\x7f \xc3\xa9" ) );
+      check( std::vector< char >{ 'a', '\0', '\xff' } );
+      check( std::map< uint32_t, std::string >{ { 1, "a" }, { 2, "b" } } );
+      check( std::map< std::string, int64_t >{ { "b", 1 }, { "a", 5000000000 } } );
+      check( fc::flat_map< std::string, uint16_t >{ { "a", 1 } } );
+      check( fc::optional< asset >() );
+      check( fc::optional< asset >( asset( 1000, BLURT_SYMBOL ) ) );
+      check( share_type( 5000000000 ) );
+      check( fc::uint128_t( 1, 5 ) );
+      check( fc::time_point_sec( 1514764800 ) );
+      check( version( 0, 21, 1 ) );
+      check( hardfork_version( 0, 21 ) );
+      check( blurt::plugins::condenser_api::legacy_asset::from_asset( asset( 1000, BLURT_SYMBOL ) ) );
+      check( fc::json::from_string( "{\"b\":[1,\"x\",null,true,{\"a\":5000000000}],\"a\":-1.25}" ) );
+
+      BOOST_TEST_MESSAGE( "--- Test blocks" );
+      ACTORS( (alice)(bob) )
+      generate_blocks( 60 / BLURT_BLOCK_INTERVAL );
+
+      comment_operation op;
+      op.author = "alice";
+      op.permlink = "lorem";
+      op.parent_permlink = "ipsum";
+      op.title = "Lorem \"Ipsum\"";
+      op.body = "Line\nbreak\tand \\ backslash \x01 \xe2\x82\xac";
+      op.json_metadata = "{\"foo\":\"bar\"}";
+
+      signed_transaction tx;
+      tx.set_expiration( db->head_block_time() + BLURT_MAX_TIME_UNTIL_EXPIRATION );
+      tx.operations.push_back( op );
+      sign( tx, alice_private_key );
+      db->push_transaction( tx, 0 );
+      generate_block();
+
+      for( uint32_t block_num = 1; block_num <= db->head_block_num(); ++block_num )
+      {
+         auto block = db->fetch_block_by_number( block_num );
+         BOOST_REQUIRE( block.valid() );
+         check( *block );
+
+         blurt::plugins::block_api::api_signed_block_object api_block( *block );
+         check( api_block );
+         check( blurt::plugins::condenser_api::legacy_signed_block( api_block ) );
+
+         blurt::protocol::annotated_signed_transaction annotated;
+         for( const auto& trx : block->transactions )
+         {
+            annotated = trx;
+            annotated.block_num = block_num;
+            check( annotated );
+            check( blurt::plugins::condenser_api::legacy_signed_transaction( annotated ) );
+         }
+      }
+
+      check( fc::optional< signed_block >( db->fetch_block_by_number( db->head_block_num() ) ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+/// Compares variant types as well as values, so int64 and uint64 results are told apart.
+static bool same_variant( const fc::variant& a, const fc::variant& b )
+{
+   if( a.get_type() != b.get_type() )
+      return false;
+
+   switch( a.get_type() )
+   {
+      case fc::variant::array_type:
+      {
+         const auto& x = a.get_array();
+         const auto& y = b.get_array();
+         if( x.size() != y.size() )
+            return false;
+         for( size_t i = 0; i < x.size(); ++i )
+            if( !same_variant( x[i], y[i] ) )
+               return false;
+         return true;
+      }
+      case fc::variant::object_type:
+      {
+         const auto& x = a.get_object();
+         const auto& y = b.get_object();
+         if( x.size() != y.size() )
+            return false;
+         for( auto i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j )
+            if( i->key() != j->key() || !same_variant( i->value(), j->value() ) )
+               return false;
+         return true;
+      }
+      default:
+         return fc::json::to_string( a ) == fc::json::to_string( b );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( json_fast_parser_test )
+{
+   try
+   {
+      // Both parsers must agree on the result, or both must fail, for any input.
+      auto check = []( const std::string& s )
+      {
+         fc::variant legacy, fast;
+         bool legacy_threw = false, fast_threw = false;
+
+         try { legacy = fc::json::from_string( s, fc::json::legacy_parser ); } catch( ... ) { legacy_threw = true; }
+         try { fast = fc::json::from_string( s, fc::json::fast_parser ); } catch( ... ) { fast_threw = true; }
+
+         BOOST_REQUIRE_MESSAGE( legacy_threw == fast_threw, "Parsers disagree on failure for: " + s );
+         if( !legacy_threw )
+            BOOST_REQUIRE_MESSAGE( same_variant( legacy, fast ), "Parsers disagree on result for: " + s );
+
+         bool legacy_valid = false, fast_valid = false;
+         legacy_threw = fast_threw = false;
+
+         try { legacy_valid = fc::json::is_valid( s, fc::json::legacy_parser ); } catch( ... ) { legacy_threw = true; }
+         try { fast_valid = fc::json::is_valid( s, fc::json::fast_parser ); } catch( ... ) { fast_threw = true; }
+
+         BOOST_REQUIRE_MESSAGE( legacy_threw == fast_threw && legacy_valid == fast_valid, "Parsers disagree on validity for: " + s );
+      };
+
+      BOOST_TEST_MESSAGE( "--- Test well formed and legacy quirk inputs" );
+      check( "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"call\",\"params\":[\"condenser_api\",\"get_block\",[123]]}" );
+      check( "  [ 0, -0, 4294967296, 18446744073709551615, 18446744073709551616, -9223372036854775808, -9223372036854775809 ]" );
+      check( "[1.5, -.5, 1e5, -1abc, 1.2.3, -, -., 007, \"a\\tb\\nc\\rd\\\\e\\\"f\\u0041\\/\"]" );
+      check( "{\"a\":1,,\"a\":2 \"b\" : null,}" );
+      check( "[null, true, false, nul, nullx, truest, fals]" );
+      check( "[1 2 3]" );
+      check( "{} trailing" );
+      check( "\"unterminated" );
+      check( std::string( "\"nul\0byte\"", 10 ) );
+      check( "\"\x04\"" );
+      check( "[\xff]" );
+      check( "" );
+      check( std::string( 99, '[' ) + std::string( 99, ']' ) );
+      check( std::string( 100, '[' ) + std::string( 100, ']' ) );
+      check( std::string( 60, '[' ) + std::string( 60, '{' ) );
+
+      BOOST_TEST_MESSAGE( "--- Test blocks" );
+      ACTORS( (alice) )
+      generate_block();
+      for( uint32_t block_num = 1; block_num <= db->head_block_num(); ++block_num )
+         check( fc::json::to_string( *db->fetch_block_by_number( block_num ) ) );
+
+      BOOST_TEST_MESSAGE( "--- Test random inputs" );
+      const std::vector< std::string > pieces = {
+         "{", "}", "[", "]", ",", ":", "\"", "\\", "\"key\":", "\"a b\\\"c\"", "1", "-", ".", "0",
+         "12345678901234567890", "-9223372036854775809", "1.5", "1e5", "null", "true", "false", "nul",
+         "nullx", " ", "\n", "\t", "\r", "\x04", "\xff", std::string( 1, '\0' ), "x", "_", "/", "\\n",
+         "\"a long string without any escapes, longer than one word\"", "-.", "a:b" };
+
+      std::mt19937 rng( 42 );
+      for( uint32_t i = 0; i < 20000; ++i )
+      {
+         std::string s;
+         uint32_t count = rng() % 20;
+         for( uint32_t j = 0; j < count; ++j )
+         {
+            uint32_t r = rng() % ( pieces.size() + 1 );
+            if( r == pieces.size() )
+               s += char( rng() % 256 );
+            else
+               s += pieces[ r ];
+         }
+         check( s );
+      }
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( extended_private_key_type_test )
 {
    try